@@ -0,0 +1,57 @@
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <utility>
+
+template <typename T, quint32 capacity> class BoundedQueue { //lock-free multi-producer multi-consumer queue of fixed size (D. Vyukov's algorithm)
+    static_assert(capacity >= 2 && (capacity & (capacity - 1)) == 0, "capacity must be a power of 2");
+    struct Cell {
+        std::atomic<quint32> sequence;
+        T data;
+    };
+    Cell buffer[capacity];
+    alignas(64) std::atomic<quint32> enqueuePos {0}; //producers and consumer work on different cache lines
+    alignas(64) std::atomic<quint32> dequeuePos {0};
+
+public:
+    BoundedQueue() { for (quint32 i=0; i<capacity; ++i) buffer[i].sequence.store(i, std::memory_order_relaxed); }
+    BoundedQueue(const BoundedQueue &) = delete;
+    BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+    bool push(T &&value) { //returns false if the queue is full
+        quint32 pos = enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell &c = buffer[pos & (capacity - 1)];
+            qint32 diff = qint32(c.sequence.load(std::memory_order_acquire) - pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    c.data = std::move(value);
+                    c.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) return false;
+            else pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    bool pop(T &value) { //returns false if the queue is empty
+        quint32 pos = dequeuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell &c = buffer[pos & (capacity - 1)];
+            qint32 diff = qint32(c.sequence.load(std::memory_order_acquire) - (pos + 1));
+            if (diff == 0) {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = std::move(c.data);
+                    c.data = T();
+                    c.sequence.store(pos + capacity, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) return false;
+            else pos = dequeuePos.load(std::memory_order_relaxed);
+        }
+    }
+};
+
+#endif // BOUNDEDQUEUE_H
@@ -29,14 +29,22 @@ SOURCES += \
         main.cpp
 
 HEADERS += \
+        BoundedQueue.h \
+        CountersHistory.h \
+        DetectorState.h \
         FITboardsCommon.h \
         FITelectronics.h \
+        FITserver.h \
+        GBTerrorArchive.h \
         IPbusControlPacket.h \
         IPbusHeaders.h \
+        IPbusStats.h \
+        Logger.h \
         actualLabel.h \
         IPbusInterface.h \
         PM.h \
         TCM.h \
+        ThresholdCalibration.h \
         mainwindow.h    \
         switch.h
 
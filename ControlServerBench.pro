@@ -0,0 +1,41 @@
+#-------------------------------------------------
+#
+# Benchmark of the engine against an emulated IPbus target, no hardware needed
+#
+#-------------------------------------------------
+
+QT       += core network
+QT       -= gui
+
+TARGET = ControlServerBench
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+CONFIG += c++latest
+
+SOURCES += \
+        FITelectronics.cpp \
+        bench.cpp
+
+HEADERS += \
+        BoundedQueue.h \
+        CountersHistory.h \
+        DetectorState.h \
+        FITboardsCommon.h \
+        FITelectronics.h \
+        GBTerrorArchive.h \
+        IPbusControlPacket.h \
+        IPbusEmulator.h \
+        IPbusHeaders.h \
+        IPbusStats.h \
+        Logger.h \
+        IPbusInterface.h \
+        PM.h \
+        TCM.h \
+        ThresholdCalibration.h
+
+INCLUDEPATH += $$PWD/DIM
+LIBS += -L"$$PWD/DIM" -ldim
@@ -0,0 +1,46 @@
+#-------------------------------------------------
+#
+# Headless build of ControlServer: DIM I/O only, no QtGui/QtWidgets
+#
+#-------------------------------------------------
+
+QT       += core network
+QT       -= gui
+
+TARGET = ControlServerDaemon
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+CONFIG += c++latest
+
+SOURCES += \
+        FITelectronics.cpp \
+        daemon.cpp
+
+HEADERS += \
+        BoundedQueue.h \
+        CountersHistory.h \
+        DetectorState.h \
+        FITboardsCommon.h \
+        FITelectronics.h \
+        FITserver.h \
+        GBTerrorArchive.h \
+        IPbusControlPacket.h \
+        IPbusHeaders.h \
+        IPbusStats.h \
+        Logger.h \
+        IPbusInterface.h \
+        PM.h \
+        TCM.h \
+        ThresholdCalibration.h
+
+INCLUDEPATH += $$PWD/DIM
+LIBS += -L"$$PWD/DIM" -ldim
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
@@ -0,0 +1,101 @@
+#ifndef COUNTERSHISTORY_H
+#define COUNTERSHISTORY_H
+
+#include <QtGlobal>
+#include <QMutex>
+#include <QDataStream>
+#include <QVector>
+#include <functional>
+#include "DIM/dis.hxx"
+
+template <quint8 nCounters, typename RateType> class CountersHistory { //ring buffer of counts and rates, struct-of-arrays layout: one contiguous array per counter
+    static const quint32 maxCapacity = 1 << 16;
+    quint32 capacity = 0; //power of 2
+    QVector<qint64>   time_ms; //since epoch
+    QVector<quint32>  counts[nCounters];
+    QVector<RateType> rates [nCounters];
+    quint32 nWritten = 0;
+    mutable QMutex mutex; //appended from I/O thread, read from DIM thread
+
+    template <typename T> void regrow(QVector<T> &a, quint32 c, quint32 n) { //the last n samples go to the start of a new ring of c samples
+        QVector<T> b(c);
+        for (quint32 j=0; j<n; ++j) b[j] = a[(nWritten - n + j) & (capacity - 1)];
+        a.swap(b);
+    }
+
+public:
+    static const quint8 number = nCounters;
+
+    CountersHistory(quint32 nSamples = 1024) { setCapacity(nSamples); }
+
+    void setCapacity(quint32 nSamples) { //rounded up to a power of 2; the latest samples are kept, memory is allocated only here
+        quint32 c = 2;
+        while (c < qMin(nSamples, maxCapacity)) c <<= 1;
+        QMutexLocker locker(&mutex);
+        if (c == capacity) return;
+        quint32 n = qMin(qMin(nWritten, capacity), c);
+        regrow(time_ms, c, n);
+        for (quint8 i=0; i<nCounters; ++i) {
+            regrow(counts[i], c, n);
+            regrow(rates [i], c, n);
+        }
+        capacity = c;
+        nWritten = n;
+    }
+
+    void append(qint64 t_ms, const quint32 *New, const RateType *rate) {
+        QMutexLocker locker(&mutex);
+        quint32 i = nWritten++ & (capacity - 1);
+        time_ms[i] = t_ms;
+        for (quint8 c=0; c<nCounters; ++c) {
+            counts[c][i] = New[c];
+            rates [c][i] = rate[c];
+        }
+    }
+
+    quint32 size() const { QMutexLocker locker(&mutex); return qMin(nWritten, capacity); }
+
+    QVector<double> query(quint8 iCounter, quint32 nSamples) const { //last nSamples as {time_ms, count, rate} triplets, oldest first
+        QVector<double> result;
+        if (iCounter >= nCounters) return result;
+        QMutexLocker locker(&mutex);
+        quint32 n = qMin(nSamples, qMin(nWritten, capacity));
+        result.reserve(3 * n);
+        for (quint32 k=nWritten-n; k!=nWritten; ++k) {
+            quint32 i = k & (capacity - 1);
+            result << double(time_ms[i]) << double(counts[iCounter][i]) << double(rates[iCounter][i]);
+        }
+        return result;
+    }
+
+    void dump(QDataStream &out) const { //nSamples, then times, then counts and rates counter by counter, oldest first
+        QMutexLocker locker(&mutex);
+        quint32 n = qMin(nWritten, capacity), first = (nWritten - n) & (capacity - 1), nFirst = qMin(n, capacity - first); //stored samples are [first, first + nFirst) and [0, n - nFirst)
+        out << n << quint8(nCounters) << quint8(sizeof(RateType));
+        auto writeRing = [&](const void *a, size_t itemSize) {
+            out.writeRawData((const char *)a + first * itemSize, int(nFirst * itemSize));
+            out.writeRawData((const char *)a, int((n - nFirst) * itemSize));
+        };
+        writeRing(time_ms.constData(), sizeof(qint64));
+        for (quint8 c=0; c<nCounters; ++c) writeRing(counts[c].constData(), sizeof(quint32));
+        for (quint8 c=0; c<nCounters; ++c) writeRing(rates [c].constData(), sizeof(RateType));
+    }
+};
+
+class CountersHistoryRpc : public DimRpc { //in: {board (0-19 for PMs by link №, 20 for TCM), counter, nSamples}; out: {time_ms, count, rate} triplets
+    std::function<QVector<double>(qint32 board, qint32 counter, qint32 nSamples)> query;
+    QVector<double> result;
+    void rpcHandler() override {
+        result.clear();
+        if (getSize() >= 3 * int(sizeof(qint32))) {
+            qint32 *d = (qint32 *)getData();
+            result = query(d[0], d[1], d[2]);
+        }
+        if (result.isEmpty()) result << -1.;
+        setData(result.data(), result.size() * int(sizeof(double)));
+    }
+public:
+    CountersHistoryRpc(const char *name, std::function<QVector<double>(qint32, qint32, qint32)> f): DimRpc(name, "I:3", "D"), query(f) {}
+};
+
+#endif // COUNTERSHISTORY_H
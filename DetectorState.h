@@ -0,0 +1,41 @@
+#ifndef DETECTORSTATE_H
+#define DETECTORSTATE_H
+
+#include <algorithm>
+#include "PM.h"
+
+struct DetectorState { //detector-wide tables updated in place by the readout; channel arrays are [20*iCh + iPM], the layout of the DIM array services, so they are published without gathering
+    static const quint16 nChannels = 12 * 20;
+    quint32 counts[2][nChannels] = {}; //[0] CFD, [1] TRG: <DET>/CNT_CH
+    float   rates [2][nChannels];      //[0] CFD, [1] TRG: <DET>/CNT_RATE_CH, -1 if unknown
+    quint32 CFD_THRESHOLD   [nChannels] = {},
+            THRESHOLD_CALIBR[nChannels] = {};
+    quint32 PMstatusOK = 0; //by link №: PLLs locked, TDCs in sync, GBT OK, no restart by PLL relock. TRG sync is TCM's part
+
+    DetectorState() { setRatesUnknown(); }
+
+    static quint16 index(quint8 iPM, quint8 iCh) { return 20 * iCh + iPM; }
+
+    void setRatesUnknown() { std::fill_n(rates[0], 2 * nChannels, -1.F); }
+
+    void storeCounters(quint8 iPM, const TypePM::Counters &c) { //after each counters entry of the PM
+        for (quint8 iCh=0; iCh<12; ++iCh) {
+            counts[0][index(iPM, iCh)] = c.Ch[iCh].CFD;
+            counts[1][index(iPM, iCh)] = c.Ch[iCh].TRG;
+            rates [0][index(iPM, iCh)] = c.rateCh[iCh].CFD;
+            rates [1][index(iPM, iCh)] = c.rateCh[iCh].TRG;
+        }
+    }
+
+    void storeActual(quint8 iPM, TypePM &pm) { //after the PM registers are read
+        for (quint8 iCh=0; iCh<12; ++iCh) {
+            CFD_THRESHOLD   [index(iPM, iCh)] = pm.act.Ch[iCh].CFD_THRESHOLD;
+            THRESHOLD_CALIBR[index(iPM, iCh)] = pm.act.THRESHOLD_CALIBR[iCh];
+        }
+        PMstatusOK = pm.isStatusOK() && pm.act.GBT.isOK() ? PMstatusOK | 1 << iPM : PMstatusOK & ~(1 << iPM);
+    }
+
+    void removePM(quint8 iPM) { PMstatusOK &= ~(1 << iPM); }
+};
+
+#endif // DETECTORSTATE_H
@@ -4,6 +4,7 @@
 #include <QtGlobal>
 #include <QHash>
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QVector>
 #include "DIM/dis.hxx"
 #include <functional>
@@ -218,19 +219,33 @@ static const quint8
     }
 };
 
+inline qint64 monotonicTime_ns() { //steady clock for all rate calculations, cheap and immune to wall clock adjustments
+    static const QElapsedTimer timer = [] { QElapsedTimer t; t.start(); return t; }();
+    return timer.nsecsElapsed();
+}
+
+template <typename T> void calculateRates(const quint32 *New, quint32 *Old, T *rate, quint8 n, double time_s, float w = 0) { //increments are taken modulo 2^32, so counters wraparound is harmless; w is the EWMA weight of the previous rate value, 0 means no smoothing
+    for (quint8 i=0; i<n; ++i) {
+        T r = T(quint32(New[i] - Old[i]) / time_s);
+        rate[i] = w > 0 && rate[i] >= 0 ? T(w * rate[i] + (1 - w) * r) : r; //negative rate means unknown
+        Old[i] = New[i];
+    }
+}
+
 struct GBTcounters {
-    QDateTime oldTime = QDateTime::currentDateTime(), newTime;
+    qint64  oldTime_ns = monotonicTime_ns();
     quint32 wordsOld  = 0 , eventsOld  = 0;
     double  wordsRate = 0., eventsRate = 0.;
+    static quint32 increment(quint32 New, quint32 Old) { quint32 d = New - Old; return d < 0x80000000 ? d : New; } //"negative" increment means the counter was reset, not wrapped
     void calculateRate(quint32 wordsNew, quint32 eventsNew) {
-        newTime = QDateTime::currentDateTime();
-        quint32 time_ms = oldTime.msecsTo(newTime);
-        if (time_ms < 100) return;
-         wordsRate =  wordsNew >=  wordsOld ? ( wordsNew -  wordsOld) * 1000. / time_ms :  wordsNew;
-        eventsRate = eventsNew >= eventsOld ? (eventsNew - eventsOld) * 1000. / time_ms : eventsNew;
+        qint64 newTime_ns = monotonicTime_ns();
+        double time_s = (newTime_ns - oldTime_ns) * 1e-9;
+        if (time_s < 0.05) return; //well below the polling tick, so that timer jitter doesn't skip updates
+         wordsRate = increment( wordsNew,  wordsOld) / time_s;
+        eventsRate = increment(eventsNew, eventsOld) / time_s;
          wordsOld =  wordsNew;
         eventsOld = eventsNew;
-        oldTime = newTime;
+        oldTime_ns = newTime_ns;
     }
 };
 struct GBTword {
@@ -300,10 +315,64 @@ struct Parameter {
            bitwidth,
            bitshift,
            interval; //for PM channels parameters only
-    Parameter(quint8 address = 0, quint8 bitwidth = 32, quint8 bitshift = 0, quint8 interval = 0): address(address), bitwidth(bitwidth), bitshift(bitshift), interval(interval) {}
+    constexpr Parameter(quint8 address = 0, quint8 bitwidth = 32, quint8 bitshift = 0, quint8 interval = 0): address(address), bitwidth(bitwidth), bitshift(bitshift), interval(interval) {}
+};
+
+struct NamedParameter {
+    const char *name = nullptr;
+    Parameter par;
 };
 
-const QHash<QString, Parameter> GBTparameters = {
+constexpr int compareNames(const char *a, const char *b) { //strcmp() usable at compile time
+    while (*a && *a == *b) { ++a; ++b; }
+    return int(quint8(*a)) - int(quint8(*b));
+}
+
+template <size_t N> class ParameterMap { //register map sorted by name at compile time
+    NamedParameter sorted[N] {};
+
+public:
+    constexpr ParameterMap(const NamedParameter (&table)[N]) {
+        for (size_t i=0; i<N; ++i) { //insertion sort
+            size_t j = i;
+            for (; j > 0 && compareNames(sorted[j - 1].name, table[i].name) > 0; --j) sorted[j] = sorted[j - 1];
+            sorted[j] = table[i];
+        }
+    }
+
+    constexpr const Parameter *find(const char *name) const { //binary search
+        size_t lo = 0, hi = N;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            int c = compareNames(sorted[mid].name, name);
+            if (c == 0) return &sorted[mid].par;
+            if (c < 0) lo = mid + 1; else hi = mid;
+        }
+        return nullptr;
+    }
+
+    const Parameter *find(const QString &name) const { //same search for names coming from DIM or text, without conversion of the name
+        size_t lo = 0, hi = N;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            int c = -name.compare(QLatin1String(sorted[mid].name));
+            if (c == 0) return &sorted[mid].par;
+            if (c < 0) lo = mid + 1; else hi = mid;
+        }
+        return nullptr;
+    }
+
+    consteval Parameter operator()(const char *name) const { //compile-time lookup for code: an unknown name is a compilation error
+        const Parameter *p = find(name);
+        if (p == nullptr) throw "unknown parameter name";
+        return *p;
+    }
+
+    bool contains(const QString &name) const { return find(name) != nullptr; }
+    Parameter operator[](const QString &name) const { const Parameter *p = find(name); return p ? *p : Parameter(); } //default for unknown names, like QHash
+};
+
+inline constexpr ParameterMap GBTparameters({
     //name                  address width shift
     {"DG_MODE"              , {0xD8,  4,  0}},
     {"TG_MODE"              , {0xD8,  4,  4}},
@@ -326,7 +395,7 @@ const QHash<QString, Parameter> GBTparameters = {
     {"RDH_SYS_ID"           , {0xE1,  8, 16}},
     {"BCID_DELAY"           , {0xE3, 12,  0}},
     {"DATA_SEL_TRG_MASK"    ,  0xE4         }
-};
+});
 
 struct Timestamp {
     quint32 second : 6, //0..59
@@ -341,6 +410,7 @@ struct Timestamp {
     QString printISO () { return QString::asprintf("20%02d-%02d-%02dT%02d:%02d:%02d", year, month, day, hour, minute, second); }
                                     //          ↓10       ↓20       ↓30       ↓40       ↓50     60↓  ↓63
     static constexpr char alph[65] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz|~";
+    quint32 code() const { return ((((year * 16 + month) * 32 + day) * 32 + hour) * 64) + minute; } //grows with time like printCode1(), for comparisons without formatting
     QString printCode1() { //from "011.a0" (beginning of 2020) to "hCV.Nx" (end of 2063), minute accuracy
         return *(quint32 *)(this)==0 ? "000000" : QString::asprintf("%c%c%c.%c%c", alph[(year - 20) % 64], alph[month], alph[day], alph[hour], alph[minute]);
     }
@@ -383,13 +453,26 @@ class AdvancedDIMservice {
     const size_t dataSize;
     void *dataNew, *dataOld;
     std::function<void(void *)> dataCollect;
+    const float deadband; //for float data only: changes not exceeding this value are not published
+    bool published = false;
+    bool valid = true;
+
+    bool hasChanged() {
+        if (!published) return true;
+        if (deadband <= 0) return memcmp(dataNew, dataOld, dataSize) != 0;
+        const float *n = (float *)dataNew, *o = (float *)dataOld;
+        for (size_t i=0; i<dataSize/sizeof(float); ++i) if (!(qAbs(n[i] - o[i]) <= deadband)) return true; //NaN is always a change
+        return false;
+    }
+
 public:
-    AdvancedDIMservice(const char *name, const char *format, size_t size, std::function<void(void *)> dataCollectingFunction, void *data = nullptr):
+    AdvancedDIMservice(const char *name, const char *format, size_t size, std::function<void(void *)> dataCollectingFunction, void *data = nullptr, float deadbandF = 0):
         dataIsExternal(data != nullptr),
         dataSize(size),
         dataNew(dataIsExternal ? data : malloc(dataSize)),
         dataOld(malloc(dataSize)),
-        dataCollect(dataCollectingFunction)
+        dataCollect(dataCollectingFunction),
+        deadband(format[0] == 'F' ? deadbandF : 0)
     {
         service = new DimService(name, format, dataNew, int(dataSize));
     }
@@ -400,13 +483,23 @@ public:
     }
     void updateService(bool onlyIfChanged = true) {
         if (dataCollect != 0) dataCollect(dataNew);
-        if (onlyIfChanged == false) {
-            service->updateService();
-        } else if (memcmp(dataNew, dataOld, dataSize) != 0) {//data has changed
+        if (!valid) { //the board is back: the value is published with good quality even if unchanged
+            valid = true;
+            service->setQuality(0);
+            onlyIfChanged = false;
+        }
+        if (onlyIfChanged == false || hasChanged()) {
             memcpy(dataOld, dataNew, dataSize);
+            published = true;
             service->updateService();
         }
     }
+    void invalidate() { //the board is not available: the service stays registered, the last value is republished with bad quality
+        if (!valid) return;
+        valid = false;
+        service->setQuality(1);
+        service->updateService();
+    }
 //    void updateAnyway() {
 //        if (dataCollect != 0) dataCollect(dataNew);
 //        service->updateService();
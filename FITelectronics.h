@@ -7,19 +7,47 @@
 #include "IPbusInterface.h"
 #include "TCM.h"
 #include "PM.h"
+#include "BoundedQueue.h"
+#include "CountersHistory.h"
+#include "Logger.h"
+#include "GBTerrorArchive.h"
+#include "ThresholdCalibration.h"
+#include "DetectorState.h"
 #include <cmath>
+#include <QMetaMethod>
+#include <QDir>
 
 extern double systemClock_MHz; //40
 extern double TDCunit_ps; // 13
 extern double halfBC_ns; // 12.5
 extern double phaseStepLaser_ns, phaseStep_ns;
 
+struct FITview { //what the GUI shows: a copy made by the I/O thread after each sync() and passed with valuesReady(), the live values are only touched by the I/O thread
+    quint32 BOARDS_OK = 0xFFFFFFFF,
+            PMpresent = 0; //by link №, the PMs found by the last links check
+    struct {
+        TypeTCM::ActualValues act;
+        TypeTCM::Settings set;
+        TypeTCM::Counters counters;
+        bool isOK = false, GBTisOK = false;
+    } TCM;
+    struct PMview {
+        TypePM::ActualValues act;
+        TypePM::Settings set;
+        TypePM::Counters counters;
+        TRGsyncStatus TRGsync = {};
+        bool isOK = false, GBTisOK = false;
+    } PM[20];
+};
+
 class FITelectronics: public IPbusTarget, public DimCommandHandler {
     Q_OBJECT
 public:
     TypeFITsubdetector subdetector;
     const quint16 TCMid;
     DimServer DIMserver;
+    static inline const quint32 errorReportFWcode = Timestamp(2022, 8, 29, 12, 18, 0).code(); //"28T.CI", first FPGA firmware with GBT error reports
+    const bool ownDIMserver; //false when several engines share one process and one DIM server
     QHash<DimCommand *, std::function<void(void *)>> allCommands;
     QList<AdvancedDIMservice *> services;
     AdvancedDIMservice *countsChannels, *countRatesChannels, *countsTriggers, *countRatesTriggers;
@@ -33,6 +61,14 @@ public:
             service->updateService();
         }
     } serverStatus;
+    struct TypeServerStats { //published as <DET>/SERVER_STATS after each full sync
+        double RTTp50_us, RTTp99_us, RTTmax_us, //round-trip times since the previous sync
+               packetsPerSecond, wordsPerSecond,
+               timeouts, retries, staleResponses, lateStatusResponses, //totals since start
+               sync_ms,
+               syncBoard_ms[21]; //PMs by link №, then TCM; 0 for boards not read. PMs are read together, so it's the time until the board was complete
+    } serverStats = {};
+    DimService *serverStatsService;
     TypeTCM TCM;
     TypePM allPMs[20] = { //PMs by link №
         TypePM(0x0200, "A0", TCM.act.TRG_SYNC_A[0]),
@@ -58,29 +94,79 @@ public:
     };
     QMap<quint16, TypePM *> PM;
     QList<TypePM *> PMsA, PMsC;
-    QFile logFile;
-    QTextStream logStream;
+    Logger logger;
+    GBTerrorArchive errorArchive;
+    DimService *errorStatsService; //<DET>/ERROR_STATS: GBT error reports by board and code
+    GBTerrorsRpc *errorsRpc;
+    bool errorStatsChanged = false;
     bool PMsReady = false;
+    quint32 PMsFailed = 0; //PMs by link № whose last readout failed
     quint8 noResponseCounter = 0;
+    static const quint32 allBoardsMask = 0x1FFFFF; //bits 0-19 for PMs, bit 20 for TCM
+    quint32 staleConfig = allBoardsMask; //boards whose configuration registers have to be re-read
+    static const qint32 configReadPeriod_ms = 30000; //background re-reads of configuration registers, FW timestamps and serial numbers
+    qint64 lastConfigRead_ms = 0;
+    static const quint16 pollingTick_ms = 100; //sync() period, every polling class is read at its own multiple of it
+    enum PollingClass {pollLinkStatus = 0, pollValues = 1, pollTemperatures = 2, nPollingClasses = 3};
+    struct {
+        const char *name;
+        quint16 period_ms;
+        qint64 due_ms;
+    } polling[nPollingClasses] = {{"linkStatus", 100, 0}, {"values", 1000, 0}, {"temperatures", 10000, 0}};
+    struct DueRegblocks { //regblocks of every combination of polling classes, built once so that polling doesn't allocate
+        QVector<regblock> byMask[1 << nPollingClasses];
+        quint16 responseWords[1 << nPollingClasses] = {0}; //headers included
+        DueRegblocks(const QVector<regblock> *classes) {
+            for (quint8 due=1; due < 1 << nPollingClasses; ++due) for (quint8 i=0; i<nPollingClasses; ++i) if (due & 1 << i) byMask[due] += classes[i];
+            for (quint8 due=1; due < 1 << nPollingClasses; ++due) foreach (regblock b, byMask[due]) responseWords[due] += 1 + b.size();
+        }
+    };
+    const DueRegblocks dueTCM {TypeTCM::ActualValues::pollingRegblocks}, duePM {TypePM::ActualValues::pollingRegblocks};
+    struct { //state of the current readPMs() cycle: packet handlers capture only this and an index, so that a cycle doesn't allocate
+        IPbusControlPacket *packets[40]; //from the pool
+        quint8 nPackets = 0, packetPM[40], nPending[20]; //link № by own packet; packets of the PM not answered yet
+        quint32 sharedPMs[40]; //PMs by link № read by a shared packet, 0 for an own packet
+        bool isProbe[40]; //first own packet of the PM, starting with the SPI probe
+        quint32 failed, absent, withErrorReport, retried;
+        QString boardError[20]; //first error of the PM in this cycle: logged, not emitted, so that polling of the other boards goes on
+        GBTerrorReport errorReports[20];
+        qint64 tStart_ns;
+    } cycle;
+
+    DetectorState state;
+    float ratesSmoothing = 0; //EWMA weight of the previous rate value, 0 means no smoothing; set by <DET>/CNT_RATE_SMOOTHING in the I/O thread
+    ThresholdCalibration calibration;
+    quint8 calibrationEntries[20] = {0}; //counters entries since the last thresholds write, by link №
+    quint32 calibrationWritten = 0; //PMs with thresholds waiting to be written
+    quint32 calibrationCounts[20][12]; //CFD counts at the start of the current measurement, raw increments are used: smoothed rates lag behind threshold changes
+    qint32 calibrationProgress[4] = {0}, calibrationResult[240] = {0}; //{running, converged channels, channels, steps}; thresholds [20*iCh + iPM]
+    DimService *calibrationProgressService, *calibrationResultService;
+    static const quint8 calibrationSettleEntries = 2; //the first entry after a write may span it
 
 //debug functions variables
-    QMetaObject::Connection adjustConnection;
-    bool adjEven = false;
-    quint16 thHi[12], thLo[12] = {0};
-    double targetRate_Hz = 15.;
-    TypePM *targetPM;
-
-    QTimer *countersTimer = new QTimer();
-    QTimer *shuttleTimer = new QTimer();
+
+    QTimer *countersTimer = new QTimer(this);
+    static const quint8 maxCountersEntriesPerTick = 16; //the rest stays in FIFO until the next tick
+    quint32 countersFIFOdata[21][maxCountersEntriesPerTick * TypePM::Counters::number]; //[0-19] for PMs by link №, [20] for TCM
+    CountersHistory<TypePM ::Counters::number, float > *historyPM  = new CountersHistory<TypePM ::Counters::number, float >[20]; //200 bytes per sample and PM, sized by resizeCountersHistory()
+    CountersHistory<TypeTCM::Counters::number, double> *historyTCM = new CountersHistory<TypeTCM::Counters::number, double>;
+    quint16 countersHistory_min = 5; //span of the counters history at the current update period
+    static const inline QString countersHistoryDir = "./countersHistory/"; //<DET>/COUNTERS_HISTORY/DUMP writes only here
+    CountersHistoryRpc *historyRpc;
+    QTimer *shuttleTimer = new QTimer(this);
     qint16 shuttleStartPhase = -1024;
 //system variables
     quint32 BOARDS_OK = 0xFFFFFFFF;
-
-    FITelectronics(TypeFITsubdetector sd): IPbusTarget(50006), subdetector(sd), TCMid(FIT[sd].TCMid) {
-        logFile.setFileName(QCoreApplication::applicationName() + ".log");
-        logFile.open(QFile::WriteOnly | QIODevice::Append | QFile::Text);
-        logStream.setDevice(&logFile);
+//I/O thread
+    QThread *IOthread = nullptr;
+    BoundedQueue<std::function<void()>, 1024> requests; //from DIM and GUI threads
+    std::atomic<bool> requestsScheduled {false};
+
+    FITelectronics(TypeFITsubdetector sd, quint16 localPort = 50006, bool standalone = true): IPbusTarget(localPort), subdetector(sd), TCMid(FIT[sd].TCMid), ownDIMserver(standalone),
+        logger(QCoreApplication::applicationName() + (standalone ? "" : QString("_") + FIT[sd].name) + ".log"), //engines sharing a process log separately
+        errorArchive(QCoreApplication::applicationName() + (standalone ? "" : QString("_") + FIT[sd].name) + ".gbterr") {
         log(qApp->applicationName() + " v" + qApp->applicationVersion() + " started");
+        qRegisterMetaType<FITview>("FITview");
         for (quint8 i=0; i<10; ++i) {
             allPMs[i     ].FEEid = FIT[sd].PMA0id + i;
             allPMs[i + 10].FEEid = FIT[sd].PMC0id + i;
@@ -90,18 +176,22 @@ public:
         TCM.set.T3_SIGN = FIT[sd].triggers[2].signature;
         TCM.set.T4_SIGN = FIT[sd].triggers[3].signature;
         TCM.set.T5_SIGN = FIT[sd].triggers[4].signature;
+        updateTimer->start(updatePeriod_ms = pollingTick_ms);
         countersTimer->setTimerType(Qt::PreciseTimer);
         connect(countersTimer, &QTimer::timeout, this, [=](){
-            IPbusControlPacket p; connect(&p, &IPbusControlPacket::error, this, &IPbusTarget::error);
+            IPbusControlPacket p(forwardError);
             p.addTransaction(read, 0x0F, &TCM.act.registers[0x0F]); //status register
+            addCountersFIFOloadReads(p);
             if (!transceive(p)) return;
             if (TCM.act.resetSystem) {
                 PMsReady = false;
+                staleConfig = allBoardsMask;
                 PM.clear();
+                state.PMstatusOK = 0;
                 PMsA.clear();
                 PMsC.clear();
             }
-            readCountersFIFO();
+            drainCountersFIFO();
         });
         connect(shuttleTimer, &QTimer::timeout, this, &FITelectronics::inverseLaserPhase);
         connect(this, &IPbusTarget::error     , this, [=](QString message) {
@@ -123,15 +213,17 @@ public:
         connect(this, &IPbusTarget::IPbusStatusOK, this, [=]() {
             noResponseCounter = 0;
             serverStatus.update("OK");
-            IPbusControlPacket p; connect(&p, &IPbusControlPacket::error, this, &IPbusTarget::error);
+            TCM.ORBIT_FILL_MASKisKnown = false; //could be changed while disconnected
+            IPbusControlPacket p(forwardError);
             p.addNBitsToChange(0xE, subdetector == FV0 ? 0x3 : 0, 2, 8); //apply FV0 trigger mode
-            p.addWordToWrite(TCMparameters["T1_SIGN"].address, prepareSignature(FIT[sd].triggers[0].signature));
-            p.addWordToWrite(TCMparameters["T2_SIGN"].address, prepareSignature(FIT[sd].triggers[1].signature));
-            p.addWordToWrite(TCMparameters["T3_SIGN"].address, prepareSignature(FIT[sd].triggers[2].signature));
-            p.addWordToWrite(TCMparameters["T4_SIGN"].address, prepareSignature(FIT[sd].triggers[3].signature));
-            p.addWordToWrite(TCMparameters["T5_SIGN"].address, prepareSignature(FIT[sd].triggers[4].signature));
+            p.addWordToWrite(TCMparameters("T1_SIGN").address, prepareSignature(FIT[sd].triggers[0].signature));
+            p.addWordToWrite(TCMparameters("T2_SIGN").address, prepareSignature(FIT[sd].triggers[1].signature));
+            p.addWordToWrite(TCMparameters("T3_SIGN").address, prepareSignature(FIT[sd].triggers[2].signature));
+            p.addWordToWrite(TCMparameters("T4_SIGN").address, prepareSignature(FIT[sd].triggers[3].signature));
+            p.addWordToWrite(TCMparameters("T5_SIGN").address, prepareSignature(FIT[sd].triggers[4].signature));
             if (!transceive(p)) return;
             PMsReady = false;
+            staleConfig = allBoardsMask;
             sync();
         });
         connect(this, &FITelectronics::resetFinished, this, [=]() {
@@ -142,12 +234,25 @@ public:
             apply_COUNTERS_UPD_RATE(TCM.set.COUNTERS_UPD_RATE);
         });
 
-        qRegisterMetaType<DimCommand *>("DIMcommandPointer");
-        connect(this, &FITelectronics::DIMcommandReceived, this, &FITelectronics::executeDIMcommand);
         serverStatus.service = new DimService(qPrintable(QString(FIT[sd].name) + "/SERVER_STATUS"), serverStatus.string);
-        allCommands.insert(new DimCommand(qPrintable(QString(FIT[sd].name) + "/STOP_SERVER"), "C:1", this), [=](void * ) { qApp->exit(); });
-        DIMserver.setDnsNode("localhost");
-        DIMserver.start(qPrintable(QString(FIT[sd].name) + "_DIM_SERVER"));
+        errorStatsService = new DimService(qPrintable(QString(FIT[sd].name) + "/ERROR_STATS"), "I:84", errorArchive.counts, sizeof(errorArchive.counts));
+        errorsRpc = new GBTerrorsRpc(qPrintable(QString(FIT[sd].name) + "/GBT_ERRORS"), [=](qint32 nReports) { return errorArchive.query(nReports); });
+        serverStatsService = new DimService(qPrintable(QString(FIT[sd].name) + "/SERVER_STATS"), "D:31", &serverStats, sizeof(serverStats));
+        calibrationProgressService = new DimService(qPrintable(QString(FIT[sd].name) + "/THRESHOLD_CALIBRATION/PROGRESS"), "I:4", calibrationProgress, sizeof(calibrationProgress));
+        calibrationResultService = new DimService(qPrintable(QString(FIT[sd].name) + "/THRESHOLD_CALIBRATION/RESULT"), "I:240", calibrationResult, sizeof(calibrationResult));
+        allCommands.insert(new DimCommand(qPrintable(QString(FIT[sd].name) + "/THRESHOLD_CALIBRATION/start"), "F", this), [=](void *d) { startThresholdCalibration(*(float *)d); }); //target CFD rate, Hz
+        allCommands.insert(new DimCommand(qPrintable(QString(FIT[sd].name) + "/THRESHOLD_CALIBRATION/stop"), "C:1", this), [=](void * ) { stopThresholdCalibration(); });
+        connect(this, &FITelectronics::countersReady, this, [=](quint16 FEEid) { if (calibration.running) calibrationStep(FEEid); });
+        allCommands.insert(new DimCommand(qPrintable(QString(FIT[sd].name) + "/STOP_SERVER"), "C:1", this), [=](void * ) { QMetaObject::invokeMethod(qApp, "quit", Qt::QueuedConnection); });
+        historyRpc = new CountersHistoryRpc(qPrintable(QString(FIT[sd].name) + "/COUNTERS_HISTORY"), [=](qint32 board, qint32 counter, qint32 nSamples) {
+            if (nSamples <= 0 || counter < 0) return QVector<double>();
+            if (board == 20) return historyTCM->query(counter, nSamples);
+            return board >= 0 && board < 20 ? historyPM[board].query(counter, nSamples) : QVector<double>();
+        });
+        if (ownDIMserver) {
+            DIMserver.setDnsNode("localhost");
+            DIMserver.start(qPrintable(QString(FIT[sd].name) + "_DIM_SERVER"));
+        } //otherwise the owner starts one server for all engines
     }
 
     ~FITelectronics() {
@@ -155,12 +260,18 @@ public:
         deleteTCMservices();
         setRatesUnknown();
         serverStatus.update("offline");
-        DIMserver.stop();
+        if (ownDIMserver) DIMserver.stop();
+        delete historyRpc;
+        delete errorsRpc;
+        delete errorStatsService;
+        delete calibrationProgressService;
+        delete calibrationResultService;
+        delete[] historyPM;
+        delete historyTCM;
         log(qApp->applicationName() + " v" + qApp->applicationVersion() + " stopped");
-        logFile.close();
     }
 
-    void log(QString st) { logStream << QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzz ") + st << Qt::endl; logStream.flush(); }
+    void log(QString st) { logger.write(st); }
 
     void addCommand(QList<DimCommand *> &list, QString name, const char* format, std::function<void(void *)> function) {
         DimCommand *command = new DimCommand(qPrintable(name), format, this);
@@ -168,64 +279,73 @@ public:
         allCommands.insert(command, function);
     }
     void addArrayCommand(QString parameter) { //channels parameters only
-        if (!PMparameters.contains(parameter)) {
+        const Parameter *found = PMparameters.find(parameter);
+        if (found == nullptr) {
             emit error("No such PM parameter: " + parameter, logicError);
             return;
         }
-        const Parameter par = PMparameters[parameter];
+        const Parameter par = *found;
         if (par.interval == 0) emit error("Not an array parameter!", logicError);
         addCommand(commands, QString(FIT[subdetector].name) + "/" + parameter + "/apply", "I", [=](void *d) {
             qint32 &id = ((qint32 *)d)[0], *V = (qint32 *)d + 1;
-            if (id == -1) {//all channels at once
-                for(quint8 iPM=0; iPM<20; ++iPM) for (quint8 iCh=0; iCh<12; ++iCh) allPMs[iPM].setParameter(parameter, V[20*iCh + iPM], iCh);
-                IPbusControlPacket p; connect(&p, &IPbusControlPacket::error, this, &IPbusTarget::error);
-                foreach(auto side, QList({PMsA, PMsC})) {
-                    foreach(TypePM *pm, side) for (quint8 iCh=0, iPM=pm-allPMs; iCh<12; ++iCh) {
-                        quint32 address = par.address + iCh * par.interval, value = changeNbits(pm->act.registers[address], par.bitwidth, par.bitshift, V[20*iCh + iPM]);
-                        p.addWordToWrite(pm->baseAddress + address, value);
-                    }
-                    if (!p.transactionsList.isEmpty()) transceive(p);
-                }
-                sync();
-            } else if (id < 240) {
+            if (id == -1) applyChannelArray(par, V); //all channels at once
+            else if (id < 240) {
                 quint8 iPM = id % 20, iCh = id / 20;
                 if ((1 << iPM & TCM.act.PM_MASK_SPI) == 0) return;
                 TypePM *pm = allPMs + iPM;
-                pm->setParameter(parameter, *V, iCh);
-                writeParameter(parameter, *V, pm->FEEid, iCh);
+                pm->setParameter(par, *V, iCh);
+                writeParameter(par, *V, pm->FEEid, iCh);
             }
         });
     }
 
+    void applyChannelArray(const Parameter par, const qint32 *V) { //V[20*iCh + iPM] as in DIM arrays; settings of all PMs are updated, available PMs are written
+        const quint32 mask = par.bitwidth >= 32 ? 0xFFFFFFFF : ((1U << par.bitwidth) - 1) << par.bitshift;
+        quint32 field[20][12]; //values already shifted and masked, transposed to PM-major order
+        for (quint8 iCh=0; iCh<12; ++iCh) for (quint8 iPM=0; iPM<20; ++iPM) field[iPM][iCh] = quint32(V[20*iCh + iPM]) << par.bitshift & mask;
+        for (quint8 iPM=0; iPM<20; ++iPM) for (quint8 iCh=0; iCh<12; ++iCh) {
+            quint32 &reg = allPMs[iPM].set.registers[par.address + iCh * par.interval];
+            reg = (reg & ~mask) | field[iPM][iCh];
+        }
+        beginBatch();
+        foreach (TypePM *pm, PM) {
+            quint8 iPM = pm - allPMs;
+            if (par.bitwidth < 32) for (quint8 iCh=0; iCh<12; ++iCh) writeNbits(pm->baseAddress + par.address + iCh * par.interval, quint32(V[20*iCh + iPM]), par.bitwidth, par.bitshift); //RMW: other bits are kept by the board itself, the actual values may be a configuration read old
+            else if (par.interval == 1) writeBlock(pm->baseAddress + par.address, field[iPM], 12); //one write transaction per PM
+            else for (quint8 iCh=0; iCh<12; ++iCh) writeRegister(pm->baseAddress + par.address + iCh * par.interval, field[iPM][iCh]); //interleaved with other parameters, packed into the same packets
+        }
+        commitBatch();
+    }
+
     void createPMservices(TypePM *pm) {
         QString pfx = QString::asprintf("%s/PM%s/", FIT[subdetector].name, pm->name);
-        pm->services.append(new DimService(qP(pfx+"status/TEMP_BOARD"      ), "F", &pm->act.TEMP_BOARD      , 4));
-        pm->services.append(new DimService(qP(pfx+"status/TEMP_FPGA"       ), "F", &pm->act.TEMP_FPGA       , 4));
-        pm->services.append(new DimService(qP(pfx+"status/VOLTAGE_1V"      ), "F", &pm->act.VOLTAGE_1V      , 4));
-        pm->services.append(new DimService(qP(pfx+"status/VOLTAGE_1_8V"    ), "F", &pm->act.VOLTAGE_1_8V    , 4));
-        pm->services.append(new DimService(qP(pfx+"status/BOARD_TYPE"      ), "C:4",pm->act.BOARD_TYPE      , 4));
-        pm->services.append(new DimService(qP(pfx+"status/FW_TIME_MCU"     ), "I", &pm->act.FW_TIME_MCU     , 4));
-        pm->services.append(new DimService(qP(pfx+"status/FW_TIME_FPGA"    ), "I", &pm->act.FW_TIME_FPGA    , 4));
-        pm->services.append(new DimService(qP(pfx+"status/CH_BASELINES_NOK"), "I", &pm->act.CH_BASELINES_NOK, 4));
-        pm->services.append(new DimService(qP(pfx+"status/SERIAL_NUM"      ), "S", (char *)&pm->act.registers[0xBD]+ 1, 2));
-        pm->services.append(new DimService(qP(pfx+"control/CH_MASK_DATA""/actual"), "I", &pm->act.CH_MASK_DATA, 4));
-        pm->services.append(new DimService(qP(pfx+"control/CH_MASK_TRG" "/actual"), "I", &pm->act.CH_MASK_TRG , 4));
+        pm->services.append(new AdvancedDIMservice(qP(pfx+"status/TEMP_BOARD"            ), "F"  , 4, {}, &pm->act.TEMP_BOARD                , 0.1F));
+        pm->services.append(new AdvancedDIMservice(qP(pfx+"status/TEMP_FPGA"             ), "F"  , 4, {}, &pm->act.TEMP_FPGA                 , 0.1F));
+        pm->services.append(new AdvancedDIMservice(qP(pfx+"status/VOLTAGE_1V"            ), "F"  , 4, {}, &pm->act.VOLTAGE_1V                , 0.001F));
+        pm->services.append(new AdvancedDIMservice(qP(pfx+"status/VOLTAGE_1_8V"          ), "F"  , 4, {}, &pm->act.VOLTAGE_1_8V              , 0.001F));
+        pm->services.append(new AdvancedDIMservice(qP(pfx+"status/BOARD_TYPE"            ), "C:4", 4, {}, pm->act.BOARD_TYPE                 ));
+        pm->services.append(new AdvancedDIMservice(qP(pfx+"status/FW_TIME_MCU"           ), "I"  , 4, {}, &pm->act.FW_TIME_MCU               ));
+        pm->services.append(new AdvancedDIMservice(qP(pfx+"status/FW_TIME_FPGA"          ), "I"  , 4, {}, &pm->act.FW_TIME_FPGA              ));
+        pm->services.append(new AdvancedDIMservice(qP(pfx+"status/CH_BASELINES_NOK"      ), "I"  , 4, {}, &pm->act.CH_BASELINES_NOK          ));
+        pm->services.append(new AdvancedDIMservice(qP(pfx+"status/SERIAL_NUM"            ), "S"  , 2, {}, (char *)&pm->act.registers[0xBD]+ 1));
+        pm->services.append(new AdvancedDIMservice(qP(pfx+"control/CH_MASK_DATA""/actual"), "I"  , 4, {}, &pm->act.CH_MASK_DATA              ));
+        pm->services.append(new AdvancedDIMservice(qP(pfx+"control/CH_MASK_TRG" "/actual"), "I"  , 4, {}, &pm->act.CH_MASK_TRG               ));
     }
 
     void createDIMservices() { //+ system services
         QString pfx = QString::asprintf("%s/TCM/", FIT[subdetector].name);
-        TCM.services.append(new DimService(qP(pfx+"status/TEMP_BOARD"  ), "F", &TCM.act.TEMP_BOARD                   , 4));
-        TCM.services.append(new DimService(qP(pfx+"status/TEMP_FPGA"   ), "F", &TCM.act.TEMP_FPGA                    , 4));
-        TCM.services.append(new DimService(qP(pfx+"status/VOLTAGE_1V"  ), "F", &TCM.act.VOLTAGE_1V                   , 4));
-        TCM.services.append(new DimService(qP(pfx+"status/VOLTAGE_1_8V"), "F", &TCM.act.VOLTAGE_1_8V                 , 4));
-        TCM.services.append(new DimService(qP(pfx+"status/SERIAL_NUM"  ), "S", (char *)&TCM.act.registers[0x7] + 1   , 2));
-        TCM.services.append(new DimService(qP(pfx+"status/BOARD_TYPE"  ), "C:4",TCM.act.BOARD_TYPE                   , 4));
-        TCM.services.append(new DimService(qP(pfx+"status/FW_TIME_MCU" ), "I", &TCM.act.FW_TIME_MCU                  , 4));
-        TCM.services.append(new DimService(qP(pfx+"status/FW_TIME_FPGA"), "I", &TCM.act.FW_TIME_FPGA                 , 4));
-        TCM.services.append(new DimService(qP(pfx+"status/PM_MASK_SPI" ), "I", &TCM.act.PM_MASK_SPI                  , 4));
+        TCM.services.append(new AdvancedDIMservice(qP(pfx+"status/TEMP_BOARD"  ), "F"  , 4, {}, &TCM.act.TEMP_BOARD                , 0.1F));
+        TCM.services.append(new AdvancedDIMservice(qP(pfx+"status/TEMP_FPGA"   ), "F"  , 4, {}, &TCM.act.TEMP_FPGA                 , 0.1F));
+        TCM.services.append(new AdvancedDIMservice(qP(pfx+"status/VOLTAGE_1V"  ), "F"  , 4, {}, &TCM.act.VOLTAGE_1V                , 0.001F));
+        TCM.services.append(new AdvancedDIMservice(qP(pfx+"status/VOLTAGE_1_8V"), "F"  , 4, {}, &TCM.act.VOLTAGE_1_8V              , 0.001F));
+        TCM.services.append(new AdvancedDIMservice(qP(pfx+"status/SERIAL_NUM"  ), "S"  , 2, {}, (char *)&TCM.act.registers[0x7] + 1));
+        TCM.services.append(new AdvancedDIMservice(qP(pfx+"status/BOARD_TYPE"  ), "C:4", 4, {}, TCM.act.BOARD_TYPE                 ));
+        TCM.services.append(new AdvancedDIMservice(qP(pfx+"status/FW_TIME_MCU" ), "I"  , 4, {}, &TCM.act.FW_TIME_MCU               ));
+        TCM.services.append(new AdvancedDIMservice(qP(pfx+"status/FW_TIME_FPGA"), "I"  , 4, {}, &TCM.act.FW_TIME_FPGA              ));
+        TCM.services.append(new AdvancedDIMservice(qP(pfx+"status/PM_MASK_SPI" ), "I"  , 4, {}, &TCM.act.PM_MASK_SPI               ));
         for (quint8 iPM=0; iPM<10; ++iPM) {
-            TCM.services.append(new DimService(qPf("%s/TCM/status/TRG_SYNC/%s", FIT[subdetector].name, allPMs[iPM   ].name), "I", TCM.act.TRG_SYNC_A + iPM, 4));
-            TCM.services.append(new DimService(qPf("%s/TCM/status/TRG_SYNC/%s", FIT[subdetector].name, allPMs[iPM+10].name), "I", TCM.act.TRG_SYNC_C + iPM, 4));
+            TCM.services.append(new AdvancedDIMservice(qPf("%s/TCM/status/TRG_SYNC/%s", FIT[subdetector].name, allPMs[iPM   ].name), "I", 4, {}, TCM.act.TRG_SYNC_A + iPM));
+            TCM.services.append(new AdvancedDIMservice(qPf("%s/TCM/status/TRG_SYNC/%s", FIT[subdetector].name, allPMs[iPM+10].name), "I", 4, {}, TCM.act.TRG_SYNC_C + iPM));
         }
 
         for (quint8 i=0; i<5; ++i) {
@@ -292,9 +412,12 @@ public:
         services.append(new AdvancedDIMservice(qP(pfx+"ATTEN_STATUS"                ), "I", 4, [=](void *d) { *(quint32 *)d = TCM.act.registers[0x3] >> 14 ; }));
 
         addCommand(commands, pfx+"LOAD_CONFIG"   , "C"  , [=](void *d) { QString name((char *)d); fileRead(name, true); });
+        addCommand(commands, pfx+"LOAD_CONFIG_DELTA", "C", [=](void *d) { QString name((char *)d); fileRead(name, true, true); }); //only registers differing from actual values are written
         addCommand(commands, pfx+"CLEAR_ERRORS"  , "C:1", [=](void * ) { apply_RESET_ERRORS(); });
         addCommand(commands, pfx+"RECONNECT"     , "C:1", [=](void * ) { reconnect(); });
         addCommand(commands, pfx+"RESTART_SYSTEM", "C:1", [=](void * ) { apply_RESET_SYSTEM(false); });
+        addCommand(commands, pfx+"COUNTERS_HISTORY/DUMP", "C", [=](void *d) { dumpCountersHistory(QString((char *)d)); });
+        addCommand(commands, pfx+"CNT_RATE_SMOOTHING", "F", [=](void *d) { ratesSmoothing = qBound(0.F, *(float *)d, 0.99F); }); //0 - off, closer to 1 - smoother
 
         addCommand(commands, pfx+"LASER_ENABLED"      "/apply", "S", [=](void *d) { apply_LASER_ENABLED            (*(bool    *)d); });
         addCommand(commands, pfx+"LASER_SOURCE"       "/apply", "S", [=](void *d) { apply_LASER_SOURCE             (*(bool    *)d); });
@@ -326,17 +449,11 @@ public:
             (( qint32 *)d)[  0 + 20*iCh + iPM] = pm->act.timeAlignment[iCh].value;                                 }));
         services.append(new AdvancedDIMservice(qP(pfx+"CFD_ZERO"      "/actual"), "I:240",   12*20*4, [=](void *d) { foreach(TypePM *pm, PM) for(quint8 iCh=0, iPM=pm-allPMs; iCh<12; ++iCh)
             (( qint32 *)d)[  0 + 20*iCh + iPM] = pm->act.Ch[iCh].CFD_ZERO;                                         }));
-        services.append(new AdvancedDIMservice(qP(pfx+"CFD_THRESHOLD" "/actual"), "I:240",   12*20*4, [=](void *d) { foreach(TypePM *pm, PM) for(quint8 iCh=0, iPM=pm-allPMs; iCh<12; ++iCh)
-            ((quint32 *)d)[  0 + 20*iCh + iPM] = pm->act.Ch[iCh].CFD_THRESHOLD;                                    }));
-        services.append(new AdvancedDIMservice(qP(pfx+"THRESHOLD_CALIBR/actual"), "I:240",   12*20*4, [=](void *d) { foreach(TypePM *pm, PM) for(quint8 iCh=0, iPM=pm-allPMs; iCh<12; ++iCh)
-            ((quint32 *)d)[  0 + 20*iCh + iPM] = pm->act.THRESHOLD_CALIBR[iCh];                                    }));
-
-        countRatesChannels = new AdvancedDIMservice(qP(pfx+"CNT_RATE_CH"       ), "F:480", 2*12*20*4, [=](void *d) { foreach(TypePM *pm, PM) for(quint8 iCh=0, iPM=pm-allPMs; iCh<12; ++iCh) {
-            ((float   *)d)[  0 + 20*iCh + iPM] = pm->counters.rateCh[iCh].CFD;
-            ((float   *)d)[240 + 20*iCh + iPM] = pm->counters.rateCh[iCh].TRG;                                   } });
-        countsChannels     = new AdvancedDIMservice(qP(pfx+"CNT_CH"            ), "I:480", 2*12*20*4, [=](void *d) { foreach(TypePM *pm, PM) for(quint8 iCh=0, iPM=pm-allPMs; iCh<12; ++iCh) {
-            ((quint32 *)d)[  0 + 20*iCh + iPM] = pm->counters.Ch[iCh].CFD;
-            ((quint32 *)d)[240 + 20*iCh + iPM] = pm->counters.Ch[iCh].TRG;                                       } });
+        services.append(new AdvancedDIMservice(qP(pfx+"CFD_THRESHOLD" "/actual"), "I:240", sizeof(state.CFD_THRESHOLD   ), {}, state.CFD_THRESHOLD   ));
+        services.append(new AdvancedDIMservice(qP(pfx+"THRESHOLD_CALIBR/actual"), "I:240", sizeof(state.THRESHOLD_CALIBR), {}, state.THRESHOLD_CALIBR));
+
+        countRatesChannels = new AdvancedDIMservice(qP(pfx+"CNT_RATE_CH"       ), "F:480", sizeof(state.rates ), {}, state.rates ); //published directly from the detector state
+        countsChannels     = new AdvancedDIMservice(qP(pfx+"CNT_CH"            ), "I:480", sizeof(state.counts), {}, state.counts);
 
         services.append(new AdvancedDIMservice(qP(pfx+"CH_MASK_DATA"  "/actual"), "I:20" ,      20*4, [=](void *d) { foreach(TypePM *pm, PM) ((quint32 *)d)[pm-allPMs] = pm->act.CH_MASK_DATA; }));
         services.append(new AdvancedDIMservice(qP(pfx+"CH_MASK_TRG"   "/actual"), "I:20" ,      20*4, [=](void *d) { foreach(TypePM *pm, PM) ((quint32 *)d)[pm-allPMs] = pm->act.CH_MASK_TRG ; }));
@@ -346,6 +463,49 @@ public:
                                                          ((quint32 *)d)[20]        =                           TCM.act.GBT.Status.RX_PHASE;
         }));
 
+        //whole-detector status arrays: [0-19] for PMs by link №, [20] for TCM, -1 for absent PMs
+        services.append(new AdvancedDIMservice(qP(pfx+"TEMP_BOARD"             ), "F:21" , 4     *21, [=](void *d) {
+            for(TypePM *pm=allPMs, *e=pm+20; pm<e; ++pm) ((float   *)d)[pm-allPMs] = (PM.contains(pm->FEEid) ? pm->act.TEMP_BOARD   : -1);
+                                                         ((float   *)d)[20]        =                           TCM.act.TEMP_BOARD;
+        }, nullptr, 0.1F));
+        services.append(new AdvancedDIMservice(qP(pfx+"TEMP_FPGA"              ), "F:21" , 4     *21, [=](void *d) {
+            for(TypePM *pm=allPMs, *e=pm+20; pm<e; ++pm) ((float   *)d)[pm-allPMs] = (PM.contains(pm->FEEid) ? pm->act.TEMP_FPGA    : -1);
+                                                         ((float   *)d)[20]        =                           TCM.act.TEMP_FPGA;
+        }, nullptr, 0.1F));
+        services.append(new AdvancedDIMservice(qP(pfx+"VOLTAGE_1V"             ), "F:21" , 4     *21, [=](void *d) {
+            for(TypePM *pm=allPMs, *e=pm+20; pm<e; ++pm) ((float   *)d)[pm-allPMs] = (PM.contains(pm->FEEid) ? pm->act.VOLTAGE_1V   : -1);
+                                                         ((float   *)d)[20]        =                           TCM.act.VOLTAGE_1V;
+        }, nullptr, 0.001F));
+        services.append(new AdvancedDIMservice(qP(pfx+"VOLTAGE_1_8V"           ), "F:21" , 4     *21, [=](void *d) {
+            for(TypePM *pm=allPMs, *e=pm+20; pm<e; ++pm) ((float   *)d)[pm-allPMs] = (PM.contains(pm->FEEid) ? pm->act.VOLTAGE_1_8V : -1);
+                                                         ((float   *)d)[20]        =                           TCM.act.VOLTAGE_1_8V;
+        }, nullptr, 0.001F));
+        services.append(new AdvancedDIMservice(qP(pfx+"SERIAL_NUM"             ), "I:21" , 4     *21, [=](void *d) {
+            for(TypePM *pm=allPMs, *e=pm+20; pm<e; ++pm) (( qint32 *)d)[pm-allPMs] = (PM.contains(pm->FEEid) ? pm->act.SERIAL_NUM : -1);
+                                                         (( qint32 *)d)[20]        =                           TCM.act.SERIAL_NUM;
+        }));
+        services.append(new AdvancedDIMservice(qP(pfx+"FW_TIME_MCU"            ), "I:21" , 4     *21, [=](void *d) {
+            for(TypePM *pm=allPMs, *e=pm+20; pm<e; ++pm) ((quint32 *)d)[pm-allPMs] = (PM.contains(pm->FEEid) ? *(quint32 *)&pm->act.FW_TIME_MCU : -1);
+                                                         ((quint32 *)d)[20]        =                           *(quint32 *)&TCM.act.FW_TIME_MCU;
+        }));
+        services.append(new AdvancedDIMservice(qP(pfx+"FW_TIME_FPGA"           ), "I:21" , 4     *21, [=](void *d) {
+            for(TypePM *pm=allPMs, *e=pm+20; pm<e; ++pm) ((quint32 *)d)[pm-allPMs] = (PM.contains(pm->FEEid) ? *(quint32 *)&pm->act.FW_TIME_FPGA : -1);
+                                                         ((quint32 *)d)[20]        =                           *(quint32 *)&TCM.act.FW_TIME_FPGA;
+        }));
+        services.append(new AdvancedDIMservice(qP(pfx+"CH_BASELINES_NOK"       ), "I:20" ,      20*4, [=](void *d) {
+            for(TypePM *pm=allPMs, *e=pm+20; pm<e; ++pm) ((quint32 *)d)[pm-allPMs] = (PM.contains(pm->FEEid) ? pm->act.CH_BASELINES_NOK : -1);
+        }));
+        services.append(new AdvancedDIMservice(qP(pfx+"TRG_SYNC"               ), "I:20" ,      20*4, [=](void *d) {
+            memcpy((quint32 *)d     , TCM.act.TRG_SYNC_A, 10*4);
+            memcpy((quint32 *)d + 10, TCM.act.TRG_SYNC_C, 10*4);
+        }));
+        services.append(new AdvancedDIMservice(qP(pfx+"GBT/STATUS"             ), "I:210", 4*10*21, [=](void *d) { //[21*iReg + iBoard]
+            for (quint8 iReg=0; iReg<10; ++iReg) {
+                for(TypePM *pm=allPMs, *e=pm+20; pm<e; ++pm) ((quint32 *)d)[21*iReg + (pm-allPMs)] = (PM.contains(pm->FEEid) ? pm->act.GBT.Status.registers[iReg] : -1);
+                                                             ((quint32 *)d)[21*iReg + 20]          =                           TCM.act.GBT.Status.registers[iReg];
+            }
+        }));
+
         addArrayCommand("THRESHOLD_CALIBR");
         addArrayCommand("ADC_ZERO"        );
         addArrayCommand("ADC_DELAY"       );
@@ -356,55 +516,43 @@ public:
             qint32 &id = ((qint32 *)d)[0], *V = (qint32 *)d + 1;
             if (id == -1) {
                 for(quint8 iPM=0; iPM<20; ++iPM) for (quint8 iCh=0; iCh<12; ++iCh) { allPMs[iPM].set.ADC_RANGE[iCh][0] = V[20*iCh + iPM]; allPMs[iPM].set.ADC_RANGE[iCh][1] = V[240 + 20*iCh + iPM]; }
-                IPbusControlPacket p; connect(&p, &IPbusControlPacket::error, this, &IPbusTarget::error);
-                foreach(auto side, QList({PMsA, PMsC})) {
-                    foreach(TypePM *pm, side) p.addTransaction(write, pm->baseAddress + PMparameters["ADC0_RANGE"].address, pm->set.ADC_RANGE[0], 24);
-                    if (!p.transactionsList.isEmpty()) transceive(p);
-                }
-                sync();
+                beginBatch();
+                foreach(TypePM *pm, PM) writeBlock(pm->baseAddress + PMparameters("ADC0_RANGE").address, pm->set.ADC_RANGE[0], 24);
+                commitBatch();
             } else if (id < 480) {
                 quint8 iPM = id % 20, iCh = id / 20 % 12, iADC = id / 240;
                 if ((1 << iPM & TCM.act.PM_MASK_SPI) == 0) return;
                 TypePM *pm = allPMs + iPM;
                 pm->set.ADC_RANGE[iCh][iADC] = *V;
-                writeRegister(pm->baseAddress + PMparameters["ADC0_RANGE"].address + 2*iCh + iADC, *V);
+                writeRegister(pm->baseAddress + PMparameters("ADC0_RANGE").address + 2*iCh + iADC, *V);
             }
         });
         addCommand(commands, pfx+"CH_MASK_DATA/apply", "I", [=](void *d) {
             qint32 &id = ((qint32 *)d)[0], *V = (qint32 *)d + 1;
-            if (id == -1) {
-                for(quint8 iPM=0; iPM<20; ++iPM) { allPMs[iPM].set.CH_MASK_DATA = V[iPM]; }
-                IPbusControlPacket p; connect(&p, &IPbusControlPacket::error, this, &IPbusTarget::error);
-                foreach(TypePM *pm, PM) p.addWordToWrite(pm->baseAddress + PMparameters["CH_MASK_DATA"].address, pm->set.CH_MASK_DATA);
-                if (!p.transactionsList.isEmpty() && transceive(p)) sync();
-            } else if (id < 240) {
+            if (id == -1) applyChannelMasks(V, nullptr, nullptr);
+            else if (id < 240) {
                 quint8 iPM = id % 20, iCh = id / 20;
                 if ((1 << iPM & TCM.act.PM_MASK_SPI) == 0) return;
                 TypePM *pm = allPMs + iPM;
                 pm->set.CH_MASK_DATA = changeNbits(pm->set.CH_MASK_DATA, 1, iCh, *V);
-                *V ? setBit(iCh, pm->baseAddress + PMparameters["CH_MASK_DATA"].address) : clearBit(iCh, pm->baseAddress + PMparameters["CH_MASK_DATA"].address);
+                *V ? setBit(iCh, pm->baseAddress + PMparameters("CH_MASK_DATA").address) : clearBit(iCh, pm->baseAddress + PMparameters("CH_MASK_DATA").address);
             }
         });
+        const Parameter noTRG = PMparameters("noTriggerMode");
         addCommand(commands, pfx+"CH_MASK_TRG/apply", "I", [=](void *d) {
             qint32 &id = ((qint32 *)d)[0], *V = (qint32 *)d + 1;
-            if (id == -1) {
-                for(quint8 iPM=0; iPM<20; ++iPM) for (quint8 iCh=0; iCh<12; ++iCh) {
-                    bool enableTrigger = V[iPM] & 1<<iCh;
-                    allPMs[iPM].setParameter("noTriggerMode", !enableTrigger, iCh);
-                    allPMs[iPM].act.timeAlignment[iCh].blockTriggers = !enableTrigger;
-                }
-                IPbusControlPacket p; connect(&p, &IPbusControlPacket::error, this, &IPbusTarget::error);
-                foreach(TypePM *pm, PM) p.addTransaction(write, pm->baseAddress + PMparameters["noTriggerMode"].address, (quint32 *)&pm->act.timeAlignment, 12);
-                if (!p.transactionsList.isEmpty() && transceive(p)) sync();
-            } else if (id < 240) {
+            if (id == -1) applyChannelMasks(nullptr, V, nullptr);
+            else if (id < 240) {
                 quint8 iPM = id % 20, iCh = id / 20;
                 bool enableTrigger = *V;
                 if ((1 << iPM & TCM.act.PM_MASK_SPI) == 0) return;
                 TypePM *pm = allPMs + iPM;
-                pm->setParameter("noTriggerMode", !enableTrigger, iCh);
-                writeParameter("noTriggerMode", !enableTrigger, pm->FEEid, iCh);
+                pm->setParameter(noTRG, !enableTrigger, iCh);
+                writeParameter(noTRG, !enableTrigger, pm->FEEid, iCh);
             }
         });
+        addCommand(commands, pfx+"PM_MASK_TRG/apply", "I", [=](void *d) { applyChannelMasks(nullptr, nullptr, (qint32 *)d); });
+        addCommand(commands, pfx+"CH_MASKS/apply", "I:41", [=](void *d) { applyChannelMasks((qint32 *)d, (qint32 *)d + 20, (qint32 *)d + 40); }); //CH_MASK_DATA[20], CH_MASK_TRG[20], PM_MASK_TRG
 
         addCommand(commands, pfx+"RESET_COUNTS", "I", [=](void *d) {
             qint32 id = *(qint32 *)d;
@@ -415,15 +563,18 @@ public:
     }
 
     void deletePMservices(TypePM *pm) {
-        foreach (DimService *s, pm->services) delete s;
+        foreach (AdvancedDIMservice *s, pm->services) delete s;
         pm->services.clear();
 //        pm->counters.services.clear();
         foreach (DimCommand *c, pm->commands) { allCommands.remove(c); delete c; }
         pm->commands.clear();
     }
 
+    void invalidatePMservices(TypePM *pm) { foreach (AdvancedDIMservice *s, pm->services) s->invalidate(); } //kept registered for clients until the PM is back
+
     void deleteTCMservices() {
-        foreach (DimService *s, TCM.services + TCM.counters.services + TCM.staticServices) delete s;
+        foreach (AdvancedDIMservice *s, TCM.services) delete s;
+        foreach (DimService *s, TCM.counters.services + TCM.staticServices) delete s;
         TCM.services.clear();
         TCM.counters.services.clear();
         TCM.staticServices.clear();
@@ -433,19 +584,164 @@ public:
         TCM.commands.clear();
     }
 
-    void commandHandler() { DimCommand *c = getCommand(); emit DIMcommandReceived(c, c->getData()); }
+    void commandHandler() { //called from DIM thread, command data is only valid during the call
+        DimCommand *c = getCommand();
+        QByteArray data((char *)c->getData(), c->getSize());
+        if (!post([=]() mutable { executeDIMcommand(c, data.data()); })) qWarning("%s: request queue is full, DIM command %s dropped", FIT[subdetector].name, c->getName());
+    }
+
+    bool post(std::function<void()> request) { //thread-safe, request will be executed in the I/O thread
+        if (!requests.push(std::move(request))) return false;
+        if (!requestsScheduled.exchange(true)) QMetaObject::invokeMethod(this, &FITelectronics::executeRequests, Qt::QueuedConnection);
+        return true;
+    }
+
+    void executeRequests() {
+        requestsScheduled = false;
+        std::function<void()> request;
+        while (requests.pop(request)) request();
+    }
+
+    void moveToIOthread() {
+        if (IOthread) return;
+        IOthread = new QThread();
+        IOthread->setObjectName(QString(FIT[subdetector].name) + " I/O");
+        moveToThread(IOthread);
+        IOthread->start();
+    }
+
+    void stopIOthread() { //waits for the queued requests to finish and brings the object back to the main thread
+        if (!IOthread) return;
+        QThread *mainThread = qApp->thread();
+        std::function<void()> stop = [=]() {
+            updateTimer->stop();
+            countersTimer->stop();
+            shuttleTimer->stop();
+            moveToThread(mainThread);
+            QThread::currentThread()->quit();
+        };
+        if (!post(stop)) QMetaObject::invokeMethod(this, stop, Qt::QueuedConnection); //request queue is full: the event queue is not bounded, requests posted before are still executed first
+        IOthread->wait();
+        delete IOthread;
+        IOthread = nullptr;
+    }
 
 signals:
     void linksStatusReady();
-    void valuesReady();
+    void valuesReady(const FITview &view);
     void countersReady(quint16 FEEid);
     void resetFinished();
-    void DIMcommandReceived(DimCommand *, void *);
 
 public slots:
-    void executeDIMcommand(DimCommand *cmd, void *data) { allCommands[cmd](data); }
+    void executeDIMcommand(DimCommand *cmd, void *data) { if (allCommands.contains(cmd)) allCommands[cmd](data); } //command could be deleted while queued
+
+    struct SnapshotHeader { char magic[4]; quint16 version; quint8 subdetector, nBoards; };
+    struct SnapshotBoardHeader { quint8 board, nBlocks; quint16 nWords; quint32 checksum; }; //followed by nBlocks words {addr | endAddr << 8} and nWords register values
+    static const inline char snapshotMagic[4] = {'F', 'I', 'T', 'S'};
+    static const inline QString snapshotSuffix = ".snap"; //fileWrite() chooses the format by suffix, fileRead() by magic
+    static const quint16 snapshotVersion = 1;
+    static quint32 snapshotChecksum(const quint32 *w, quint32 n) { quint32 h = 2166136261U; for (quint32 i=0; i<n; ++i) { h ^= w[i]; h *= 16777619U; } return h; } //FNV-1a over words
+
+    static bool isSnapshot(QString fileName) {
+        QFile file(fileName);
+        char magic[4];
+        return file.open(QIODevice::ReadOnly) && file.read(magic, 4) == 4 && memcmp(magic, snapshotMagic, 4) == 0;
+    }
+
+    void snapshotWrite(QString fileName) { //binary dump of settings, same registers as in INI
+        QByteArray buf;
+        SnapshotHeader h;
+        memcpy(h.magic, snapshotMagic, 4);
+        h.version = snapshotVersion;
+        h.subdetector = subdetector;
+        h.nBoards = 0;
+        buf.append((const char *)&h, sizeof(h));
+        auto appendBoard = [&](quint8 board, const QVector<regblock> &blocks, const quint32 *registers) {
+            QVector<quint32> words;
+            foreach (regblock b, blocks) words << (b.addr | b.endAddr << 8);
+            foreach (regblock b, blocks) for (quint8 i=b.addr; i<=b.endAddr; ++i) words << registers[i];
+            SnapshotBoardHeader bh = {board, quint8(blocks.size()), quint16(words.size() - blocks.size()), snapshotChecksum(words.constData(), words.size())};
+            buf.append((const char *)&bh, sizeof(bh)).append((const char *)words.constData(), words.size() * wordSize);
+            ++((SnapshotHeader *)buf.data())->nBoards;
+        };
+        appendBoard(20, TCM.set.regblocksToRead, TCM.set.registers);
+        foreach (TypePM *pm, PM) if (TRGsyncEnabledForPM(pm - allPMs)) appendBoard(pm - allPMs, pm->set.regblocks, pm->set.registers);
+        QSaveFile file(fileName);
+        if (!file.open(QIODevice::WriteOnly) || file.write(buf) != buf.size() || !file.commit()) emit error("Can't write " + fileName + ": " + file.errorString(), logicError);
+    }
+
+    bool snapshotRead(QString fileName, bool doApply, bool delta = false) { //the file is memory-mapped, every board record is checked before use
+        QFile file(fileName);
+        if (!file.open(QIODevice::ReadOnly)) {
+            emit error("Can't read " + fileName + ": " + file.errorString(), logicError);
+            return false;
+        }
+        const qint64 size = file.size();
+        const uchar *data = file.map(0, size), *end = data + size;
+        if (data == nullptr || size < qint64(sizeof(SnapshotHeader))) {
+            emit error("Can't map " + fileName, logicError);
+            return false;
+        }
+        const SnapshotHeader *h = (const SnapshotHeader *)data;
+        if (memcmp(h->magic, snapshotMagic, 4) != 0 || h->version != snapshotVersion || h->subdetector != subdetector) {
+            emit error(fileName + ": incompatible snapshot", logicError);
+            return false;
+        }
+        auto blocksFit = [](const quint32 *d, quint8 n, const QVector<regblock> &known) { //only registers that are settings may be written
+            for (quint8 k=0; k<n; ++k) {
+                quint8 a = d[k] & 0xFF, e = d[k] >> 8 & 0xFF;
+                bool fits = false;
+                foreach (regblock b, known) if (a >= b.addr && e <= b.endAddr && a <= e) fits = true;
+                if (!fits) return false;
+            }
+            return true;
+        };
+        quint32 loadedPMs = 0;
+        bool loadedTCM = false;
+        const uchar *p = data + sizeof(SnapshotHeader);
+        for (quint8 i=0; i<h->nBoards; ++i) {
+            const SnapshotBoardHeader *bh = (const SnapshotBoardHeader *)p;
+            const quint32 *d = (const quint32 *)(p + sizeof(SnapshotBoardHeader));
+            if (p + sizeof(SnapshotBoardHeader) > end || (const uchar *)(d + bh->nBlocks + bh->nWords) > end) {
+                emit error(fileName + ": snapshot truncated", logicError);
+                break;
+            }
+            p = (const uchar *)(d + bh->nBlocks + bh->nWords);
+            if (bh->board > 20 || snapshotChecksum(d, bh->nBlocks + bh->nWords) != bh->checksum) {
+                emit error(QString::asprintf("%s: board record %d is corrupted", qPrintable(fileName), i), logicError);
+                continue;
+            }
+            const QVector<regblock> &known = bh->board == 20 ? TCM.set.regblocksToRead : allPMs[bh->board].set.regblocks;
+            if (!blocksFit(d, bh->nBlocks, known)) {
+                emit error(QString::asprintf("%s: board record %d has unknown registers", qPrintable(fileName), i), logicError);
+                continue;
+            }
+            quint32 *registers = bh->board == 20 ? TCM.set.registers : allPMs[bh->board].set.registers;
+            const quint32 *v = d + bh->nBlocks;
+            quint16 nCopied = 0;
+            for (quint8 k=0; k<bh->nBlocks; ++k) {
+                quint8 a = d[k] & 0xFF, e = d[k] >> 8 & 0xFF;
+                if (nCopied + e - a + 1 > bh->nWords) break;
+                memcpy(registers + a, v + nCopied, (e - a + 1) * wordSize);
+                nCopied += e - a + 1;
+            }
+            if (bh->board == 20) loadedTCM = true; else loadedPMs |= 1 << bh->board;
+        }
+        if (doApply) {
+            if (delta) readConfiguration();
+            beginBatch(); //all PMs settings are packed together
+            foreach (TypePM *pm, PM) if (loadedPMs & TCM.act.PM_MASK_SPI & 1 << (pm - allPMs)) delta ? applySettingsPMdelta(pm) : applySettingsPM(pm);
+            commitBatch();
+            if (loadedTCM) delta ? applySettingsTCMdelta() : applySettingsTCM(true);
+        }
+        return true;
+    }
 
     void fileWrite(QString fileName) {
+        if (fileName.endsWith(snapshotSuffix)) {
+            snapshotWrite(fileName);
+            return;
+        }
         QSettings newset(fileName, QSettings::IniFormat);
         newset.remove("TCM");
         newset.beginGroup("TCM");
@@ -458,19 +754,29 @@ public slots:
             foreach(regblock b, pm->set.regblocks) for (quint8 i=b.addr; i<=b.endAddr; ++i) newset.setValue(QString::asprintf("reg%02X", i), QString::asprintf("%08X", pm->set.registers[i]));
             newset.endGroup();
         }
+        for (quint8 i=0; i<nPollingClasses; ++i) newset.setValue(QString("polling/") + polling[i].name + "_ms", polling[i].period_ms);
+        newset.setValue("countersHistory/minutes", countersHistory_min);
         newset.sync();
     }
 
-    void fileRead(QString fileName, bool doApply = false) {
+    void fileRead(QString fileName, bool doApply = false, bool delta = false) { //new INI format is always applied by difference
         if (!QFileInfo::exists(fileName)) {
             fileName.prepend("./configuration/");
             if (!QFileInfo::exists(fileName)) fileName = "./configuration/default.cfg";
         }
+        if (isSnapshot(fileName)) {
+            if (snapshotRead(fileName, doApply, delta)) log("Settings loaded" + QString(doApply ? " and applied" : "") + " from snapshot " + fileName);
+            return;
+        }
         QSettings newset(fileName, QSettings::IniFormat);
+        if (doApply) readConfiguration(); //the new format and deltas are applied by difference with actual values
+        for (quint8 i=0; i<nPollingClasses; ++i) polling[i].period_ms = qBound(int(pollingTick_ms), newset.value(QString("polling/") + polling[i].name + "_ms", polling[i].period_ms).toInt(), 60000);
+        countersHistory_min = qBound(1, newset.value("countersHistory/minutes", countersHistory_min).toInt(), 1440);
+        resizeCountersHistory();
         if (newset.contains("TCM")) { //old settings format
             quint32 *r = (quint32 *)newset.value("TCM").toByteArray().remove(64,4).data(); //PM_MASK_SPI is not a setting value starting from v1.e, so 4 bytes are removed
             foreach (regblock b, TCM.set.regblocksToRead) for (quint8 i=b.addr; i<=b.endAddr; ++i) TCM.set.registers[i] = *r++;
-            if (doApply) applySettingsTCM();
+            if (doApply) delta ? applySettingsTCMdelta() : applySettingsTCM();
         } else { //new settings format
             newset.beginGroup("TCM");
             if (!newset.childKeys().isEmpty()) {
@@ -483,24 +789,23 @@ public slots:
                     TCM.set.registers[address] = value;
                 }
                 if (doApply) {
-                    IPbusControlPacket p; connect(&p, &IPbusControlPacket::error, this, &IPbusTarget::error);
-                    foreach(QString side, QString("AC")) { quint8 a = TCMparameters["DELAY_"+side].address; if (M.contains(a) && TCM.act.registers[a] != TCM.set.registers[a]) p.addWordToWrite(a, M[a]);}
+                    IPbusControlPacket p(forwardError);
+                    for (quint8 a : {TCMparameters("DELAY_A").address, TCMparameters("DELAY_C").address}) if (M.contains(a) && TCM.act.registers[a] != TCM.set.registers[a]) p.addWordToWrite(a, M[a]);
                     if (!p.transactionsList.isEmpty()) { //phase is to be changed
                         qint32 delay_ms = qMax(qAbs(TCM.set.DELAY_A - TCM.act.DELAY_A), qAbs(TCM.set.DELAY_C - TCM.act.DELAY_C)) + 10; //phase needs time to move
                         if (!transceive(p)) return;
                         QThread::msleep(delay_ms); //waiting for phases shift to finish
                     }
-                    M.remove(TCMparameters["COUNTERS_UPD_RATE"].address); //will be applied afterwards
+                    M.remove(TCMparameters("COUNTERS_UPD_RATE").address); //will be applied afterwards
                     if (!M.isEmpty()) {
                         if (M.contains(0xE)) {//reg0E contains TCM histogram settings (bits 4..7 and 10), they should not change
-                            quint32 mask = 0x0000030F; //only bits 0..3 and 8..9 will be written
-                            p.addTransaction(RMWbits, 0xE, p.masks(~mask, M[0xE] & mask));
+                            p.addTransaction(RMWbits, 0xE, p.masks(~reg0EsettingsMask, M[0xE] & reg0EsettingsMask));
                             M.remove(0xE);
                         }
                         foreach(quint8 a, M.keys()) p.addWordToWrite(a, M[a]);
                         if (!transceive(p)) return;
                     }
-                    if (M.contains(TCMparameters["CH_MASK_A"].address) || M.contains(TCMparameters["CH_MASK_C"].address)) {
+                    if (M.contains(TCMparameters("CH_MASK_A").address) || M.contains(TCMparameters("CH_MASK_C").address)) {
                         QThread::msleep(10);
                     }
                     apply_RESET_ERRORS();
@@ -515,7 +820,7 @@ public slots:
             if (newset.contains(name)) { //old settings format
                 quint32 *r = (quint32 *)newset.value(name).toByteArray().data();
                 foreach (regblock b, pm->set.regblocks) for (quint8 i=b.addr; i<=b.endAddr; ++i) pm->set.registers[i] = *r++;
-                if (doApply && TCM.act.PM_MASK_SPI & 1 <<i) applySettingsPM(pm);
+                if (doApply && TCM.act.PM_MASK_SPI & 1 <<i) delta ? applySettingsPMdelta(pm) : applySettingsPM(pm);
             } else { //new settings format
                 newset.beginGroup(name);
                 if (!newset.childKeys().isEmpty()) {
@@ -528,7 +833,7 @@ public slots:
                         pm->set.registers[address] = value;
                     }
                     if (doApply && TCM.act.PM_MASK_SPI & 1 <<i) {
-                        IPbusControlPacket p; connect(&p, &IPbusControlPacket::error, this, &IPbusTarget::error);
+                        IPbusControlPacket p(forwardError);
                         foreach(quint8 a, M.keys()) if (pm->act.registers[a] != pm->set.registers[a]) p.addWordToWrite(pm->baseAddress + a, M[a]);
                         if (!transceive(p)) return;
                     }
@@ -543,7 +848,7 @@ public slots:
         quint32 load = readRegister(TypeTCM::Counters::addressFIFOload);
         if (load == 0xFFFFFFFF) return;
         while (load) {
-            IPbusControlPacket p; connect(&p, &IPbusControlPacket::error, this, &IPbusTarget::error);
+            IPbusControlPacket p(forwardError);
             p.addTransaction(nonIncrementingRead, TypeTCM::Counters::addressFIFO, nullptr, load > 255 ? 255 : load);
             p.addTransaction(read, TypeTCM::Counters::addressFIFOload, &load);
             if (!transceive(p)) return;
@@ -552,7 +857,7 @@ public slots:
             load = readRegister(pm->baseAddress + TypePM::Counters::addressFIFOload);
             if (load == 0xFFFFFFFF) continue;
             while (load) {
-                IPbusControlPacket p; connect(&p, &IPbusControlPacket::error, this, &IPbusTarget::error);
+                IPbusControlPacket p(forwardError);
                 p.addTransaction(nonIncrementingRead, pm->baseAddress + TypePM::Counters::addressFIFO, nullptr, load > 255 ? 255 : load);
                 p.addTransaction(read, pm->baseAddress + TypePM::Counters::addressFIFOload, &load);
                 if (!transceive(p)) return;
@@ -562,30 +867,31 @@ public slots:
 
     void apply_COUNTERS_UPD_RATE(quint8 val) {
         countersTimer->stop();
-        writeRegister(TCMparameters["COUNTERS_UPD_RATE"].address, 0, false);
+        writeRegister(TCMparameters("COUNTERS_UPD_RATE").address, 0, false);
         emptyCountBuffers();
         readCountersDirectly();
         if (val <= 7) {
             TCM.set.COUNTERS_UPD_RATE = val;
             if (val > 0) {
-                writeRegister(TCMparameters["COUNTERS_UPD_RATE"].address, val, false);
+                writeRegister(TCMparameters("COUNTERS_UPD_RATE").address, val, false);
 //                writeParameter("COUNTERS_UPD_RATE", val, TCMid);
-//                countersTimer->start(countersUpdatePeriod_ms[val]/2);
-                countersTimer->start(50);
+                countersTimer->start(countersUpdatePeriod_ms[val]); //several entries accumulated due to timers phase difference are drained at once
             }
+            resizeCountersHistory();
         } else emit error("Wrong COUNTERS_UPD_RATE value: " + QString::number(val), logicError);
     }
 
-    void initGBT() {
-        IPbusControlPacket p; connect(&p, &IPbusControlPacket::error, this, &IPbusTarget::error);
-        if (quint16(readRegister(GBTparameters["RDH_FEE_ID"].address)) != TCMid) {
-            for (quint8 j=0; j<GBTunit::controlSize; ++j) if (j != GBTparameters["BCID_DELAY"].address - GBTunit::controlAddress) TCM.set.GBT.registers[j] = GBTunit::defaults[j];
+    void initGBT() { //RDH_FEE_ID values were read by checkPMlinks()
+        const quint16 aFEEid = GBTparameters("RDH_FEE_ID").address;
+        IPbusControlPacket p(forwardError);
+        if (quint16(TCM.act.registers[aFEEid]) != TCMid) {
+            for (quint8 j=0; j<GBTunit::controlSize; ++j) if (j != GBTparameters("BCID_DELAY").address - GBTunit::controlAddress) TCM.set.GBT.registers[j] = GBTunit::defaults[j];
             TCM.set.GBT.RDH_FEE_ID = TCMid;
             TCM.set.GBT.RDH_SYS_ID = FIT[subdetector].systemID;
             p.addTransaction(write, GBTunit::controlAddress, TCM.set.GBT.registers, GBTunit::controlSize);
         }
-        foreach (TypePM *pm, PM) if (quint16(readRegister(pm->baseAddress + GBTparameters["RDH_FEE_ID"].address)) != pm->FEEid) {
-            for (quint8 j=0; j<GBTunit::controlSize; ++j) if (j != GBTparameters["BCID_DELAY"].address - GBTunit::controlAddress) pm->set.GBT.registers[j] = GBTunit::defaults[j];
+        foreach (TypePM *pm, PM) if (quint16(pm->act.registers[aFEEid]) != pm->FEEid) {
+            for (quint8 j=0; j<GBTunit::controlSize; ++j) if (j != GBTparameters("BCID_DELAY").address - GBTunit::controlAddress) pm->set.GBT.registers[j] = GBTunit::defaults[j];
             pm->set.GBT.RDH_FEE_ID = pm->FEEid;
             pm->set.GBT.RDH_SYS_ID = FIT[subdetector].systemID;
             p.addTransaction(write, pm->baseAddress + GBTunit::controlAddress, pm->set.GBT.registers, GBTunit::controlSize);
@@ -593,44 +899,67 @@ public slots:
         if (!p.transactionsList.isEmpty()) transceive(p);
     }
 
-    void checkPMlinks() {
-        IPbusControlPacket p; connect(&p, &IPbusControlPacket::error, this, &IPbusTarget::error);
-        p.addTransaction(read, TCMparameters["PM_MASK_SPI"].address, &TCM.act.PM_MASK_SPI);
-        p.addTransaction(read, TCMparameters["CH_MASK_A"].address, p.dt);
-        p.addTransaction(read, TCMparameters["CH_MASK_C"].address, p.dt + 1);
+    void checkPMlinks() { //all SPI links are enabled, the 20 PMs are probed in parallel, then the resulting PM_MASK_SPI is written at once
+        const quint16 aMaskSPI = TCMparameters("PM_MASK_SPI").address, aFEEid = GBTparameters("RDH_FEE_ID").address;
+        IPbusControlPacket p(forwardError);
+        p.addTransaction(read, aMaskSPI, &TCM.act.PM_MASK_SPI);
+        p.addTransaction(read, TCMparameters("CH_MASK_A").address, p.dt);
+        p.addTransaction(read, TCMparameters("CH_MASK_C").address, p.dt + 1);
+        p.addTransaction(read, aFEEid, TCM.act.registers + aFEEid); //for initGBT()
+        p.addTransaction(RMWbits, aMaskSPI, p.masks(0xFFFFFFFF, 0xFFFFF));
         if (transceive(p)) {
             TCM.act.CH_MASK_A = p.dt[0];
             TCM.act.CH_MASK_C = p.dt[1];
         } else return;
 
+        QVarLengthArray<IPbusControlPacket *, 20> packets; //one PM per packet: a bus error from an absent PM doesn't stop the other probes
+        quint32 present = 0;
+        for (quint8 i=0; i<20; ++i) {
+            IPbusControlPacket *probe = acquirePacket();
+            probe->addTransaction(read, allPMs[i].baseAddress + 0xFE, nullptr);
+            probe->addTransaction(read, allPMs[i].baseAddress + aFEEid, allPMs[i].act.registers + aFEEid); //for initGBT()
+            probe->onResponse = [&, probe, i](bool) { //response is checked here: errors from absent PMs are expected and not reported
+                TransactionHeader *th = probe->transactionsList.first().responseHeader;
+                if (probe->responseSize > 2 && th->InfoCode == 0 && probe->response[2] != 0xFFFFFFFF && probe->processResponse()) present |= 1 << i;
+            };
+            packets.append(probe);
+        }
+        bool ok = transceive(packets.data(), packets.size(), false);
+        foreach (IPbusControlPacket *probe, packets) releasePacket(probe);
+        if (!ok) return;
+
         PM.clear();
+        state.PMstatusOK = 0;
         PMsA.clear();
         PMsC.clear();
+        staleConfig = allBoardsMask;
         for (quint8 i=0; i<20; ++i) {
-            if (!(TCM.act.PM_MASK_SPI >> i & 1)) setBit(i, TCMparameters["PM_MASK_SPI"].address, false);
-            if (readRegister(allPMs[i].baseAddress + 0xFE) == 0xFFFFFFFF) { //SPI or IPbus error
-                clearBit(i, TCMparameters["PM_MASK_SPI"].address, false);
-                deletePMservices(allPMs + i);
-            } else {
-                TCM.act.PM_MASK_SPI |= 1 << i;
+            if (present >> i & 1) {
                 PM.insert(allPMs[i].FEEid, allPMs + i);
                 (i < 10 ? PMsA : PMsC).append(allPMs + i);
-                if (allPMs[i].services.isEmpty()) createPMservices(allPMs + i);
+                if (allPMs[i].services.isEmpty()) createPMservices(allPMs + i); //once per PM, published with good quality again by the next sync
 //                if (i > 9) TCM.set.CH_MASK_C |= 1 << (i - 10);
 //                else       TCM.set.CH_MASK_A |= 1 << i;
-            }
+            } else invalidatePMservices(allPMs + i);
         }
-        if (!TCM.act.CH_MASK_A && TCM.set.CH_MASK_A) p.addWordToWrite(TCMparameters["CH_MASK_A"].address, TCM.set.CH_MASK_A);
-        if (!TCM.act.CH_MASK_C && TCM.set.CH_MASK_C) p.addWordToWrite(TCMparameters["CH_MASK_C"].address, TCM.set.CH_MASK_C);
-        if (p.transactionsList.isEmpty() || transceive(p)) emit linksStatusReady();
+        TCM.act.PM_MASK_SPI = (TCM.act.PM_MASK_SPI & ~0xFFFFF) | present;
+        p.addWordToWrite(aMaskSPI, TCM.act.PM_MASK_SPI);
+        if (!TCM.act.CH_MASK_A && TCM.set.CH_MASK_A) p.addWordToWrite(TCMparameters("CH_MASK_A").address, TCM.set.CH_MASK_A);
+        if (!TCM.act.CH_MASK_C && TCM.set.CH_MASK_C) p.addWordToWrite(TCMparameters("CH_MASK_C").address, TCM.set.CH_MASK_C);
+        if (transceive(p)) emit linksStatusReady();
     }
 
-    void writeParameter(QString name, quint64 val, quint16 FEEid, quint8 iCh = 0) {
-        if ( !GBTparameters.contains(name) && (FEEid == TCMid ? !TCMparameters.contains(name) : !PMparameters.contains(name)) ) {
+    void writeParameter(QString name, quint64 val, quint16 FEEid, quint8 iCh = 0) { //for names coming from DIM or text
+        const Parameter *p = GBTparameters.find(name);
+        if (p == nullptr) p = FEEid == TCMid ? TCMparameters.find(name) : PMparameters.find(name);
+        if (p == nullptr) {
             emit error("'" + name + "' - no such parameter", logicError);
             return;
         }
-        Parameter p(GBTparameters.contains(name) ? GBTparameters[name] : (FEEid == TCMid ? TCMparameters[name] : PMparameters[name]));
+        writeParameter(*p, val, FEEid, iCh);
+    }
+
+    void writeParameter(const Parameter p, quint64 val, quint16 FEEid, quint8 iCh = 0) {
         quint16 address = p.address + (FEEid == TCMid ? 0 : PM[FEEid]->baseAddress + iCh * p.interval);
         if (p.bitwidth == 32)
             writeRegister(address, val);
@@ -638,77 +967,107 @@ public slots:
             val != 0 ? setBit(p.bitshift, address) : clearBit(p.bitshift, address);
         else if (p.bitwidth == 64) {
             quint32 w[2] = {quint32(val), quint32(val >> 32)};
-            IPbusControlPacket packet; connect(&packet, &IPbusControlPacket::error, this, &IPbusTarget::error);
+            IPbusControlPacket packet(forwardError);
             packet.addTransaction(write, address, w, 2);
             if (transceive(packet)) sync();
         } else
             writeNbits(address, val, p.bitwidth, p.bitshift);
     }
 
-    void readCountersFIFO() {
-        quint16 time_ms = countersUpdatePeriod_ms[TCM.act.COUNTERS_UPD_RATE];
-        IPbusControlPacket p; connect(&p, &IPbusControlPacket::error, this, &IPbusTarget::error);
+    void addCountersFIFOloadReads(IPbusControlPacket &p) {
         p.addTransaction(read, TypeTCM::Counters::addressFIFOload, &TCM.counters.FIFOload);
         foreach (TypePM *pm, PM) p.addTransaction(read, pm->baseAddress + TypePM::Counters::addressFIFOload, &pm->counters.FIFOload);
-        if (!transceive(p)) return;
-        if (TCM.counters.FIFOload) p.addTransaction(nonIncrementingRead, TypeTCM::Counters::addressFIFO, TCM.counters.New, TypeTCM::Counters::number);
-        foreach (TypePM *pm, PM) if (pm->counters.FIFOload) {
-            if (maxPacket - p.responseSize <= TypePM::Counters::number) if (!transceive(p)) return;
-            p.addTransaction(nonIncrementingRead, pm->baseAddress + TypePM::Counters::addressFIFO, pm->counters.New, TypePM::Counters::number);
-        }
-        if (p.requestSize > 1) if (!transceive(p)) return;
-        if (TCM.counters.FIFOload) {
-            TCM.counters.oldTime = QDateTime::currentDateTime();
-            for (quint8 i=0; i<TypeTCM::Counters::number; ++i) {
-                TCM.counters.rate[i] = (TCM.counters.New[i] - TCM.counters.Old[i]) * 1000. / time_ms;
-                TCM.counters.Old[i] = TCM.counters.New[i];
+    }
+
+    void readCountersFIFO() {
+        IPbusControlPacket p(forwardError);
+        addCountersFIFOloadReads(p);
+        if (transceive(p)) drainCountersFIFO();
+    }
+
+    void drainCountersFIFO() { //FIFOload values must be actual. All complete entries are read at once and then published one by one
+        quint16 time_ms = countersUpdatePeriod_ms[TCM.act.COUNTERS_UPD_RATE];
+        if (time_ms == 0) return;
+        quint8 nEntries[21] = {0}, nMax = 0; //[0-19] for PMs by link №, [20] for TCM
+        QVarLengthArray<IPbusControlPacket *, 8> packets; //from the pool
+        auto addFIFOread = [&](quint32 address, quint32 *data, quint16 nWords, quint8 entrySize) { //split into whole-entry transactions and into packets
+            while (nWords > 0) {
+                quint16 n = qMin(nWords, quint16(255 / entrySize * entrySize));
+                if (packets.isEmpty() || packets.last()->requestSize + 2 > maxPacket || packets.last()->responseSize + 1 + n > maxPacket) {
+                    packets.append(acquirePacket());
+                }
+                packets.last()->addTransaction(nonIncrementingRead, address, data, quint8(n));
+                data += n;
+                nWords -= n;
             }
-            foreach (DimService *s, TCM.counters.services) s->updateService();
-            countsTriggers->updateService();
-            countRatesTriggers->updateService(false);
-            emit countersReady(TCMid);
+        };
+        nEntries[20] = qMin(TCM.counters.FIFOload / TypeTCM::Counters::number, quint32(maxCountersEntriesPerTick));
+        if (nEntries[20]) addFIFOread(TypeTCM::Counters::addressFIFO, countersFIFOdata[20], nEntries[20] * TypeTCM::Counters::number, TypeTCM::Counters::number);
+        foreach (TypePM *pm, PM) {
+            quint8 &n = nEntries[pm - allPMs] = qMin(pm->counters.FIFOload / TypePM::Counters::number, quint32(maxCountersEntriesPerTick));
+            if (n) addFIFOread(pm->baseAddress + TypePM::Counters::addressFIFO, countersFIFOdata[pm - allPMs], n * TypePM::Counters::number, TypePM::Counters::number);
         }
-        quint32 sumLoad = 0;
-        foreach (TypePM *pm, PM) if (pm->counters.FIFOload) {
-            sumLoad += pm->counters.FIFOload;
-            pm->counters.oldTime = TCM.counters.oldTime;
-            for (quint8 i=0; i<TypePM::Counters::number; ++i) {
-                pm->counters.rate[i] = (pm->counters.New[i] - pm->counters.Old[i]) * 1000. / time_ms;
-                pm->counters.Old[i] = pm->counters.New[i];
+        for (quint8 i=0; i<21; ++i) if (nEntries[i] > nMax) nMax = nEntries[i];
+        bool ok = nMax == 0 || transceive(packets.data(), packets.size());
+        foreach (IPbusControlPacket *p, packets) releasePacket(p);
+        if (!ok || nMax == 0) return;
+        qint64 now_ns = monotonicTime_ns(), now_ms = QDateTime::currentMSecsSinceEpoch(); //FIFO entries are taken by the hardware timer, so the nominal period is exact
+        for (quint8 k=0; k<nMax; ++k) { //oldest entry first
+            if (k < nEntries[20]) {
+                memcpy(TCM.counters.New, countersFIFOdata[20] + k * TypeTCM::Counters::number, sizeof(TCM.counters.New));
+                TCM.counters.oldTime_ns = now_ns;
+                calculateRates(TCM.counters.New, TCM.counters.Old, TCM.counters.rate, TypeTCM::Counters::number, time_ms * 1e-3, ratesSmoothing);
+                historyTCM->append(now_ms - (nEntries[20] - 1 - k) * time_ms, TCM.counters.New, TCM.counters.rate);
+                foreach (DimService *s, TCM.counters.services) s->updateService();
+                countsTriggers->updateService();
+                countRatesTriggers->updateService(false);
+                emit countersReady(TCMid);
+            }
+            bool PMsUpdated = false;
+            foreach (TypePM *pm, PM) if (k < nEntries[pm - allPMs]) {
+                memcpy(pm->counters.New, countersFIFOdata[pm - allPMs] + k * TypePM::Counters::number, sizeof(pm->counters.New));
+                pm->counters.oldTime_ns = now_ns;
+                calculateRates(pm->counters.New, pm->counters.Old, pm->counters.rate, TypePM::Counters::number, time_ms * 1e-3, ratesSmoothing);
+                historyPM[pm - allPMs].append(now_ms - (nEntries[pm - allPMs] - 1 - k) * time_ms, pm->counters.New, pm->counters.rate);
+                state.storeCounters(pm - allPMs, pm->counters);
+                emit countersReady(pm->FEEid);
+                PMsUpdated = true;
+            }
+            if (PMsUpdated) {
+                countsChannels->updateService();
+                countRatesChannels->updateService(false);
             }
-            emit countersReady(pm->FEEid);
-        }
-        if (sumLoad) {
-            countsChannels->updateService();
-            countRatesChannels->updateService(false);
         }
     }
 
     void readCountersDirectly(bool calculateRate = true) {
-        IPbusControlPacket p; connect(&p, &IPbusControlPacket::error, this, &IPbusTarget::error);
+        IPbusControlPacket p(forwardError);
         p.addTransaction(read, TypeTCM::Counters::addressDirect, TCM.counters.New, TypeTCM::Counters::number);
         if (transceive(p)) {
-            TCM.counters.newTime = QDateTime::currentDateTime();
-            quint32 time_ms = TCM.counters.oldTime.msecsTo(TCM.counters.newTime);
-            if (time_ms < 10) return;
-            for (quint8 i=0; i<TypeTCM::Counters::number; ++i) {
-                if (calculateRate) TCM.counters.rate[i] = (TCM.counters.New[i] - TCM.counters.Old[i]) * 1000. / time_ms;
-                TCM.counters.Old[i] = TCM.counters.New[i];
+            qint64 newTime_ns = monotonicTime_ns();
+            double time_s = (newTime_ns - TCM.counters.oldTime_ns) * 1e-9;
+            if (time_s < 0.01) return;
+            if (calculateRate) {
+                calculateRates(TCM.counters.New, TCM.counters.Old, TCM.counters.rate, TypeTCM::Counters::number, time_s, ratesSmoothing);
+                historyTCM->append(QDateTime::currentMSecsSinceEpoch(), TCM.counters.New, TCM.counters.rate);
             }
-            TCM.counters.oldTime = TCM.counters.newTime;
+            else memcpy(TCM.counters.Old, TCM.counters.New, sizeof(TCM.counters.Old));
+            TCM.counters.oldTime_ns = newTime_ns;
             if (calculateRate) foreach (DimService *s, TCM.counters.services) s->updateService();
             emit countersReady(TCMid);
         } else return;
         foreach (TypePM *pm, PM) {
             p.addTransaction(read, pm->baseAddress + TypePM::Counters::addressDirect, pm->counters.New, TypePM::Counters::number);
             if (!transceive(p) || !PM.contains(pm->FEEid)) continue;
-            pm->counters.newTime = QDateTime::currentDateTime();
-            quint32 time_ms = pm->counters.oldTime.msecsTo(pm->counters.newTime);
-            for (quint8 i=0; i<TypePM::Counters::number; ++i) {
-                if (calculateRate && time_ms < 10) pm->counters.rate[i] = (pm->counters.New[i] - pm->counters.Old[i]) * 1000. / time_ms;
-                pm->counters.Old[i] = pm->counters.New[i];
+            qint64 newTime_ns = monotonicTime_ns();
+            double time_s = (newTime_ns - pm->counters.oldTime_ns) * 1e-9;
+            if (calculateRate && time_s >= 0.01) {
+                calculateRates(pm->counters.New, pm->counters.Old, pm->counters.rate, TypePM::Counters::number, time_s, ratesSmoothing);
+                historyPM[pm - allPMs].append(QDateTime::currentMSecsSinceEpoch(), pm->counters.New, pm->counters.rate);
             }
-            pm->counters.oldTime = pm->counters.newTime;
+            else memcpy(pm->counters.Old, pm->counters.New, sizeof(pm->counters.Old));
+            pm->counters.oldTime_ns = newTime_ns;
+            state.storeCounters(pm - allPMs, pm->counters);
             emit countersReady(pm->FEEid);
         }
         countsChannels->updateService();
@@ -719,8 +1078,37 @@ public slots:
         }
     }
 
+    void resizeCountersHistory() { //to keep countersHistory_min of samples, up to 65536
+        quint32 period_ms = TCM.set.COUNTERS_UPD_RATE ? countersUpdatePeriod_ms[TCM.set.COUNTERS_UPD_RATE] : polling[pollValues].period_ms; //direct reads come with values polling
+        quint32 nSamples = countersHistory_min * 60000U / period_ms;
+        for (quint8 i=0; i<20; ++i) historyPM[i].setCapacity(nSamples);
+        historyTCM->setCapacity(nSamples);
+    }
+
+    void dumpCountersHistory(QString name) { //"FITH", version, then for each board: index, nSamples, nCounters, rate size, times, counts, rates
+        name = QFileInfo(name).fileName(); //a client can't choose the directory
+        if (name.isEmpty() || name.startsWith('.')) {
+            emit error("Invalid counters history file name", logicError);
+            return;
+        }
+        QDir().mkpath(countersHistoryDir);
+        QString fileName = countersHistoryDir + name;
+        QFile file(fileName);
+        if (!file.open(QIODevice::WriteOnly)) {
+            emit error("Can't write " + fileName + ": " + file.errorString(), logicError);
+            return;
+        }
+        QDataStream out(&file);
+        out.setByteOrder(QDataStream::LittleEndian);
+        out.writeRawData("FITH", 4);
+        out << quint16(1) << quint8(21);
+        for (quint8 i=0; i<20; ++i) { out << i; historyPM[i].dump(out); }
+        out << quint8(20); historyTCM->dump(out);
+        log("Counters history saved to " + fileName);
+    }
+
     void resetCounts(qint32 FEEid) {
-        IPbusControlPacket p; connect(&p, &IPbusControlPacket::error, this, &IPbusTarget::error);
+        IPbusControlPacket p(forwardError);
         if (TCM.act.COUNTERS_UPD_RATE) { //HW timer
             readCountersFIFO();
             if (FEEid == -1 || FEEid == TCMid) {
@@ -763,50 +1151,175 @@ public slots:
 
     void setRatesUnknown() {
         for (quint8 iPM=0; iPM<20; ++iPM) for(quint8 i=0; i<TypePM::Counters::number; ++i) allPMs[iPM].counters.rate[i] = -1.;
+        state.setRatesUnknown();
         for(quint8 i=0; i<TypeTCM::Counters::number; ++i) TCM.counters.rate[i] = -1.;
         foreach (DimService *s, TCM.counters.services) s->updateService();
         if (countRatesChannels) countRatesChannels->updateService();
         if (countRatesTriggers) countRatesTriggers->updateService();
     }
 
-    bool read1PM(TypePM *pm) {
-        pm->act.voltage1_8 = readRegister(pm->baseAddress + 0xFE);
-        if (pm->act.voltage1_8 == 0xFFFFFFFF) { //SPI error
-            clearBit(pm - allPMs, 0x1E, false);
-            deletePMservices(pm);
-            TCM.set.PM_MASK_SPI &= ~(1 << (pm - allPMs));
-            PM.remove(pm->FEEid);
-            (pm - allPMs < 10 ? PMsA : PMsC).removeOne(pm);
-            log(pm->fullName() + " is not available by SPI");
-            emit linksStatusReady();
-        } else {
-            IPbusControlPacket p; connect(&p, &IPbusControlPacket::error, this, &IPbusTarget::error);
-            foreach(regblock b, pm->act.regblocks) p.addTransaction(read, pm->baseAddress + b.addr, pm->act.registers + b.addr, b.size()); // reading PM registers with actual values
-            if (!transceive(p)) return false;
-            pm->act.calculateValues();
-            pm->counters.GBT.calculateRate(pm->act.GBT.Status.wordsCount, pm->act.GBT.Status.eventsCount);
-            foreach (DimService *s, pm->services) s->updateService();
-            if (pm->act.FW_TIME_FPGA.printCode1() >= "28T.CI" && !pm->act.GBT.Status.FIFOempty_errorReport) {
-                GBTerrorReport errorReport;
-                p.addTransaction(nonIncrementingRead, pm->baseAddress + GBTerrorReport::address, errorReport.data, GBTerrorReport::reportSize);
-                if (!transceive(p)) return false;
-                log(pm->fullName() + " " + errorReport.print());
+    void removePM(TypePM *pm) { //PM is not available by SPI
+        clearBit(pm - allPMs, 0x1E, false);
+        invalidatePMservices(pm);
+        TCM.set.PM_MASK_SPI &= ~(1 << (pm - allPMs));
+        PM.remove(pm->FEEid);
+        (pm - allPMs < 10 ? PMsA : PMsC).removeOne(pm);
+        state.removePM(pm - allPMs);
+        log(pm->fullName() + " is not available by SPI");
+        emit linksStatusReady();
+    }
+
+    IPbusControlPacket *readoutPacket(quint8 iPM, bool isProbe) { //next own packet of the PM in the readPMs() cycle, at most 2 per PM
+        IPbusControlPacket *p = cycle.packets[cycle.nPackets] = acquirePacket();
+        cycle.packetPM[cycle.nPackets] = iPM;
+        cycle.sharedPMs[cycle.nPackets] = 0;
+        cycle.isProbe[cycle.nPackets] = isProbe;
+        p->onError = [this, iPM](QString message, errorType) { if (cycle.boardError[iPM].isEmpty()) cycle.boardError[iPM] = message; };
+        p->onResponse = [this, i = cycle.nPackets](bool ok) { PMpacketReceived(i, ok); };
+        ++cycle.nPackets;
+        return p;
+    }
+
+    IPbusControlPacket *sharedReadoutPacket() { //for several PMs read in the same way
+        IPbusControlPacket *p = cycle.packets[cycle.nPackets] = acquirePacket();
+        cycle.sharedPMs[cycle.nPackets] = 0;
+        p->onError = nullptr; //the boards are read again one by one, their errors are reported then
+        p->onResponse = [this, i = cycle.nPackets](bool ok) { sharedPacketReceived(i, ok); };
+        ++cycle.nPackets;
+        return p;
+    }
+
+    void readPMalone(TypePM *pm, const QVector<regblock> &blocks) { //own packets, starting with the SPI probe, so that a lost board can't affect the others
+        quint8 iPM = pm - allPMs, first = cycle.nPackets;
+        cycle.boardError[iPM].clear();
+        pm->act.voltage1_8 = 0xFFFFFFFF;
+        IPbusControlPacket *p = readoutPacket(iPM, true);
+        p->addTransaction(read, pm->baseAddress + 0xFE, &pm->act.voltage1_8);
+        foreach(regblock b, blocks) { // reading PM registers with actual values
+            if (p->requestSize + 2 > maxPacket || p->responseSize + 1 + b.size() > maxPacket) p = readoutPacket(iPM, false);
+            p->addTransaction(read, pm->baseAddress + b.addr, pm->act.registers + b.addr, b.size());
+        }
+        cycle.nPending[iPM] = cycle.nPackets - first;
+    }
+
+    void sharedPacketReceived(quint8 i, bool ok) { //a bus error makes the target skip the rest of the packet, so then all its boards are read again alone
+        if (!ok) {
+            cycle.retried |= cycle.sharedPMs[i];
+            return;
+        }
+        for (quint8 iPM=0; iPM<20; ++iPM) if (cycle.sharedPMs[i] & 1 << iPM) {
+            --cycle.nPending[iPM];
+            if (allPMs[iPM].act.voltage1_8 == 0xFFFFFFFF) cycle.absent |= 1 << iPM; //SPI error
+            else PMreadoutComplete(iPM);
+        }
+    }
+
+    void PMpacketReceived(quint8 i, bool ok) { //boards are processed as soon as completed, while others are in flight
+        IPbusControlPacket *p = cycle.packets[i];
+        quint8 iPM = cycle.packetPM[i];
+        quint32 boardBit = 1 << iPM;
+        if (cycle.isProbe[i] && p->responseSize > 1 && p->transactionsList.first().responseHeader->InfoCode != 0) cycle.absent |= boardBit; //no SPI connection: bus error on the probe
+        if (!ok) cycle.failed |= boardBit;
+        if (--cycle.nPending[iPM] || cycle.failed & boardBit) return;
+        if (allPMs[iPM].act.voltage1_8 == 0xFFFFFFFF) { //SPI error
+            cycle.absent |= boardBit;
+            return;
+        }
+        PMreadoutComplete(iPM);
+    }
+
+    void PMreadoutComplete(quint8 iPM) {
+        TypePM *pm = allPMs + iPM;
+        staleConfig &= ~(1 << iPM);
+        pm->act.calculateValues();
+        pm->counters.GBT.calculateRate(pm->act.GBT.Status.wordsCount, pm->act.GBT.Status.eventsCount);
+        state.storeActual(iPM, *pm);
+        if (pm->act.FW_TIME_FPGA.code() >= errorReportFWcode && !pm->act.GBT.Status.FIFOempty_errorReport) cycle.withErrorReport |= 1 << iPM;
+        serverStats.syncBoard_ms[iPM] = (stats.now_ns() - cycle.tStart_ns) / 1e6;
+    }
+
+    void releaseReadoutPackets() {
+        for (quint8 i=0; i<cycle.nPackets; ++i) releasePacket(cycle.packets[i]);
+        cycle.nPackets = 0;
+    }
+
+    bool readPMs(quint8 due) { //all PMs are read together; boards being re-read fully have own packets, the others share packets, each board starting with the SPI probe; a failed board is skipped in this cycle without affecting the others. False if the target is lost
+        if (due == 0 && !(staleConfig & ~(1 << 20))) return true;
+        const QVector<regblock> &blocks = duePM.byMask[due];
+        quint16 requestWords = 2 + 2 * blocks.size(), responseWords = 2 + duePM.responseWords[due]; //of a board in a shared packet, SPI probe included
+        IPbusControlPacket *shared = nullptr;
+        quint32 polled = 0;
+        cycle.failed = cycle.absent = cycle.withErrorReport = cycle.retried = 0;
+        cycle.tStart_ns = stats.now_ns();
+        foreach (TypePM *pm, PM) {
+            quint8 iPM = pm - allPMs;
+            polled |= 1 << iPM;
+            if (staleConfig & 1 << iPM) {
+                readPMalone(pm, pm->act.regblocks);
+                continue;
             }
+            if (shared == nullptr || shared->requestSize + requestWords > maxPacket || shared->responseSize + responseWords > maxPacket) shared = sharedReadoutPacket();
+            cycle.sharedPMs[cycle.nPackets - 1] |= 1 << iPM;
+            cycle.boardError[iPM].clear();
+            cycle.nPending[iPM] = 1;
+            pm->act.voltage1_8 = 0xFFFFFFFF;
+            shared->addTransaction(read, pm->baseAddress + 0xFE, &pm->act.voltage1_8);
+            foreach(regblock b, blocks) shared->addTransaction(read, pm->baseAddress + b.addr, pm->act.registers + b.addr, b.size());
+        }
+        transceive(cycle.packets, cycle.nPackets);
+        releaseReadoutPackets();
+        if (!isOnline) return false;
+        if (cycle.retried) {
+            for (quint8 iPM=0; iPM<20; ++iPM) if (cycle.retried & 1 << iPM) readPMalone(allPMs + iPM, blocks);
+            transceive(cycle.packets, cycle.nPackets);
+            releaseReadoutPackets();
+            if (!isOnline) return false;
+        }
+        for (quint8 iPM=0; iPM<20; ++iPM) if (polled & 1 << iPM) {
+            if (cycle.nPending[iPM]) cycle.failed |= 1 << iPM; //transfer was interrupted
+            if (!(cycle.withErrorReport & 1 << iPM)) continue;
+            IPbusControlPacket *p = cycle.packets[cycle.nPackets++] = acquirePacket(); //one report per packet, so that a failed one doesn't lose the others
+            p->addTransaction(nonIncrementingRead, allPMs[iPM].baseAddress + GBTerrorReport::address, cycle.errorReports[iPM].data, GBTerrorReport::reportSize);
+            p->onError = [this, iPM](QString message, errorType) { if (cycle.boardError[iPM].isEmpty()) cycle.boardError[iPM] = message; };
+            p->onResponse = [this, iPM](bool ok) { if (ok) archiveErrorReport(iPM, allPMs[iPM].FEEid, cycle.errorReports[iPM], allPMs[iPM].fullName()); else cycle.failed |= 1 << iPM; };
         }
+        if (cycle.nPackets) transceive(cycle.packets, cycle.nPackets);
+        releaseReadoutPackets();
+        if (!isOnline) return false;
+        for (quint8 iPM=0; iPM<20; ++iPM) if (polled & 1 << iPM) {
+            if (cycle.absent & 1 << iPM) removePM(allPMs + iPM);
+            else if (cycle.failed & 1 << iPM && !(PMsFailed & 1 << iPM)) log(allPMs[iPM].fullName() + " readout failed" + (cycle.boardError[iPM].isEmpty() ? "" : ": " + cycle.boardError[iPM]));
+        }
+        PMsFailed = cycle.failed & ~cycle.absent;
         return true;
-    }     
+    }
 
     void sync() { //read actual values
         if (!isOnline) return;
-        IPbusControlPacket p; connect(&p, &IPbusControlPacket::error, this, &IPbusTarget::error);
-        foreach(regblock b, TCM.act.regblocks) p.addTransaction(read, b.addr, TCM.act.registers + b.addr, b.size()); //reading TCM registers with actual values
-        if (!transceive(p)) return;
+        qint64 tStart_ns = stats.now_ns(), now_ms = tStart_ns / 1000000;
+        if (now_ms - lastConfigRead_ms >= configReadPeriod_ms) { //configuration could be changed by someone else
+            lastConfigRead_ms = now_ms;
+            staleConfig = allBoardsMask;
+        }
+        quint8 due = 0; //polling classes read in this cycle
+        for (quint8 i=0; i<nPollingClasses; ++i) if (now_ms + pollingTick_ms / 2 >= polling[i].due_ms) { //timer jitter is tolerated
+            due |= 1 << i;
+            polling[i].due_ms = now_ms + polling[i].period_ms;
+        }
+        if (due == 0 && staleConfig == 0) return;
+        std::fill_n(serverStats.syncBoard_ms, 21, 0.);
+        IPbusControlPacket p(forwardError);
+        foreach(regblock b, staleConfig & 1 << 20 ? TCM.act.regblocks : dueTCM.byMask[due]) p.addTransaction(read, b.addr, TCM.act.registers + b.addr, b.size()); //reading TCM registers with actual values
+        if (p.requestSize > 1 && !transceive(p)) return;
+        staleConfig &= ~(1 << 20);
         TCM.act.calculateValues();
         TCM.counters.GBT.calculateRate(TCM.act.GBT.Status.wordsCount, TCM.act.GBT.Status.eventsCount);
-        foreach (DimService *s, TCM.services) s->updateService();
         if (TCM.act.resetSystem) {
             PMsReady = false;
+            TCM.ORBIT_FILL_MASKisKnown = false;
+            staleConfig = allBoardsMask;
             PM.clear();
+            state.PMstatusOK = 0;
             PMsA.clear();
             PMsC.clear();
         } else if (PMsReady == false) {
@@ -814,56 +1327,182 @@ public slots:
             emit resetFinished();
             return;
         }
-        if (TCM.act.FW_TIME_FPGA.printCode1() >= "28T.CI" && !TCM.act.GBT.Status.FIFOempty_errorReport) {
+        if (TCM.act.FW_TIME_FPGA.code() >= errorReportFWcode && !TCM.act.GBT.Status.FIFOempty_errorReport) {
             GBTerrorReport errorReport;
             p.addTransaction(nonIncrementingRead, GBTerrorReport::address, errorReport.data, GBTerrorReport::reportSize);
             if (!transceive(p)) return;
-            log("TCM " + errorReport.print());
+            archiveErrorReport(20, TCMid, errorReport, "TCM");
         }
-        if (PMsReady) { foreach (TypePM *pm, PM) if (!read1PM(pm)) return; }
+        serverStats.syncBoard_ms[20] = (stats.now_ns() - tStart_ns) / 1e6;
+        if (PMsReady && !readPMs(due)) return;
         calculateSystemValues();
+        foreach (AdvancedDIMservice *s, TCM.services) s->updateService(); //all changes of the cycle are published together
+        foreach (TypePM *pm, PM) if (!(PMsFailed & 1 << (pm - allPMs))) foreach (AdvancedDIMservice *s, pm->services) s->updateService(); //failed boards keep their last good values
         foreach (AdvancedDIMservice *s, services) s->updateService();
-        emit valuesReady();
-        if (PMsReady && TCM.act.COUNTERS_UPD_RATE == 0) readCountersDirectly();
+        if (errorStatsChanged) {
+            errorStatsChanged = false;
+            errorArchive.flush();
+            errorStatsService->updateService();
+        }
+        serverStats.sync_ms = (stats.now_ns() - tStart_ns) / 1e6;
+        if (due & 1 << pollValues) publishServerStats(); //statistics windows stay about a second long
+        publishView();
+        if (PMsReady && TCM.act.COUNTERS_UPD_RATE == 0 && due & 1 << pollValues) readCountersDirectly();
+    }
+
+    void publishView() {
+        if (!isSignalConnected(QMetaMethod::fromSignal(&FITelectronics::valuesReady))) return; //no GUI
+        FITview v;
+        v.BOARDS_OK = BOARDS_OK;
+        v.TCM.act = TCM.act;
+        v.TCM.set = TCM.set;
+        v.TCM.counters = TCM.counters;
+        v.TCM.isOK = TCM.isOK();
+        v.TCM.GBTisOK = TCM.GBTisOK();
+        for (quint8 i=0; i<20; ++i) {
+            TypePM &pm = allPMs[i];
+            FITview::PMview &p = v.PM[i];
+            if (PM.contains(pm.FEEid)) v.PMpresent |= 1 << i;
+            p.act = pm.act;
+            p.set = pm.set;
+            p.counters = pm.counters;
+            p.TRGsync = pm.TRGsync;
+            p.isOK = pm.isOK();
+            p.GBTisOK = pm.GBTisOK();
+        }
+        emit valuesReady(v);
+    }
+
+    void readConfiguration() { //all boards now: the periodic configuration read may be up to configReadPeriod_ms old, too old to compute a delta against
+        staleConfig = allBoardsMask;
+        sync();
+    }
+
+    void syncAll() { //every polling class is read now
+        for (quint8 i=0; i<nPollingClasses; ++i) polling[i].due_ms = 0;
+        sync();
+    }
+
+    void registerWritten(quint32 address) override { //configuration of the board has to be re-read
+        if (address < 0x200) staleConfig |= 1 << 20;
+        else if ((address >> 9) - 1 < 20) staleConfig |= 1 << ((address >> 9) - 1);
+    }
+
+    void archiveErrorReport(quint8 iBoard, quint16 FEEid, const GBTerrorReport &report, QString boardName) { //raw report is stored, decoded text is available from <DET>/GBT_ERRORS
+        GBTerrorArchive::Code c = errorArchive.append(iBoard, FEEid, report);
+        log(boardName + " GBT error report: " + GBTerrorArchive::codeNames[c]);
+        errorStatsChanged = true;
+    }
+
+    void publishServerStats() {
+        IPbusStats::Window w = stats.takeWindow();
+        serverStats.RTTp50_us           = w.p50_us;
+        serverStats.RTTp99_us           = w.p99_us;
+        serverStats.RTTmax_us           = w.max_us;
+        serverStats.packetsPerSecond    = w.packetsPerSecond;
+        serverStats.wordsPerSecond      = w.wordsPerSecond;
+        serverStats.timeouts            = stats.timeouts;
+        serverStats.retries             = stats.retries;
+        serverStats.staleResponses      = stats.staleResponses;
+        serverStats.lateStatusResponses = stats.lateStatusResponses;
+        serverStatsService->updateService();
     }
 
     void calculateSystemValues() {
-        BOARDS_OK = (TCM.isOK() && TCM.act.GBT.isOK());
-        for(qint8 iPM=19; iPM>=0; --iPM) { BOARDS_OK <<= 1; if (allPMs[iPM].isOK() && allPMs[iPM].act.GBT.isOK()) ++BOARDS_OK; }
-    }
-
-    void adjustThresholds(TypePM *pm, double rate_Hz) { //debug function! lab use only!
-        if (adjustConnection) return;
-        targetPM = pm;
-        targetRate_Hz = rate_Hz;
-        for (quint8 iCh = 0; iCh<12; ++iCh) {
-            thLo[iCh] = 1024;
-            thHi[iCh] = 3072;
-        }
-        adjEven = false;
-        adjustConnection = connect(this, &FITelectronics::countersReady, this, [&](quint16 FEEid) {
-            if (FEEid != targetPM->FEEid) return;
-            adjEven = !adjEven;
-            if (adjEven) return;
-            IPbusControlPacket p; connect(&p, &IPbusControlPacket::error, this, &IPbusTarget::error);
-            quint8 c = 0;
-            for (quint8 iCh = 0; iCh<12; ++iCh) {
-                if (targetPM->counters.rateCh[iCh].CFD < targetRate_Hz + sqrt(targetRate_Hz)) { thHi[iCh] = targetPM->act.THRESHOLD_CALIBR[iCh]; }
-                if (targetPM->counters.rateCh[iCh].CFD > targetRate_Hz - sqrt(targetRate_Hz)) { thLo[iCh] = targetPM->act.THRESHOLD_CALIBR[iCh]; }
-                if (thLo[iCh] != thHi[iCh]) {
-                    p.addWordToWrite(targetPM->baseAddress + PMparameters["THRESHOLD_CALIBR"].address + iCh, (thHi[iCh] + thLo[iCh]) / 2);
-                    ++c;
-                }
+        quint32 TRGsyncOK = 0; //by link №
+        for (quint8 i=0; i<10; ++i) {
+            TRGsyncOK |= (TCM.act.TRG_SYNC_A[i].linkOK && !TCM.act.TRG_SYNC_A[i].syncError) << i;
+            TRGsyncOK |= (TCM.act.TRG_SYNC_C[i].linkOK && !TCM.act.TRG_SYNC_C[i].syncError) << (i + 10);
+        }
+        BOARDS_OK = (TCM.isOK() && TCM.act.GBT.isOK()) << 20 | (state.PMstatusOK & TRGsyncOK);
+    }
+
+    void startThresholdCalibration(float rate_Hz) { //all channels of all PMs: CFD rates are brought to rate_Hz by THRESHOLD_CALIBR
+        if (TCM.act.COUNTERS_UPD_RATE == 0) {
+            emit error("Threshold calibration needs counters FIFO readout: COUNTERS_UPD_RATE is 0", logicError);
+            return;
+        }
+        if (rate_Hz <= 0) return;
+        quint32 mask = 0, thresholds[20][12];
+        foreach (TypePM *pm, PM) mask |= 1 << (pm - allPMs);
+        for (quint8 iPM=0; iPM<20; ++iPM) memcpy(thresholds[iPM], allPMs[iPM].act.THRESHOLD_CALIBR, sizeof(thresholds[iPM]));
+        calibration.start(rate_Hz, mask, thresholds);
+        std::fill_n(calibrationEntries, 20, 0);
+        log(QString::asprintf("Threshold calibration started for %d PMs, target rate %.1f Hz", PM.size(), rate_Hz));
+        publishCalibration();
+    }
+
+    void stopThresholdCalibration() {
+        if (!calibration.running) return;
+        calibration.running = false;
+        log("Threshold calibration stopped");
+        publishCalibration();
+    }
+
+    void calibrationStep(quint16 FEEid) { //a counters entry is ready
+        TypePM *pm = PM.value(FEEid, nullptr);
+        if (pm == nullptr || !(calibration.PMmask & 1 << (pm - allPMs))) return;
+        quint8 iPM = pm - allPMs;
+        if (calibrationWritten & 1 << iPM) return; //new thresholds are not written yet, later entries of the same drain are measured at the old ones
+        if (++calibrationEntries[iPM] < calibrationSettleEntries) { //the measurement starts after the entry spanning the write
+            for (quint8 iCh=0; iCh<12; ++iCh) calibrationCounts[iPM][iCh] = pm->counters.Ch[iCh].CFD;
+            return;
+        }
+        quint32 pending = calibrationWritten;
+        calibrationUpdatePM(pm);
+        if (!pending && calibrationWritten) QTimer::singleShot(0, this, &FITelectronics::calibrationCommit); //all PMs of the same FIFO drain go together
+        else if (!calibrationWritten && calibration.nConverged() == calibration.nChannels()) calibrationCommit();
+    }
+
+    void calibrationUpdatePM(TypePM *pm) {
+        quint8 iPM = pm - allPMs;
+        double time_s = countersUpdatePeriod_ms[TCM.act.COUNTERS_UPD_RATE] * 1e-3 * (calibrationEntries[iPM] - calibrationSettleEntries + 1);
+        calibrationEntries[iPM] = calibrationSettleEntries - 1; //if nothing is written, the next entry is the next measurement
+        for (quint8 iCh=0; iCh<12; ++iCh) {
+            quint32 counts = pm->counters.Ch[iCh].CFD;
+            qint32 th = calibration.update(iPM, iCh, counts - calibrationCounts[iPM][iCh], time_s);
+            calibrationCounts[iPM][iCh] = counts;
+            if (th < 0) continue;
+            pm->set.THRESHOLD_CALIBR[iCh] = th;
+            calibrationWritten |= 1 << iPM;
+        }
+    }
+
+    void calibrationCommit() { //new thresholds of all PMs in one batch
+        if (!calibration.running) return;
+        const Parameter par = PMparameters("THRESHOLD_CALIBR");
+        if (calibrationWritten) {
+            beginBatch();
+            foreach (TypePM *pm, PM) if (calibrationWritten & 1 << (pm - allPMs)) {
+                writeBlock(pm->baseAddress + par.address, pm->set.THRESHOLD_CALIBR, 12, false);
+                calibrationEntries[pm - allPMs] = 0;
             }
-            if (c) transceive(p); else disconnect(adjustConnection);
-        });
+            calibrationWritten = 0;
+            if (!commitBatch()) stopThresholdCalibration();
+        }
+        if (calibration.nConverged() == calibration.nChannels()) {
+            calibration.running = false;
+            log(QString::asprintf("Threshold calibration finished in %d steps", calibration.maxSteps()));
+        }
+        publishCalibration();
+    }
+
+    void publishCalibration() {
+        calibrationProgress[0] = calibration.running;
+        calibrationProgress[1] = calibration.nConverged();
+        calibrationProgress[2] = calibration.nChannels();
+        calibrationProgress[3] = calibration.maxSteps();
+        calibrationProgressService->updateService();
+        if (calibration.running) return;
+        for (quint8 iPM=0; iPM<20; ++iPM) for (quint8 iCh=0; iCh<12; ++iCh) calibrationResult[20*iCh + iPM] = calibration.PMmask & 1 << iPM ? calibration.ch[iPM][iCh].threshold : -1;
+        calibrationResultService->updateService();
     }
 
     void inverseLaserPhase() { writeRegister(0x2, shuttleStartPhase = -shuttleStartPhase, false); }
 
     void reset(quint16 FEEid, quint8 RB_position, bool syncOnSuccess = true) {
         quint32 address = (FEEid == TCMid ? 0x0 : PM[FEEid]->baseAddress) + GBTunit::controlAddress;
-        IPbusControlPacket p; connect(&p, &IPbusControlPacket::error, this, &IPbusTarget::error);
+        IPbusControlPacket p(forwardError);
         p.addTransaction(RMWbits, address, p.masks(0xFFFF00FF, 0x00000000)); //clear all reset bits
         p.addTransaction(RMWbits, address, p.masks(0xFFFFFFFF, 1 << RB_position)); //set specific bit, e.g. 0x00000800 for RS_GBTerrors
         p.addTransaction(RMWbits, address, p.masks(0xFFFF00FF, 0x00000000)); //clear all reset bits
@@ -878,35 +1517,35 @@ public slots:
     void apply_RESET_RX_PHASE_ERROR       (quint16 FEEid, bool syncOnSuccess = true) { reset(FEEid, GBTunit::RB_RXphaseError         , syncOnSuccess); }
     void apply_RESET_FSM                  (quint16 FEEid, bool syncOnSuccess = true) { reset(FEEid, GBTunit::RB_readoutFSM           , syncOnSuccess); }
 
-    void apply_TG_CTP_EMUL_MODE(quint16 FEEid, quint8 RO_mode) { writeParameter("TG_CTP_EMUL_MODE", RO_mode, FEEid); }
+    void apply_TG_CTP_EMUL_MODE(quint16 FEEid, quint8 RO_mode) { writeParameter(GBTparameters("TG_CTP_EMUL_MODE"), RO_mode, FEEid); }
 
     void apply_DG_MODE(quint16 FEEid, quint8 DG_mode) {
         (FEEid == TCMid ? TCM.set.GBT : PM[FEEid]->set.GBT).DG_MODE = DG_mode;
-        writeParameter("DG_MODE", DG_mode, FEEid);
+        writeParameter(GBTparameters("DG_MODE"), DG_mode, FEEid);
     }
 
     void apply_TG_MODE(quint16 FEEid, quint8 TG_mode) {
         (FEEid == TCMid ? TCM.set.GBT : PM[FEEid]->set.GBT).TG_MODE = TG_mode;
-        writeParameter("TG_MODE", TG_mode, FEEid);
-    }
-
-    void apply_TG_PATTERN           (quint16 FEEid) { writeParameter("TG_PATTERN"           , *(quint64 *)&(FEEid == TCMid ? TCM.set.GBT : PM[FEEid]->set.GBT).TG_PATTERN_LSB, FEEid); }
-    void apply_TG_CONT_VALUE        (quint16 FEEid) { writeParameter("TG_CONT_VALUE"        , (FEEid == TCMid ? TCM.set.GBT : PM[FEEid]->set.GBT).TG_CONT_VALUE        , FEEid); }
-    void apply_TG_BUNCH_FREQ        (quint16 FEEid) { writeParameter("TG_BUNCH_FREQ"        , (FEEid == TCMid ? TCM.set.GBT : PM[FEEid]->set.GBT).TG_BUNCH_FREQ        , FEEid); }
-    void apply_TG_FREQ_OFFSET       (quint16 FEEid) { writeParameter("TG_FREQ_OFFSET"       , (FEEid == TCMid ? TCM.set.GBT : PM[FEEid]->set.GBT).TG_FREQ_OFFSET       , FEEid); }
-    void apply_TG_HBr_RATE          (quint16 FEEid) { writeParameter("TG_HBr_RATE"          , (FEEid == TCMid ? TCM.set.GBT : PM[FEEid]->set.GBT).TG_HBr_RATE          , FEEid); }
-    void apply_DG_TRG_RESPOND_MASK  (quint16 FEEid) { writeParameter("DG_TRG_RESPOND_MASK"  , (FEEid == TCMid ? TCM.set.GBT : PM[FEEid]->set.GBT).DG_TRG_RESPOND_MASK  , FEEid); }
-    void apply_DG_BUNCH_PATTERN     (quint16 FEEid) { writeParameter("DG_BUNCH_PATTERN"     , (FEEid == TCMid ? TCM.set.GBT : PM[FEEid]->set.GBT).DG_BUNCH_PATTERN     , FEEid); }
-    void apply_DG_BUNCH_FREQ        (quint16 FEEid) { writeParameter("DG_BUNCH_FREQ"        , (FEEid == TCMid ? TCM.set.GBT : PM[FEEid]->set.GBT).DG_BUNCH_FREQ        , FEEid); }
-    void apply_DG_FREQ_OFFSET       (quint16 FEEid) { writeParameter("DG_FREQ_OFFSET"       , (FEEid == TCMid ? TCM.set.GBT : PM[FEEid]->set.GBT).DG_FREQ_OFFSET       , FEEid); }
-    void apply_BCID_DELAY           (quint16 FEEid) { writeParameter("BCID_DELAY"           , (FEEid == TCMid ? TCM.set.GBT : PM[FEEid]->set.GBT).BCID_DELAY           , FEEid); }
-    void apply_DATA_SEL_TRG_MASK    (quint16 FEEid) { writeParameter("DATA_SEL_TRG_MASK"    , (FEEid == TCMid ? TCM.set.GBT : PM[FEEid]->set.GBT).DATA_SEL_TRG_MASK    , FEEid); }
-
-    void apply_HB_RESPONSE (quint16 FEEid, bool on) { (FEEid == TCMid ? TCM.set.GBT : PM[FEEid]->set.GBT).HB_RESPONSE  = on; writeParameter("HB_RESPONSE" , on, FEEid); }
-    void apply_READOUT_LOCK(quint16 FEEid, bool on) { (FEEid == TCMid ? TCM.set.GBT : PM[FEEid]->set.GBT).READOUT_LOCK = on; writeParameter("READOUT_LOCK", on, FEEid); }
-    void apply_BYPASS_MODE (quint16 FEEid, bool on) { (FEEid == TCMid ? TCM.set.GBT : PM[FEEid]->set.GBT).BYPASS_MODE  = on; writeParameter("BYPASS_MODE" , on, FEEid); }
-    void apply_HB_REJECT   (quint16 FEEid, bool on) { (FEEid == TCMid ? TCM.set.GBT : PM[FEEid]->set.GBT).HB_REJECT    = on; writeParameter("HB_REJECT"   , on, FEEid); }
-    void apply_shiftRxPhase(quint16 FEEid, bool on) { (FEEid == TCMid ? TCM.set.GBT : PM[FEEid]->set.GBT).shiftRxPhase = on; writeParameter("shiftRxPhase", on, FEEid); }
+        writeParameter(GBTparameters("TG_MODE"), TG_mode, FEEid);
+    }
+
+    void apply_TG_PATTERN           (quint16 FEEid) { writeParameter(GBTparameters("TG_PATTERN")           , *(quint64 *)&(FEEid == TCMid ? TCM.set.GBT : PM[FEEid]->set.GBT).TG_PATTERN_LSB, FEEid); }
+    void apply_TG_CONT_VALUE        (quint16 FEEid) { writeParameter(GBTparameters("TG_CONT_VALUE")        , (FEEid == TCMid ? TCM.set.GBT : PM[FEEid]->set.GBT).TG_CONT_VALUE        , FEEid); }
+    void apply_TG_BUNCH_FREQ        (quint16 FEEid) { writeParameter(GBTparameters("TG_BUNCH_FREQ")        , (FEEid == TCMid ? TCM.set.GBT : PM[FEEid]->set.GBT).TG_BUNCH_FREQ        , FEEid); }
+    void apply_TG_FREQ_OFFSET       (quint16 FEEid) { writeParameter(GBTparameters("TG_FREQ_OFFSET")       , (FEEid == TCMid ? TCM.set.GBT : PM[FEEid]->set.GBT).TG_FREQ_OFFSET       , FEEid); }
+    void apply_TG_HBr_RATE          (quint16 FEEid) { writeParameter(GBTparameters("TG_HBr_RATE")          , (FEEid == TCMid ? TCM.set.GBT : PM[FEEid]->set.GBT).TG_HBr_RATE          , FEEid); }
+    void apply_DG_TRG_RESPOND_MASK  (quint16 FEEid) { writeParameter(GBTparameters("DG_TRG_RESPOND_MASK")  , (FEEid == TCMid ? TCM.set.GBT : PM[FEEid]->set.GBT).DG_TRG_RESPOND_MASK  , FEEid); }
+    void apply_DG_BUNCH_PATTERN     (quint16 FEEid) { writeParameter(GBTparameters("DG_BUNCH_PATTERN")     , (FEEid == TCMid ? TCM.set.GBT : PM[FEEid]->set.GBT).DG_BUNCH_PATTERN     , FEEid); }
+    void apply_DG_BUNCH_FREQ        (quint16 FEEid) { writeParameter(GBTparameters("DG_BUNCH_FREQ")        , (FEEid == TCMid ? TCM.set.GBT : PM[FEEid]->set.GBT).DG_BUNCH_FREQ        , FEEid); }
+    void apply_DG_FREQ_OFFSET       (quint16 FEEid) { writeParameter(GBTparameters("DG_FREQ_OFFSET")       , (FEEid == TCMid ? TCM.set.GBT : PM[FEEid]->set.GBT).DG_FREQ_OFFSET       , FEEid); }
+    void apply_BCID_DELAY           (quint16 FEEid) { writeParameter(GBTparameters("BCID_DELAY")           , (FEEid == TCMid ? TCM.set.GBT : PM[FEEid]->set.GBT).BCID_DELAY           , FEEid); }
+    void apply_DATA_SEL_TRG_MASK    (quint16 FEEid) { writeParameter(GBTparameters("DATA_SEL_TRG_MASK")    , (FEEid == TCMid ? TCM.set.GBT : PM[FEEid]->set.GBT).DATA_SEL_TRG_MASK    , FEEid); }
+
+    void apply_HB_RESPONSE (quint16 FEEid, bool on) { (FEEid == TCMid ? TCM.set.GBT : PM[FEEid]->set.GBT).HB_RESPONSE  = on; writeParameter(GBTparameters("HB_RESPONSE") , on, FEEid); }
+    void apply_READOUT_LOCK(quint16 FEEid, bool on) { (FEEid == TCMid ? TCM.set.GBT : PM[FEEid]->set.GBT).READOUT_LOCK = on; writeParameter(GBTparameters("READOUT_LOCK"), on, FEEid); }
+    void apply_BYPASS_MODE (quint16 FEEid, bool on) { (FEEid == TCMid ? TCM.set.GBT : PM[FEEid]->set.GBT).BYPASS_MODE  = on; writeParameter(GBTparameters("BYPASS_MODE") , on, FEEid); }
+    void apply_HB_REJECT   (quint16 FEEid, bool on) { (FEEid == TCMid ? TCM.set.GBT : PM[FEEid]->set.GBT).HB_REJECT    = on; writeParameter(GBTparameters("HB_REJECT")   , on, FEEid); }
+    void apply_shiftRxPhase(quint16 FEEid, bool on) { (FEEid == TCMid ? TCM.set.GBT : PM[FEEid]->set.GBT).shiftRxPhase = on; writeParameter(GBTparameters("shiftRxPhase"), on, FEEid); }
 
     void switchTRGsyncPM(quint8 iPM, bool on) {
         if (iPM >= 20) {
@@ -916,18 +1555,18 @@ public slots:
         if (on) {
             if (iPM < 10) {
                 TCM.set.CH_MASK_A |= 1 << iPM % 10;
-                setBit  (iPM % 10, TCMparameters["CH_MASK_A"].address);
+                setBit  (iPM % 10, TCMparameters("CH_MASK_A").address);
             } else {
                 TCM.set.CH_MASK_C |= 1 << iPM % 10;
-                setBit  (iPM % 10, TCMparameters["CH_MASK_C"].address);
+                setBit  (iPM % 10, TCMparameters("CH_MASK_C").address);
             }
         } else {
             if (iPM < 10) {
                 TCM.set.CH_MASK_A &= ~(1 << iPM % 10);
-                clearBit(iPM % 10, TCMparameters["CH_MASK_A"].address);
+                clearBit(iPM % 10, TCMparameters("CH_MASK_A").address);
             } else {
                 TCM.set.CH_MASK_C &= ~(1 << iPM % 10);
-                clearBit(iPM % 10, TCMparameters["CH_MASK_C"].address);
+                clearBit(iPM % 10, TCMparameters("CH_MASK_C").address);
             }
         }
     }
@@ -941,10 +1580,10 @@ public slots:
         if (iCh < 12) {
             if (on) {
                 allPMs[iPM].set.CH_MASK_DATA |= 1 << iCh;
-                setBit  (iCh, allPMs[iPM].baseAddress + PMparameters["CH_MASK_DATA"].address);
+                setBit  (iCh, allPMs[iPM].baseAddress + PMparameters("CH_MASK_DATA").address);
             } else {
                 allPMs[iPM].set.CH_MASK_DATA &= ~(1 << iCh);
-                clearBit(iCh, allPMs[iPM].baseAddress + PMparameters["CH_MASK_DATA"].address);
+                clearBit(iCh, allPMs[iPM].baseAddress + PMparameters("CH_MASK_DATA").address);
             }
         } else emit error("invalid channel: " + QString::number(Ch), logicError);
     }
@@ -957,18 +1596,46 @@ public slots:
         quint8 iCh = Ch - 1;
         if (iCh < 12) {
             allPMs[iPM].set.TIME_ALIGN[iCh].blockTriggers = noTRG;
-            writeParameter("noTriggerMode", noTRG, allPMs[iPM].FEEid, iCh);
+            writeParameter(PMparameters("noTriggerMode"), noTRG, allPMs[iPM].FEEid, iCh);
         } else emit error("invalid channel: " + QString::number(Ch + 1), logicError);
     }
 
+    void applyChannelMasks(const qint32 *dataMasks, const qint32 *trgMasks, const qint32 *PMmask) { //[20] by link № each, PM mask for TCM; nullptr - unchanged. All changes go in one batch followed by one sync
+        const Parameter CH_MASK_DATA = PMparameters("CH_MASK_DATA"), noTRG = PMparameters("noTriggerMode");
+        if (dataMasks) for (quint8 iPM=0; iPM<20; ++iPM) allPMs[iPM].set.CH_MASK_DATA = dataMasks[iPM] & 0xFFF;
+        if (trgMasks) for (quint8 iPM=0; iPM<20; ++iPM) for (quint8 iCh=0; iCh<12; ++iCh) allPMs[iPM].set.TIME_ALIGN[iCh].blockTriggers = !(trgMasks[iPM] & 1 << iCh);
+        if (PMmask) {
+            TCM.set.CH_MASK_A = *PMmask       & 0x3FF;
+            TCM.set.CH_MASK_C = *PMmask >> 10 & 0x3FF;
+        }
+        bool masksChanged = TCM.set.CH_MASK_A != TCM.act.CH_MASK_A || TCM.set.CH_MASK_C != TCM.act.CH_MASK_C;
+        beginBatch();
+        foreach (TypePM *pm, PM) { //only changed PMs are written
+            if (dataMasks && pm->act.CH_MASK_DATA != pm->set.CH_MASK_DATA) writeRegister(pm->baseAddress + CH_MASK_DATA.address, pm->set.CH_MASK_DATA, false);
+            if (trgMasks && pm->act.CH_MASK_TRG != (trgMasks[pm - allPMs] & 0xFFFU)) for (quint8 iCh=0; iCh<12; ++iCh) //RMW: the rest of the time alignment is kept by the board, the actual values may be a configuration read old
+                writeNbits(pm->baseAddress + noTRG.address + iCh * noTRG.interval, pm->set.TIME_ALIGN[iCh].blockTriggers, 1, noTRG.bitshift, false);
+        }
+        if (masksChanged) {
+            writeRegister(TCMparameters("CH_MASK_A").address, TCM.set.CH_MASK_A, false);
+            writeRegister(TCMparameters("CH_MASK_C").address, TCM.set.CH_MASK_C, false);
+        }
+        if (!commitBatch()) return;
+        if (masksChanged) {
+            QThread::msleep(10); //to finish all PMs resync with TCM
+            apply_RESET_ERRORS(false);
+        }
+        sync(); //only the written boards are re-read in full
+    }
+
     void apply_RESET_SYSTEM(bool forceLocalClock = false) {
         PMsReady = false;
+        staleConfig = allBoardsMask;
         switchGBTerrorReports(false);
         writeRegister(0xF, forceLocalClock ? 0xC00 : 0x800);
         QTimer::singleShot(2000, this, [=](){ writeRegister(0xF, 0x4, false); switchGBTerrorReports(true); }); //clearing 'system restarted' and 'readiness changed' flags after restart
     }
     void apply_RESET_ERRORS(bool syncOnSuccess = true) {
-        IPbusControlPacket p; connect(&p, &IPbusControlPacket::error, this, &IPbusTarget::error);
+        IPbusControlPacket p(forwardError);
         p.addTransaction(RMWbits, GBTunit::controlAddress, p.masks(0xFFFF00FF, 0x00000000)); //clear all reset bits
         p.addTransaction(RMWbits, GBTunit::controlAddress, p.masks(0xFFFFFFFF, 1 << GBTunit::RB_readoutFSM | 1 << GBTunit::RB_GBTRxError | 1 << GBTunit::RB_errorReport));
         p.addTransaction(RMWbits, GBTunit::controlAddress, p.masks(0xFFBF00FF, 0x00000000)); //clear all reset bits and unlock
@@ -982,80 +1649,81 @@ public slots:
         if (transceive(p) && syncOnSuccess) sync();
     }
 
-    void apply_ADC0_RANGE      (quint16 FEEid, quint8 Ch) { writeParameter("ADC0_RANGE"      , PM[FEEid]->set.ADC_RANGE[Ch-1][0]    , FEEid, Ch-1); }
-    void apply_ADC1_RANGE      (quint16 FEEid, quint8 Ch) { writeParameter("ADC1_RANGE"      , PM[FEEid]->set.ADC_RANGE[Ch-1][1]    , FEEid, Ch-1); }
-    void apply_ADC_ZERO        (quint16 FEEid, quint8 Ch) { writeParameter("ADC_ZERO"        , PM[FEEid]->set.Ch[Ch-1].ADC_ZERO     , FEEid, Ch-1); }
-    void apply_CFD_ZERO        (quint16 FEEid, quint8 Ch) { writeParameter("CFD_ZERO"        , PM[FEEid]->set.Ch[Ch-1].CFD_ZERO     , FEEid, Ch-1); }
-    void apply_ADC_DELAY       (quint16 FEEid, quint8 Ch) { writeParameter("ADC_DELAY"       , PM[FEEid]->set.Ch[Ch-1].ADC_DELAY    , FEEid, Ch-1); }
-    void apply_CFD_THRESHOLD   (quint16 FEEid, quint8 Ch) { writeParameter("CFD_THRESHOLD"   , PM[FEEid]->set.Ch[Ch-1].CFD_THRESHOLD, FEEid, Ch-1); }
-    void apply_TIME_ALIGN      (quint16 FEEid, quint8 Ch) { writeParameter("TIME_ALIGN"      , PM[FEEid]->set.TIME_ALIGN[Ch-1].value, FEEid, Ch-1); }
-    void apply_THRESHOLD_CALIBR(quint16 FEEid, quint8 Ch) { writeParameter("THRESHOLD_CALIBR", PM[FEEid]->set.THRESHOLD_CALIBR[Ch-1], FEEid, Ch-1); }
-
-    void apply_LASER_DIVIDER() { writeParameter("LASER_DIVIDER", TCM.set.LASER_DIVIDER, TCMid); }
-    void apply_LASER_SOURCE(bool isGenerator) { TCM.set.LASER_SOURCE = isGenerator; writeParameter("LASER_SOURCE", isGenerator, TCMid); }
+    void apply_ADC0_RANGE      (quint16 FEEid, quint8 Ch) { writeParameter(PMparameters("ADC0_RANGE")      , PM[FEEid]->set.ADC_RANGE[Ch-1][0]    , FEEid, Ch-1); }
+    void apply_ADC1_RANGE      (quint16 FEEid, quint8 Ch) { writeParameter(PMparameters("ADC1_RANGE")      , PM[FEEid]->set.ADC_RANGE[Ch-1][1]    , FEEid, Ch-1); }
+    void apply_ADC_ZERO        (quint16 FEEid, quint8 Ch) { writeParameter(PMparameters("ADC_ZERO")        , PM[FEEid]->set.Ch[Ch-1].ADC_ZERO     , FEEid, Ch-1); }
+    void apply_CFD_ZERO        (quint16 FEEid, quint8 Ch) { writeParameter(PMparameters("CFD_ZERO")        , PM[FEEid]->set.Ch[Ch-1].CFD_ZERO     , FEEid, Ch-1); }
+    void apply_ADC_DELAY       (quint16 FEEid, quint8 Ch) { writeParameter(PMparameters("ADC_DELAY")       , PM[FEEid]->set.Ch[Ch-1].ADC_DELAY    , FEEid, Ch-1); }
+    void apply_CFD_THRESHOLD   (quint16 FEEid, quint8 Ch) { writeParameter(PMparameters("CFD_THRESHOLD")   , PM[FEEid]->set.Ch[Ch-1].CFD_THRESHOLD, FEEid, Ch-1); }
+    void apply_TIME_ALIGN      (quint16 FEEid, quint8 Ch) { writeParameter(PMparameters("TIME_ALIGN")      , PM[FEEid]->set.TIME_ALIGN[Ch-1].value, FEEid, Ch-1); }
+    void apply_THRESHOLD_CALIBR(quint16 FEEid, quint8 Ch) { writeParameter(PMparameters("THRESHOLD_CALIBR"), PM[FEEid]->set.THRESHOLD_CALIBR[Ch-1], FEEid, Ch-1); }
+
+    void apply_LASER_DIVIDER() { writeParameter(TCMparameters("LASER_DIVIDER"), TCM.set.LASER_DIVIDER, TCMid); }
+    void apply_LASER_SOURCE(bool isGenerator) { TCM.set.LASER_SOURCE = isGenerator; writeParameter(TCMparameters("LASER_SOURCE"), isGenerator, TCMid); }
     void apply_LASER_PATTERN() {
-        IPbusControlPacket p; connect(&p, &IPbusControlPacket::error, this, &IPbusTarget::error);
-        p.addTransaction(write, TCMparameters["LASER_PATTERN"].address, (quint32 *)&TCM.set.LASER_PATTERN, 2);
+        IPbusControlPacket p(forwardError);
+        p.addTransaction(write, TCMparameters("LASER_PATTERN").address, (quint32 *)&TCM.set.LASER_PATTERN, 2);
         if (transceive(p)) sync();
     }
     void apply_SwLaserPatternBit(quint8 bit, bool on) {
         if (bit >= 64) return;
-        quint32 address = TCMparameters["LASER_PATTERN"].address + bit/32;
+        quint32 address = TCMparameters("LASER_PATTERN").address + bit/32;
         on ? TCM.set.LASER_PATTERN |= 1ULL << bit : TCM.set.LASER_PATTERN &= ~(1ULL << bit);
         on ? setBit(bit % 32, address) : clearBit(bit % 32, address);
     }
-    void apply_attenSteps() { writeParameter("attenSteps", TCM.set.attenSteps, TCMid); }
-    void apply_LASER_ENABLED(bool on) { TCM.set.LASER_ENABLED = on; writeParameter("LASER_ENABLED", on, TCMid); }
-    void apply_LASER_DELAY() { writeParameter("LASER_DELAY", TCM.set.LASER_DELAY, TCMid); }
-    void apply_LSR_TRG_SUPPR_DUR  () { writeParameter("LASER_TRG_SUPPR_DUR", TCM.set.lsrTrgSupprDur, TCMid);}
-    void apply_LSR_TRG_SUPPR_DELAY() { writeParameter("LASER_TRG_SUPPR_DELAY", TCM.set.lsrTrgSupprDelay, TCMid);}
-    void apply_DELAY_A() { qint32 delay_ms = qAbs(TCM.set.DELAY_A - TCM.act.DELAY_A); writeParameter("DELAY_A", TCM.set.DELAY_A, TCMid); if (delay_ms > 1) QThread::msleep(delay_ms); apply_RESET_ERRORS(); }
-    void apply_DELAY_C() { qint32 delay_ms = qAbs(TCM.set.DELAY_C - TCM.act.DELAY_C); writeParameter("DELAY_C", TCM.set.DELAY_C, TCMid); if (delay_ms > 1) QThread::msleep(delay_ms); apply_RESET_ERRORS(); }
-    void apply_CH_MASK_A() { writeParameter("CH_MASK_A", TCM.set.CH_MASK_A, TCMid); }
-    void apply_CH_MASK_C() { writeParameter("CH_MASK_C", TCM.set.CH_MASK_C, TCMid); }
-
-    void apply_T1_ENABLED(bool on) { TCM.set.T1_ENABLED = on; writeParameter("T1_ENABLED", on, TCMid); }
-    void apply_T2_ENABLED(bool on) { TCM.set.T2_ENABLED = on; writeParameter("T2_ENABLED", on, TCMid); }
-    void apply_T3_ENABLED(bool on) { TCM.set.T3_ENABLED = on; writeParameter("T3_ENABLED", on, TCMid); }
-    void apply_T4_ENABLED(bool on) { TCM.set.T4_ENABLED = on; writeParameter("T4_ENABLED", on, TCMid); }
-    void apply_T5_ENABLED(bool on) { TCM.set.T5_ENABLED = on; writeParameter("T5_ENABLED", on, TCMid); }
-    void apply_EXTENDED_READOUT(bool on) { TCM.set.EXTENDED_READOUT = on; writeParameter("EXTENDED_READOUT", on, TCMid); }
-    void apply_ADD_C_DELAY(bool on) { TCM.set.ADD_C_DELAY = on; writeParameter("ADD_C_DELAY", on, TCMid); }
-    void apply_sidesCombMode(quint8 mode) { TCM.set.sidesCombMode = mode; writeParameter("sidesCombMode", mode, TCMid); }
+    void apply_attenSteps() { writeParameter(TCMparameters("attenSteps"), TCM.set.attenSteps, TCMid); }
+    void apply_LASER_ENABLED(bool on) { TCM.set.LASER_ENABLED = on; writeParameter(TCMparameters("LASER_ENABLED"), on, TCMid); }
+    void apply_LASER_DELAY() { writeParameter(TCMparameters("LASER_DELAY"), TCM.set.LASER_DELAY, TCMid); }
+    void apply_LSR_TRG_SUPPR_DUR  () { writeParameter(TCMparameters("LASER_TRG_SUPPR_DUR"), TCM.set.lsrTrgSupprDur, TCMid);}
+    void apply_LSR_TRG_SUPPR_DELAY() { writeParameter(TCMparameters("LASER_TRG_SUPPR_DELAY"), TCM.set.lsrTrgSupprDelay, TCMid);}
+    void apply_DELAY_A() { qint32 delay_ms = qAbs(TCM.set.DELAY_A - TCM.act.DELAY_A); writeParameter(TCMparameters("DELAY_A"), TCM.set.DELAY_A, TCMid); if (delay_ms > 1) QThread::msleep(delay_ms); apply_RESET_ERRORS(); }
+    void apply_DELAY_C() { qint32 delay_ms = qAbs(TCM.set.DELAY_C - TCM.act.DELAY_C); writeParameter(TCMparameters("DELAY_C"), TCM.set.DELAY_C, TCMid); if (delay_ms > 1) QThread::msleep(delay_ms); apply_RESET_ERRORS(); }
+    void apply_CH_MASK_A() { writeParameter(TCMparameters("CH_MASK_A"), TCM.set.CH_MASK_A, TCMid); }
+    void apply_CH_MASK_C() { writeParameter(TCMparameters("CH_MASK_C"), TCM.set.CH_MASK_C, TCMid); }
+
+    void apply_T1_ENABLED(bool on) { TCM.set.T1_ENABLED = on; writeParameter(TCMparameters("T1_ENABLED"), on, TCMid); }
+    void apply_T2_ENABLED(bool on) { TCM.set.T2_ENABLED = on; writeParameter(TCMparameters("T2_ENABLED"), on, TCMid); }
+    void apply_T3_ENABLED(bool on) { TCM.set.T3_ENABLED = on; writeParameter(TCMparameters("T3_ENABLED"), on, TCMid); }
+    void apply_T4_ENABLED(bool on) { TCM.set.T4_ENABLED = on; writeParameter(TCMparameters("T4_ENABLED"), on, TCMid); }
+    void apply_T5_ENABLED(bool on) { TCM.set.T5_ENABLED = on; writeParameter(TCMparameters("T5_ENABLED"), on, TCMid); }
+    void apply_EXTENDED_READOUT(bool on) { TCM.set.EXTENDED_READOUT = on; writeParameter(TCMparameters("EXTENDED_READOUT"), on, TCMid); }
+    void apply_ADD_C_DELAY(bool on) { TCM.set.ADD_C_DELAY = on; writeParameter(TCMparameters("ADD_C_DELAY"), on, TCMid); }
+    void apply_sidesCombMode(quint8 mode) { TCM.set.sidesCombMode = mode; writeParameter(TCMparameters("sidesCombMode"), mode, TCMid); }
     void apply_SW_EXT(quint8 sw, bool on) {
         TCM.set.EXT_SW = changeNbits(TCM.set.EXT_SW, 1, sw - 1, on);
-        on ? setBit(sw - 1, TCMparameters["EXT_SW"].address) : clearBit(sw - 1, TCMparameters["EXT_SW"].address);
-    }
-    void apply_T1_MODE(quint8 mode) { TCM.set.T1_MODE = mode; writeParameter("T1_MODE", mode, TCMid); }
-    void apply_T2_MODE(quint8 mode) { TCM.set.T2_MODE = mode; writeParameter("T2_MODE", mode, TCMid); }
-    void apply_T3_MODE(quint8 mode) { TCM.set.T3_MODE = mode; writeParameter("T3_MODE", mode, TCMid); }
-    void apply_T4_MODE(quint8 mode) { TCM.set.T4_MODE = mode; writeParameter("T4_MODE", mode, TCMid); }
-    void apply_T5_MODE(quint8 mode) { TCM.set.T5_MODE = mode; writeParameter("T5_MODE", mode, TCMid); }
-    void apply_T1_RATE() { writeParameter("T1_RATE", TCM.set.T1_RATE, TCMid); }
-    void apply_T2_RATE() { writeParameter("T2_RATE", TCM.set.T2_RATE, TCMid); }
-    void apply_T3_RATE() { writeParameter("T3_RATE", TCM.set.T3_RATE, TCMid); }
-    void apply_T4_RATE() { writeParameter("T4_RATE", TCM.set.T4_RATE, TCMid); }
-    void apply_T5_RATE() { writeParameter("T5_RATE", TCM.set.T5_RATE, TCMid); }
-    void apply_T1_LEVEL_A() { writeParameter("T1_LEVEL_A", TCM.set.T1_LEVEL_A, TCMid); }
-    void apply_T2_LEVEL_A() { writeParameter("T2_LEVEL_A", TCM.set.T2_LEVEL_A, TCMid); }
-    void apply_T1_LEVEL_C() { writeParameter("T1_LEVEL_C", TCM.set.T1_LEVEL_C, TCMid); }
-    void apply_T2_LEVEL_C() { writeParameter("T2_LEVEL_C", TCM.set.T2_LEVEL_C, TCMid); }
-    void apply_VTIME_LOW () { writeParameter("VTIME_LOW" , TCM.set.VTIME_LOW , TCMid); }
-    void apply_VTIME_HIGH() { writeParameter("VTIME_HIGH", TCM.set.VTIME_HIGH, TCMid); }
+        on ? setBit(sw - 1, TCMparameters("EXT_SW").address) : clearBit(sw - 1, TCMparameters("EXT_SW").address);
+    }
+    void apply_T1_MODE(quint8 mode) { TCM.set.T1_MODE = mode; writeParameter(TCMparameters("T1_MODE"), mode, TCMid); }
+    void apply_T2_MODE(quint8 mode) { TCM.set.T2_MODE = mode; writeParameter(TCMparameters("T2_MODE"), mode, TCMid); }
+    void apply_T3_MODE(quint8 mode) { TCM.set.T3_MODE = mode; writeParameter(TCMparameters("T3_MODE"), mode, TCMid); }
+    void apply_T4_MODE(quint8 mode) { TCM.set.T4_MODE = mode; writeParameter(TCMparameters("T4_MODE"), mode, TCMid); }
+    void apply_T5_MODE(quint8 mode) { TCM.set.T5_MODE = mode; writeParameter(TCMparameters("T5_MODE"), mode, TCMid); }
+    void apply_T1_RATE() { writeParameter(TCMparameters("T1_RATE"), TCM.set.T1_RATE, TCMid); }
+    void apply_T2_RATE() { writeParameter(TCMparameters("T2_RATE"), TCM.set.T2_RATE, TCMid); }
+    void apply_T3_RATE() { writeParameter(TCMparameters("T3_RATE"), TCM.set.T3_RATE, TCMid); }
+    void apply_T4_RATE() { writeParameter(TCMparameters("T4_RATE"), TCM.set.T4_RATE, TCMid); }
+    void apply_T5_RATE() { writeParameter(TCMparameters("T5_RATE"), TCM.set.T5_RATE, TCMid); }
+    void apply_T1_LEVEL_A() { writeParameter(TCMparameters("T1_LEVEL_A"), TCM.set.T1_LEVEL_A, TCMid); }
+    void apply_T2_LEVEL_A() { writeParameter(TCMparameters("T2_LEVEL_A"), TCM.set.T2_LEVEL_A, TCMid); }
+    void apply_T1_LEVEL_C() { writeParameter(TCMparameters("T1_LEVEL_C"), TCM.set.T1_LEVEL_C, TCMid); }
+    void apply_T2_LEVEL_C() { writeParameter(TCMparameters("T2_LEVEL_C"), TCM.set.T2_LEVEL_C, TCMid); }
+    void apply_VTIME_LOW () { writeParameter(TCMparameters("VTIME_LOW") , TCM.set.VTIME_LOW , TCMid); }
+    void apply_VTIME_HIGH() { writeParameter(TCMparameters("VTIME_HIGH"), TCM.set.VTIME_HIGH, TCMid); }
 
     void apply_PMparameter(QString parameterName, qint8 iPM, qint32 val) {//OR_GATE, TRGchargeLevelHi/Lo, PairedChannelsMode, TRG_CNT_MODE
-        if (!PMparameters.contains(parameterName)) { emit error(parameterName + "is wrong PM parameter", logicError); return; }
-        Parameter par = PMparameters[parameterName];
+        const Parameter *found = PMparameters.find(parameterName);
+        if (found == nullptr) { emit error(parameterName + "is wrong PM parameter", logicError); return; }
+        Parameter par = *found;
         if (par.interval) { emit error(parameterName + "is a channel parameter", logicError); return; }
         val = qBound(0, val, (1 << par.bitwidth) - 1); // limit the value to apply
         if (iPM >= 20 || iPM < -1) emit error(QString::asprintf("Incorrect PM index: %d", iPM), logicError);
         else if (iPM == -1) {
-            IPbusControlPacket p; connect(&p, &IPbusControlPacket::error, this, &IPbusTarget::error);
+            beginBatch();
             foreach (TypePM *pm, PM) {
                 pm->setParameter(parameterName, val);
-                p.addNBitsToChange(pm->baseAddress + par.address, val, par.bitwidth, par.bitshift);
+                writeNbits(pm->baseAddress + par.address, val, par.bitwidth, par.bitshift);
             }
-            if (transceive(p)) sync();
+            commitBatch();
         } else if (TCM.act.PM_MASK_SPI & 1 << iPM) {
             allPMs[iPM].setParameter(parameterName, val);
             writeParameter(parameterName, val, allPMs[iPM].FEEid);
@@ -1066,15 +1734,15 @@ public slots:
     void apply_TRGchargeLevelLo  (qint8 iPM, quint16 val) { apply_PMparameter("TRGchargeLevelLo"  , iPM, val); }
     void apply_PairedChannelsMode(qint8 iPM, bool    val) { apply_PMparameter("PairedChannelsMode", iPM, val); }
 
-    void apply_TRG_CNT_MODE(quint16 FEEid, bool CFDinGate) { writeParameter("TRG_CNT_MODE", CFDinGate, FEEid); }
-    void apply_CH_MASK_DATA (quint16 FEEid) { writeParameter("CH_MASK_DATA" , PM[FEEid]->set.CH_MASK_DATA , FEEid); }
+    void apply_TRG_CNT_MODE(quint16 FEEid, bool CFDinGate) { writeParameter(PMparameters("TRG_CNT_MODE"), CFDinGate, FEEid); }
+    void apply_CH_MASK_DATA (quint16 FEEid) { writeParameter(PMparameters("CH_MASK_DATA") , PM[FEEid]->set.CH_MASK_DATA , FEEid); }
     void apply_CH_MASK_TRG  (quint16 FEEid) {
-        IPbusControlPacket p; connect(&p, &IPbusControlPacket::error, this, &IPbusTarget::error);
+        IPbusControlPacket p(forwardError);
         for (quint8 i=0; i<12; ++i) {
             bool b = PM[FEEid]->set.TIME_ALIGN[i].blockTriggers;
             if (bool(PM[FEEid]->act.timeAlignment[i].blockTriggers) != b) {
-                if (b) p.addTransaction(RMWbits, PM[FEEid]->baseAddress + PMparameters["noTriggerMode"].address + i, p.masks(0xFFFFFFFF, 1 << PMparameters["noTriggerMode"].bitshift));
-                else   p.addTransaction(RMWbits, PM[FEEid]->baseAddress + PMparameters["noTriggerMode"].address + i, p.masks(~(1 << PMparameters["noTriggerMode"].bitshift), 0));
+                if (b) p.addTransaction(RMWbits, PM[FEEid]->baseAddress + PMparameters("noTriggerMode").address + i, p.masks(0xFFFFFFFF, 1 << PMparameters("noTriggerMode").bitshift));
+                else   p.addTransaction(RMWbits, PM[FEEid]->baseAddress + PMparameters("noTriggerMode").address + i, p.masks(~(1 << PMparameters("noTriggerMode").bitshift), 0));
             }
         }
         if (transceive(p)) sync();
@@ -1088,21 +1756,49 @@ public slots:
     void copyActualToSettingsPM(TypePM *pm) { foreach(regblock b, pm->set.regblocks) memcpy(pm->set.registers + b.addr, pm->act.registers + b.addr, b.size() * wordSize); }
 
     void applySettingsPM(TypePM *pm) {
-        IPbusControlPacket p; connect(&p, &IPbusControlPacket::error, this, &IPbusTarget::error);
-        foreach(regblock b, pm->set.regblocks) p.addTransaction(write, pm->baseAddress + b.addr, pm->set.registers + b.addr, b.size());
-        transceive(p);
+        beginBatch();
+        foreach(regblock b, pm->set.regblocks) writeBlock(pm->baseAddress + b.addr, pm->set.registers + b.addr, b.size(), false);
+        commitBatch();
+    }
+
+    void writeChangedRuns(quint32 baseAddress, const QVector<regblock> &blocks, quint32 *set, const quint32 *act) { //contiguous changed words go in one transaction
+        beginBatch();
+        foreach (regblock b, blocks) for (quint16 i=b.addr; i<=b.endAddr; ++i) if (set[i] != act[i]) {
+            quint16 j = i;
+            while (j < b.endAddr && set[j + 1] != act[j + 1]) ++j;
+            writeBlock(baseAddress + i, set + i, j - i + 1, false);
+            i = j;
+        }
+        commitBatch();
     }
 
+    void applySettingsPMdelta(TypePM *pm) { writeChangedRuns(pm->baseAddress, pm->set.regblocks, pm->set.registers, pm->act.registers); }
+
     void copyActualToSettingsTCM() { foreach(regblock b, TCM.set.regblocksToRead) memcpy(TCM.set.registers + b.addr, TCM.act.registers + b.addr, b.size() * wordSize); }
 
-    void applySettingsTCM() {
-        IPbusControlPacket p; connect(&p, &IPbusControlPacket::error, this, &IPbusTarget::error);
-        foreach(regblock b, TCM.set.regblocksToApply) p.addTransaction(write, b.addr, TCM.set.registers + b.addr, b.size());
+    static const quint32 reg0EsettingsMask = 0x0000030F; //reg0E bits 4..7 and 10 are TCM histogram settings, only bits 0..3 and 8..9 are applied from files
+
+    static QVector<regblock> withoutRegister(const QVector<regblock> &blocks, quint8 address) { //the register is cut out of the block containing it
+        QVector<regblock> res;
+        foreach (regblock b, blocks) {
+            if (address < b.addr || address > b.endAddr) res.append(b);
+            else {
+                if (address > b.addr) res.append({b.addr, quint8(address - 1)});
+                if (address < b.endAddr) res.append({quint8(address + 1), b.endAddr});
+            }
+        }
+        return res;
+    }
+
+    void applySettingsTCM(bool keepHistogramSettings = false) {
+        IPbusControlPacket p(forwardError);
+        foreach(regblock b, keepHistogramSettings ? withoutRegister(TCM.set.regblocksToApply, 0xE) : TCM.set.regblocksToApply) p.addTransaction(write, b.addr, TCM.set.registers + b.addr, b.size());
+        if (keepHistogramSettings) p.addTransaction(RMWbits, 0xE, p.masks(~reg0EsettingsMask, TCM.set.registers[0xE] & reg0EsettingsMask));
         qint32 delay_ms = qMax(qAbs(TCM.set.DELAY_A - TCM.act.DELAY_A), qAbs(TCM.set.DELAY_C - TCM.act.DELAY_C)) + 10; //phase needs time to move
         if (!transceive(p)) return;
         if (delay_ms > 1) QThread::msleep(delay_ms); //waiting for phases shift to complete
-        p.addWordToWrite(TCMparameters["CH_MASK_A"].address, TCM.set.CH_MASK_A);
-        p.addWordToWrite(TCMparameters["CH_MASK_C"].address, TCM.set.CH_MASK_C);
+        p.addWordToWrite(TCMparameters("CH_MASK_A").address, TCM.set.CH_MASK_A);
+        p.addWordToWrite(TCMparameters("CH_MASK_C").address, TCM.set.CH_MASK_C);
         if (!transceive(p)) return;
         QThread::msleep(10); //to finish all PMs resync with TCM
         apply_RESET_ERRORS();
@@ -1110,24 +1806,71 @@ public slots:
         if (TCM.act.COUNTERS_UPD_RATE != TCM.set.COUNTERS_UPD_RATE) apply_COUNTERS_UPD_RATE(TCM.set.COUNTERS_UPD_RATE);
     }
 
+    void applySettingsTCMdelta() { //same sequence as applySettingsTCM() but only for changed values
+        qint32 delay_ms = qMax(qAbs(TCM.set.DELAY_A - TCM.act.DELAY_A), qAbs(TCM.set.DELAY_C - TCM.act.DELAY_C));
+        beginBatch();
+        writeChangedRuns(0, withoutRegister(TCM.set.regblocksToApply, 0xE), TCM.set.registers, TCM.act.registers);
+        if ((TCM.set.registers[0xE] ^ TCM.act.registers[0xE]) & reg0EsettingsMask) { //histogram bits are kept, both parts are folded into one RMW
+            writeNbits(0xE, TCM.set.registers[0xE]     , 4, 0, false);
+            writeNbits(0xE, TCM.set.registers[0xE] >> 8, 2, 8, false);
+        }
+        if (!commitBatch()) return;
+        if (delay_ms > 0) QThread::msleep(delay_ms + 10); //waiting for phases shift to complete
+        bool masksChanged = TCM.set.CH_MASK_A != TCM.act.CH_MASK_A || TCM.set.CH_MASK_C != TCM.act.CH_MASK_C;
+        if (masksChanged) {
+            beginBatch();
+            writeRegister(TCMparameters("CH_MASK_A").address, TCM.set.CH_MASK_A, false);
+            writeRegister(TCMparameters("CH_MASK_C").address, TCM.set.CH_MASK_C, false);
+            if (!commitBatch()) return;
+            QThread::msleep(10); //to finish all PMs resync with TCM
+        }
+        if (delay_ms > 0 || masksChanged) {
+            apply_RESET_ERRORS();
+            writeRegister(0xF, 0x4, false); //clear "Readiness changed" flags
+        }
+        if (TCM.act.COUNTERS_UPD_RATE != TCM.set.COUNTERS_UPD_RATE) apply_COUNTERS_UPD_RATE(TCM.set.COUNTERS_UPD_RATE);
+    }
+
     void copyActualToSettingsAll() {
         foreach(TypePM *pm, PM) copyActualToSettingsPM(pm);
         copyActualToSettingsTCM();
     }
 
-    void applySettingsAll() {
-        foreach(TypePM *pm, PM) applySettingsPM(pm);
-        applySettingsTCM();
+    void applySettingsAll(bool delta = false) {
+        if (delta) readConfiguration();
+        beginBatch(); //all PMs settings are packed together
+        foreach(TypePM *pm, PM) delta ? applySettingsPMdelta(pm) : applySettingsPM(pm);
+        commitBatch();
+        delta ? applySettingsTCMdelta() : applySettingsTCM();
     }
 
-    void apply_ORBIT_FILL_MASK() {
-        IPbusControlPacket p; connect(&p, &IPbusControlPacket::error, this, &IPbusTarget::error);
-        p.addTransaction(write, 0x2A00, TCM.ORBIT_FILL_MASK, 223);
-        transceive(p);
+    void apply_ORBIT_FILL_MASK() { //identical uploads are skipped, changed words are written by runs, then the whole mask is read back and compared
+        const quint32 address = 0x2A00;
+        quint32 hash = snapshotChecksum(TCM.ORBIT_FILL_MASK, 223);
+        if (TCM.ORBIT_FILL_MASKisKnown && hash == TCM.ORBIT_FILL_MASKhash) return; //same filling scheme
+        beginBatch();
+        if (!TCM.ORBIT_FILL_MASKisKnown) writeBlock(address, TCM.ORBIT_FILL_MASK, 223, false);
+        else for (quint8 i=0; i<223; ++i) if (TCM.ORBIT_FILL_MASK[i] != TCM.ORBIT_FILL_MASKconfirmed[i]) {
+            quint8 j = i;
+            while (j < 222 && TCM.ORBIT_FILL_MASK[j + 1] != TCM.ORBIT_FILL_MASKconfirmed[j + 1]) ++j;
+            writeBlock(address + i, TCM.ORBIT_FILL_MASK + i, j - i + 1, false);
+            i = j;
+        }
+        TCM.ORBIT_FILL_MASKisKnown = false; //until confirmed
+        if (!commitBatch()) return;
+        IPbusControlPacket p(forwardError);
+        p.addTransaction(read, address, TCM.ORBIT_FILL_MASKconfirmed, 223);
+        if (!transceive(p)) return;
+        if (memcmp(TCM.ORBIT_FILL_MASKconfirmed, TCM.ORBIT_FILL_MASK, sizeof(TCM.ORBIT_FILL_MASK)) != 0) {
+            emit error("ORBIT_FILL_MASK readback differs from the uploaded mask", IPbusError);
+            return;
+        }
+        TCM.ORBIT_FILL_MASKhash = hash;
+        TCM.ORBIT_FILL_MASKisKnown = true;
     }
 
     void switchGBTerrorReports(bool on) {
-        IPbusControlPacket p; connect(&p, &IPbusControlPacket::error, this, &IPbusTarget::error);
+        IPbusControlPacket p(forwardError);
 //        p.addTransaction(RMWbits, GBTunit::controlAddress,);
         p.addNBitsToChange(GBTunit::controlAddress, !on, 1, GBTunit::RB_errorReport);
         foreach (TypePM *pm, PM) p.addNBitsToChange(pm->baseAddress + GBTunit::controlAddress, !on, 1, GBTunit::RB_errorReport);
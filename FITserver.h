@@ -0,0 +1,49 @@
+#ifndef FITSERVER_H
+#define FITSERVER_H
+
+#include "FITelectronics.h"
+
+class FITserver: public QObject { //headless mode: one engine per subdetector, each with its own socket and I/O thread, all under one DIM server
+    Q_OBJECT
+public:
+    QSettings settings;
+    DimServer DIMserver;
+    QList<FITelectronics *> engines;
+
+    FITserver(): settings(QCoreApplication::applicationName() + ".ini", QSettings::IniFormat) {
+        QStringList names = settings.value("subdetectors", "FT0,FV0,FDD").toString().split(',', Qt::SkipEmptyParts);
+        quint16 localPort = settings.value("firstLocalPort", 50006).toUInt();
+        foreach (QString name, names) {
+            TypeFITsubdetector sd = getSubdetectorTypeByName(name.trimmed());
+            if (sd == _0_) continue;
+            FITelectronics *FEE = new FITelectronics(sd, localPort++, false);
+            QSettings subset(settingsFileName(sd), QSettings::IniFormat); //same layout as the GUI settings file
+            FEE->IPaddress = subset.value("IPaddress", FEE->IPaddress).toString();
+            FEE->fileRead(settingsFileName(sd));
+            engines.append(FEE);
+        }
+        DIMserver.setDnsNode("localhost");
+        DIMserver.start("FIT_DIM_SERVER");
+        foreach (FITelectronics *FEE, engines) {
+            FEE->moveToIOthread();
+            FEE->post([=]() { FEE->reconnect(); });
+        }
+    }
+
+    ~FITserver() {
+        foreach (FITelectronics *FEE, engines) FEE->stopIOthread(); //all threads are stopped before any engine deletes its services
+        foreach (FITelectronics *FEE, engines) {
+            QSettings subset(settingsFileName(FEE->subdetector), QSettings::IniFormat);
+            subset.setValue("IPaddress", FEE->IPaddress);
+            subset.setValue("subdetector", FIT[FEE->subdetector].name);
+            subset.sync();
+            FEE->fileWrite(settingsFileName(FEE->subdetector));
+            delete FEE;
+        }
+        DIMserver.stop();
+    }
+
+    static QString settingsFileName(TypeFITsubdetector sd) { return QCoreApplication::applicationName() + "_" + FIT[sd].name + ".ini"; }
+};
+
+#endif // FITSERVER_H
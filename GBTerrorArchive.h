@@ -0,0 +1,94 @@
+#ifndef GBTERRORARCHIVE_H
+#define GBTERRORARCHIVE_H
+
+#include <QFile>
+#include <QMutex>
+#include <QVector>
+#include "FITboardsCommon.h"
+
+class GBTerrorArchive { //raw GBT error reports: the latest kept in memory, all appended to a binary file; text is made only on request
+public:
+    struct Record { //160 bytes in the file, host byte order
+        qint64 time_ms; //since epoch
+        quint16 FEEid, _reserved = 0;
+        quint32 data[GBTerrorReport::reportSize];
+        quint32 _padding = 0; //to the alignment of time_ms, so that no uninitialized bytes are written
+    };
+    static_assert(sizeof(Record) == 160, "Record is the file format");
+    enum Code {BCsyncLostInRun = 0, PMearlyHeader = 1, FIFOoverload = 2, other = 3, nCodes = 4};
+    static constexpr const char *codeNames[nCodes] = {"BC sync lost in run", "input packet corrupted: header too early", "raw data FIFO overload", "unknown error report"};
+    quint32 counts[21][nCodes] = {}; //[0-19] for PMs by link №, [20] for TCM
+
+private:
+    static const quint32 capacity = 1024; //power of 2
+    QVector<Record> ring = QVector<Record>(capacity);
+    quint32 nWritten = 0;
+    QFile file;
+    const qint64 maxSize; //bytes, then the file is renamed to name.1
+    mutable QMutex mutex; //appended from I/O thread, queried from DIM thread
+
+public:
+    GBTerrorArchive(QString fileName, qint64 maxSize_bytes = 64 << 20): file(fileName), maxSize(maxSize_bytes) { file.open(QFile::WriteOnly | QIODevice::Append); }
+
+    static Code code(quint32 errCode) {
+        switch (errCode) {
+            case GBTerrorReport::errCodeBCsyncLostInRun: return BCsyncLostInRun;
+            case GBTerrorReport::errCodePMearlyheader  : return PMearlyHeader;
+            case GBTerrorReport::errCodeFIFOoverload   : return FIFOoverload;
+            default                                    : return other;
+        }
+    }
+
+    Code append(quint8 iBoard, quint16 FEEid, const GBTerrorReport &report) {
+        QMutexLocker locker(&mutex);
+        Record &r = ring[nWritten++ & (capacity - 1)];
+        r.time_ms = QDateTime::currentMSecsSinceEpoch();
+        r.FEEid = FEEid;
+        memcpy(r.data, report.data, sizeof(r.data));
+        file.write((const char *)&r, sizeof(Record));
+        Code c = code(report.errCode);
+        ++counts[iBoard][c];
+        return c;
+    }
+
+    void flush() { //called once per sync cycle
+        QMutexLocker locker(&mutex);
+        if (!file.isOpen()) return;
+        file.flush();
+        if (file.size() > maxSize) {
+            QString name = file.fileName();
+            file.close();
+            QFile::remove(name + ".1");
+            QFile::rename(name, name + ".1");
+            file.open(QFile::WriteOnly | QIODevice::Append);
+        }
+    }
+
+    QString query(quint32 nReports) const { //latest reports decoded, oldest first
+        QMutexLocker locker(&mutex);
+        quint32 n = qMin(nReports, qMin(nWritten, capacity));
+        QString res;
+        for (quint32 k=nWritten-n; k!=nWritten; ++k) {
+            const Record &r = ring[k & (capacity - 1)];
+            GBTerrorReport report;
+            memcpy(report.data, r.data, sizeof(r.data));
+            res += QDateTime::fromMSecsSinceEpoch(r.time_ms).toString("yyyy-MM-dd hh:mm:ss.zzz ") + QString::asprintf("FEE %04X ", r.FEEid) + report.print() + "\n";
+        }
+        return res;
+    }
+};
+
+class GBTerrorsRpc : public DimRpc { //in: number of latest reports; out: their text
+    std::function<QString(qint32 nReports)> query;
+    QByteArray result;
+    void rpcHandler() override {
+        qint32 n = getSize() >= int(sizeof(qint32)) ? *(qint32 *)getData() : 0;
+        result = (n > 0 ? query(n) : QString()).toUtf8();
+        result.append('\0');
+        setData(result.data(), result.size());
+    }
+public:
+    GBTerrorsRpc(const char *name, std::function<QString(qint32)> f): DimRpc(name, "I:1", "C"), query(f) {}
+};
+
+#endif // GBTERRORARCHIVE_H
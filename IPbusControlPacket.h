@@ -1,33 +1,39 @@
 #ifndef IPBUSCONTROLPACKET_H
 #define IPBUSCONTROLPACKET_H
 #include "IPbusHeaders.h"
-#include <QObject>
+#include <QString>
 #include <QDateTime>
+#include <QVarLengthArray>
+#include <functional>
 
 const quint16 maxPacket = 368; //368 words, limit from ethernet MTU of 1500 bytes
 enum errorType {networkError = 0, IPbusError = 1, logicError = 2};
 static const char *errorTypeName[3] = {"Network error" , "IPbus error", "Logic error"};
 
-class IPbusControlPacket : public QObject {
-    Q_OBJECT
+class IPbusControlPacket { //plain object: no heap allocation and no signal connections per packet
 public:
-    QList<Transaction> transactionsList;
+    static const quint16 maxTransactions = (maxPacket - 1) / 2; //each transaction takes at least 2 request words
+    QVarLengthArray<Transaction, maxTransactions> transactionsList;
     quint16 requestSize = 1, responseSize = 1; //values are measured in words
     quint32 request[maxPacket], response[maxPacket];
     quint32 dt[2]; //temporary data
+    std::function<void(bool)> onResponse; //called once the response is received and processed
+    bool optimize = false; //fold RMWbits to the same register, merge contiguous writes
+    std::function<void(QString, errorType)> onError; //optional, called after the packet is printed to debug output
 
-    IPbusControlPacket() {
-        request[0] = PacketHeader(control, 0);
-        connect(this, &IPbusControlPacket::error, this, &IPbusControlPacket::debugPrint);
+    IPbusControlPacket(std::function<void(QString, errorType)> errorHandler = nullptr): onError(errorHandler) { request[0] = PacketHeader(control, 0); }
+
+    void error(QString message, errorType et) {
+        debugPrint(message);
+        if (onError) onError(message, et);
     }
-    ~IPbusControlPacket() { this->disconnect(); }
 
-    void debugPrint(QString st) {
-        qDebug(qPrintable(QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzz ") + st));
-        qDebug("request:");
-        for (quint16 i=0; i<requestSize; ++i)  qDebug("%08X", request[i]);
-        qDebug("        response:");
-        for (quint16 i=0; i<responseSize; ++i) qDebug("        %08X", response[i]);
+    void debugPrint(QString st) { //one message for the whole dump
+        QString dump = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzz ") + st + "\nrequest:";
+        for (quint16 i=0; i<requestSize; ++i)  dump += QString::asprintf("\n%08X", request[i]);
+        dump += "\n        response:";
+        for (quint16 i=0; i<responseSize; ++i) dump += QString::asprintf("\n        %08X", response[i]);
+        qDebug("%s", qPrintable(dump));
     }
 
     quint32 *masks(quint32 mask0, quint32 mask1) { //for convinient adding RMWbit transaction
@@ -37,6 +43,7 @@ public:
     }
 
     void addTransaction(TransactionType type, quint32 address, quint32 *data, quint8 nWords = 1) {
+        if (optimize && foldTransaction(type, address, data, nWords)) return;
         Transaction currentTransaction;
         request[requestSize] = TransactionHeader(type, nWords, transactionsList.size());
         currentTransaction.requestHeader = (TransactionHeader *)(request + requestSize++);
@@ -66,14 +73,32 @@ public:
                 currentTransaction.data = response + responseSize++;
                 break;
             default:
-                emit error("unknown transaction type", IPbusError);
+                error("unknown transaction type", IPbusError);
         }
         if (requestSize > maxPacket || responseSize > maxPacket) {
-            emit error("packet size exceeded", IPbusError);
+            error("packet size exceeded", IPbusError);
             return;
         } else transactionsList.append(currentTransaction);
     }
 
+    bool foldTransaction(TransactionType type, quint32 address, quint32 *data, quint8 nWords) { //returns true if the transaction was merged into the previous one
+        if (transactionsList.isEmpty()) return false;
+        Transaction &last = transactionsList.last();
+        if (type == RMWbits && last.requestHeader->TypeID == RMWbits && *last.address == address) {
+            quint32 *terms = last.address + 1; //(x & A1 | O1) & A2 | O2 == x & (A1 & A2) | (O1 & A2 | O2)
+            terms[1] = (terms[1] & data[0]) | data[1];
+            terms[0] &= data[0];
+            return true;
+        }
+        if (type == write && last.requestHeader->TypeID == write && *last.address + last.requestHeader->Words == address
+            && last.requestHeader->Words + nWords <= 255 && requestSize + nWords <= maxPacket) {
+            for (quint8 i=0; i<nWords; ++i) request[requestSize++] = data[i];
+            last.requestHeader->Words += nWords;
+            return true;
+        }
+        return false;
+    }
+
     void addWordToWrite(quint32 address, quint32 value) { addTransaction(write, address, &value, 1); }
 
     void addNBitsToChange(quint32 address, quint32 data, quint8 nbits, quint8 shift = 0) {
@@ -86,7 +111,7 @@ public:
         for (quint16 i=0; i<transactionsList.size(); ++i) {
             TransactionHeader *th = transactionsList.at(i).responseHeader;
             if (th->ProtocolVersion != 2 || th->TransactionID != i || th->TypeID != transactionsList.at(i).requestHeader->TypeID) {
-                emit error(QString::asprintf("unexpected transaction header: %08X, expected: %08X", *th, *transactionsList.at(i).requestHeader & 0xFFFFFFF0), IPbusError);
+                error(QString::asprintf("unexpected transaction header: %08X, expected: %08X", *th, *transactionsList.at(i).requestHeader & 0xFFFFFFF0), IPbusError);
                 return false;
             }
             if (th->Words > 0) switch (th->TypeID) {
@@ -96,34 +121,30 @@ public:
                     quint32 wordsAhead = response + responseSize - (quint32 *)th - 1;
                     if (th->Words > wordsAhead) { //response too short to contain nWords values
                         if (transactionsList.at(i).data != nullptr) memcpy(transactionsList.at(i).data, (quint32 *)th + 1, wordsAhead * wordSize);
-                        emit successfulRead(wordsAhead);
-                        if (th->InfoCode == 0) emit error(QString::asprintf("read transaction from %08X truncated: %d/%d words received", *transactionsList.at(i).address, wordsAhead, th->Words), IPbusError);
+                        if (th->InfoCode == 0) error(QString::asprintf("read transaction from %08X truncated: %d/%d words received", *transactionsList.at(i).address, wordsAhead, th->Words), IPbusError);
                         return false;
                     } else {
                         if (transactionsList.at(i).data != nullptr) memcpy(transactionsList.at(i).data, (quint32 *)th + 1, th->Words * wordSize);
-                        emit successfulRead(th->Words);
                     }
                     break;
                 }
                 case RMWbits:
                 case RMWsum :
                     if (th->Words != 1) {
-                        emit error("wrong RMW transaction", IPbusError);
+                        error("wrong RMW transaction", IPbusError);
                         return false;
                     }
-                    emit successfulRead(1);
-                    /* fall through */ //[[fallthrough]];
+                    break;
                 case                write:
                 case nonIncrementingWrite:
                 case   configurationWrite:
-                    emit successfulWrite(th->Words);
                     break;
                 default:
-                    emit error("unknown transaction type", IPbusError);
+                    error("unknown transaction type", IPbusError);
                     return false;
             }
             if (th->InfoCode != 0) {
-                emit error(th->infoCodeString() + QString::asprintf(", address: %08X", *transactionsList.at(i).address + th->Words), IPbusError);
+                error(th->infoCodeString() + QString::asprintf(", address: %08X", *transactionsList.at(i).address + th->Words), IPbusError);
                 return false;
             }
         }
@@ -134,11 +155,6 @@ public:
         requestSize = 1;
         responseSize = 1;
     }
-
-signals:
-    void error(QString, errorType);
-    void successfulRead(quint8 nWords);
-    void successfulWrite(quint8 nWords);
 };
 
 
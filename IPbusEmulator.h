@@ -0,0 +1,230 @@
+#ifndef IPBUSEMULATOR_H
+#define IPBUSEMULATOR_H
+
+#include <QtNetwork>
+#include <QRandomGenerator>
+#include "IPbusHeaders.h"
+#include "IPbusControlPacket.h"
+#include "FITboardsCommon.h"
+#include "TCM.h"
+#include "PM.h"
+
+class IPbusEmulator: public QObject { //IPbus 2.0 UDP target modelling the TCM and 20 PMs register maps, for benchmarks without hardware
+    Q_OBJECT
+public:
+    struct Config {
+        quint32 PMmask = 0xFFFFF;      //PMs present, by link №
+        quint32 latency_us = 0;        //added before each response
+        double loss = 0;               //probability to lose a request and, independently, a response
+        bool countersFIFOfull = false; //counters FIFOs always report full load, for throughput measurements
+    };
+
+private:
+    static const quint16 boardSpace = 0x200, nBoards = 21; //board 0 is TCM, board i + 1 is PM i
+    static const quint8 FIFOcapacity = 16; //counters entries
+    static const quint8 nHistory = 16; //stored responses for resend requests
+    const Config config;
+    const quint16 port;
+    QThread thread;
+    QUdpSocket *socket = nullptr;
+    QRandomGenerator random {12345}; //reproducible loss pattern
+    QElapsedTimer clock;
+    quint32 mem[nBoards * boardSpace] = {};
+    struct CountersFIFO {
+        quint32 value[24] = {};
+        quint8 number = 0, index = 0;
+        quint32 load = 0; //words
+        qint64 lastEntry_ms = 0;
+    } FIFO[nBoards];
+    quint32 errorReport[nBoards][GBTerrorReport::reportSize] = {};
+    quint8 errorReportIndex[nBoards] = {};
+    quint16 nextID = 1;
+    QByteArray history[nHistory];
+    quint16 historyID[nHistory] = {};
+
+    bool isPresent(quint8 board) const { return board == 0 || (board <= 20 && (config.PMmask >> (board - 1) & 1)); }
+
+    void setBit(quint32 address, quint8 bit, bool on) { mem[address] = on ? mem[address] | 1 << bit : mem[address] & ~(1 << bit); }
+
+    void updateFIFOload(quint8 board) {
+        CountersFIFO &f = FIFO[board];
+        quint16 period_ms = countersUpdatePeriod_ms[mem[TCMparameters("COUNTERS_UPD_RATE").address] & 7];
+        qint64 now_ms = clock.elapsed();
+        if (period_ms == 0) {
+            f.load = 0;
+            f.lastEntry_ms = now_ms;
+        } else if (config.countersFIFOfull) f.load = FIFOcapacity * f.number;
+        else {
+            qint64 n = (now_ms - f.lastEntry_ms) / period_ms;
+            f.load = quint32(qMin(qint64(FIFOcapacity * f.number), f.load + n * f.number));
+            f.lastEntry_ms += n * period_ms;
+        }
+    }
+
+    quint32 popFIFO(quint8 board) {
+        CountersFIFO &f = FIFO[board];
+        if (f.load == 0) return 0;
+        --f.load;
+        quint32 v = f.value[f.index];
+        if (++f.index == f.number) { //next entry: each counter grows with its own rate
+            f.index = 0;
+            for (quint8 c=0; c<f.number; ++c) f.value[c] += (c + 1) * (board + 1) * 100;
+        }
+        return v;
+    }
+
+    quint32 popErrorReport(quint8 board) {
+        quint32 v = errorReport[board][errorReportIndex[board]++];
+        if (errorReportIndex[board] == GBTerrorReport::reportSize) {
+            errorReportIndex[board] = 0;
+            setBit(board * boardSpace + GBTunit::statusAddress + 2, 5, true); //FIFOempty_errorReport
+        }
+        return v;
+    }
+
+    bool readWord(quint32 address, bool nonIncrementing, quint32 &value) {
+        if (address >= nBoards * boardSpace) return false;
+        quint8 board = address / boardSpace;
+        quint16 local = address % boardSpace;
+        if (!isPresent(board)) value = 0xFFFFFFFF; //no SPI connection
+        else if (nonIncrementing && local == TypeTCM::Counters::addressFIFO) value = popFIFO(board);
+        else if (local == TypeTCM::Counters::addressFIFOload) {
+            updateFIFOload(board);
+            value = FIFO[board].load;
+        } else if (nonIncrementing && local == GBTerrorReport::address) value = popErrorReport(board);
+        else value = mem[address];
+        return true;
+    }
+
+    QByteArray processControl(const quint32 *request, quint16 nWords) { //executes transactions, returns the response
+        QVector<quint32> response {request[0]};
+        quint16 i = 1;
+        while (i < nWords) {
+            TransactionHeader th(request[i]);
+            quint32 address = i + 1 < nWords ? request[i + 1] : 0;
+            quint8 n = th.Words;
+            th.InfoCode = 0;
+            qint32 iHeader = response.size();
+            response.append(th);
+            bool ok = true;
+            switch (th.TypeID) {
+                case read:
+                case nonIncrementingRead:
+                case configurationRead:
+                    for (quint8 k=0; k<n && ok; ++k) {
+                        quint32 v = 0;
+                        ok = readWord(address + (th.TypeID == nonIncrementingRead ? 0 : k), th.TypeID == nonIncrementingRead, v);
+                        if (ok) response.append(v);
+                    }
+                    i += 2;
+                    break;
+                case write:
+                case nonIncrementingWrite:
+                case configurationWrite:
+                    for (quint8 k=0; k<n && ok; ++k) {
+                        quint32 a = address + (th.TypeID == nonIncrementingWrite ? 0 : k);
+                        if ((ok = a < nBoards * boardSpace)) mem[a] = request[i + 2 + k];
+                    }
+                    i += 2 + n;
+                    break;
+                case RMWbits:
+                case RMWsum:
+                    if ((ok = address < nBoards * boardSpace)) {
+                        response.append(mem[address]);
+                        mem[address] = th.TypeID == RMWbits ? (mem[address] & request[i + 2]) | request[i + 3] : mem[address] + request[i + 2];
+                    }
+                    i += th.TypeID == RMWbits ? 4 : 3;
+                    break;
+                default:
+                    ok = false;
+                    i = nWords;
+            }
+            if (!ok) { //bus error: the rest of the packet is not executed
+                TransactionHeader eh(response[iHeader]);
+                eh.InfoCode = th.TypeID == write || th.TypeID == nonIncrementingWrite ? 0x5 : 0x4;
+                eh.Words = response.size() - iHeader - 1;
+                response[iHeader] = eh;
+                break;
+            }
+        }
+        return QByteArray((const char *)response.constData(), response.size() * wordSize);
+    }
+
+    void processDatagram(const QByteArray &d, const QHostAddress &host, quint16 senderPort) {
+        if (d.size() < qint32(wordSize) || d.size() % wordSize) return;
+        const quint32 *words = (const quint32 *)d.constData();
+        QByteArray response;
+        if (d.size() == sizeof(StatusPacket) && words[0] == StatusPacket().header) {
+            StatusPacket s;
+            s.MTU = qToBigEndian(quint32(maxPacket * wordSize));
+            s.nResponseBuffers = qToBigEndian(quint32(nHistory));
+            s.nextPacketID = qToBigEndian(quint32(PacketHeader(control, nextID)));
+            response = QByteArray((const char *)&s, sizeof(s));
+        } else {
+            PacketHeader h(words[0]);
+            if (h.ProtocolVersion != 2) return;
+            if (h.PacketType == resend) {
+                for (quint8 k=0; k<nHistory; ++k) if (historyID[k] == h.PacketID && !history[k].isEmpty()) response = history[k];
+                if (response.isEmpty()) return;
+            } else if (h.PacketType == control) {
+                if (h.PacketID != 0 && h.PacketID != nextID) return; //out of sequence, dropped like by real firmware
+                response = processControl(words, quint16(d.size() / wordSize));
+                if (h.PacketID != 0) {
+                    history[nextID % nHistory] = response;
+                    historyID[nextID % nHistory] = nextID;
+                    nextID = nextID == 0xFFFF ? 1 : nextID + 1;
+                }
+            } else return;
+        }
+        if (config.loss > 0 && random.generateDouble() < config.loss) return; //response lost
+        if (config.latency_us) QThread::usleep(config.latency_us);
+        socket->writeDatagram(response, host, senderPort);
+    }
+
+    void processPending() {
+        while (socket->hasPendingDatagrams()) {
+            QNetworkDatagram d = socket->receiveDatagram();
+            if (config.loss > 0 && random.generateDouble() < config.loss) continue; //request lost
+            processDatagram(d.data(), d.senderAddress(), quint16(d.senderPort()));
+        }
+    }
+
+public:
+    IPbusEmulator(Config c = Config(), quint16 localPort = 50001): config(c), port(localPort) {
+        clock.start();
+        Timestamp fw(2023, 6, 1, 12, 0, 0); //recent enough for GBT error reports
+        for (quint8 b=0; b<nBoards; ++b) {
+            quint32 *r = mem + b * boardSpace;
+            setBit(b * boardSpace + GBTunit::statusAddress + 2, 5, true); //FIFOempty_errorReport
+            memcpy(r + 0xF7, &fw, wordSize); //FW_TIME_MCU
+            memcpy(r + 0xFF, &fw, wordSize); //FW_TIME_FPGA
+            FIFO[b].number = b == 0 ? TypeTCM::Counters::number : TypePM::Counters::number;
+        }
+        mem[TCMparameters("PM_MASK_SPI").address] = config.PMmask;
+        moveToThread(&thread);
+        thread.setObjectName("IPbus emulator");
+        thread.start();
+        QMetaObject::invokeMethod(this, [=]() {
+            socket = new QUdpSocket(this);
+            if (!socket->bind(QHostAddress::LocalHost, port)) qWarning("IPbus emulator: port %d is busy", port);
+            connect(socket, &QUdpSocket::readyRead, this, &IPbusEmulator::processPending);
+        }, Qt::BlockingQueuedConnection);
+    }
+
+    ~IPbusEmulator() {
+        QMetaObject::invokeMethod(this, [=]() { delete socket; }, Qt::BlockingQueuedConnection);
+        thread.quit();
+        thread.wait();
+    }
+
+    void injectErrorReport(quint8 board, quint32 errCode) { //next sync reads a report from this board (0 for TCM, i + 1 for PM i)
+        QMetaObject::invokeMethod(this, [=]() {
+            errorReport[board][0] = errCode;
+            for (quint8 k=1; k<GBTerrorReport::reportSize; ++k) errorReport[board][k] = k;
+            errorReportIndex[board] = 0;
+            setBit(board * boardSpace + GBTunit::statusAddress + 2, 5, false);
+        }, Qt::BlockingQueuedConnection);
+    }
+};
+
+#endif // IPBUSEMULATOR_H
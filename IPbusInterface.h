@@ -2,8 +2,8 @@
 #define IPBUSINTERFACE_H
 
 #include <QtNetwork>
-#include <QMutex>
 #include "IPbusControlPacket.h"
+#include "IPbusStats.h"
 
 class IPbusTarget: public QObject {
     Q_OBJECT
@@ -11,28 +11,102 @@ class IPbusTarget: public QObject {
     QUdpSocket *qsocket = new QUdpSocket(this);
     const StatusPacket statusRequest;
     StatusPacket statusResponse;
-    QMutex mutex;
-    const int timeout_ms = 99;
+    const int timeout_ms = 99; //upper limit of the retransmission timeout, also used until round-trip time is measured
+    const quint8 maxRetries = 3; //recovery attempts without any response before the target is considered offline
+    double SRTT_ms = 0, RTTVAR_ms = 0; //smoothed round-trip time and its variation (RFC 6298), 0 means not measured yet
+    quint16 packetID = 0; //ID for the next control packet, 0 means the target doesn't track packets
+    quint8 maxPacketsInFlight = 1; //limited by the number of target's response buffers
+    quint32 datagram[maxPacket]; //receive buffer
+    quint8 batchDepth = 0; //nesting level of beginBatch()/commitBatch() scopes
+    bool batchSyncRequested = false;
+    QVector<IPbusControlPacket *> batch; //pending write packets, each filled up to maxPacket
+    QVector<IPbusControlPacket *> packetPool; //released packets, reused to avoid allocations
+
+    quint16 nextPacketID() {
+        quint16 id = packetID;
+        if (packetID) packetID = packetID == 0xFFFF ? 1 : packetID + 1; //zero ID is reserved
+        return id;
+    }
+
+    int retransmissionTimeout_ms() const { return SRTT_ms == 0 ? timeout_ms : qBound(5, int(std::ceil(SRTT_ms + 4 * RTTVAR_ms)), timeout_ms); }
+
+    void updateRTT(double RTT_ms) {
+        if (SRTT_ms == 0) {
+            SRTT_ms = RTT_ms;
+            RTTVAR_ms = RTT_ms / 2;
+        } else {
+            RTTVAR_ms = 0.75 * RTTVAR_ms + 0.25 * fabs(SRTT_ms - RTT_ms);
+            SRTT_ms = 0.875 * SRTT_ms + 0.125 * RTT_ms;
+        }
+    }
+
+    static bool isReceivedByTarget(quint16 id, quint16 nextExpectedID) { //IDs run from 1 to 0xFFFF, zero is skipped
+        quint16 d = quint16(nextExpectedID - id);
+        if (nextExpectedID < id) --d;
+        return d > 0 && d <= 0x8000;
+    }
+
+    IPbusControlPacket *batchPacket(quint16 requestWords, quint16 responseWords) { //last pending packet if the transaction fits there, a new one otherwise
+        if (batch.isEmpty() || batch.last()->requestSize + requestWords > maxPacket || batch.last()->responseSize + responseWords > maxPacket) {
+            IPbusControlPacket *p = acquirePacket();
+            p->optimize = true;
+            batch.append(p);
+        }
+        return batch.last();
+    }
+
+    bool flushBatch() { //send all pending packets
+        QVector<IPbusControlPacket *> packets;
+        packets.swap(batch);
+        bool result = transceive(packets.data(), packets.size());
+        foreach (IPbusControlPacket *p, packets) releasePacket(p);
+        return result;
+    }
 
 public:
     QString IPaddress = "172.20.75.180";
     bool isOnline = false;
     QTimer *updateTimer = new QTimer(this);
-    quint16 updatePeriod_ms = 1000;
+    quint16 updatePeriod_ms = 1000, reconnectPeriod_ms = 1000;
+    QElapsedTimer sinceStatusCheck;
+    IPbusStats stats;
+    const std::function<void(QString, errorType)> forwardError = [=](QString message, errorType et) { emit error(message, et); }; //error handler for packets
 
     IPbusTarget(quint16 lport = 0) : localport(lport) {
         qRegisterMetaType<errorType>("errorType");
         qRegisterMetaType<QAbstractSocket::SocketError>("socketError");
         updateTimer->setTimerType(Qt::PreciseTimer);
-        connect(updateTimer, &QTimer::timeout, this, [=]() { if (isOnline) sync(); else checkStatus(); });
+        connect(updateTimer, &QTimer::timeout, this, [=]() {
+            if (isOnline) sync();
+            else if (!sinceStatusCheck.isValid() || sinceStatusCheck.elapsed() >= reconnectPeriod_ms) { //the timer may tick faster than reconnection attempts are wanted
+                sinceStatusCheck.start();
+                checkStatus();
+            }
+        });
         connect(this, &IPbusTarget::error, updateTimer, &QTimer::stop);
         qsocket->setProxy(QNetworkProxy::NoProxy);
         if (!qsocket->bind(QHostAddress::AnyIPv4, localport)) qsocket->bind(QHostAddress::AnyIPv4);
         updateTimer->start(updatePeriod_ms);
     }
+    ~IPbusTarget() {
+        qDeleteAll(batch);
+        qDeleteAll(packetPool);
+    }
+
+    IPbusControlPacket *acquirePacket() { //empty packet from the pool, to be given back with releasePacket()
+        return packetPool.isEmpty() ? new IPbusControlPacket(forwardError) : packetPool.takeLast();
+    }
+
+    void releasePacket(IPbusControlPacket *p) {
+        p->reset();
+        p->optimize = false;
+        p->onResponse = nullptr;
+        p->onError = forwardError; //could be replaced by the user of the packet
+        packetPool.append(p);
+    }
 
     quint32 readRegister(quint32 address) {
-        IPbusControlPacket p; connect(&p, &IPbusControlPacket::error, this, &IPbusTarget::error);
+        IPbusControlPacket p(forwardError);
         p.addTransaction(read, address, nullptr, 1);
         TransactionHeader *th = p.transactionsList.last().responseHeader;
         return transceive(p, false) && th->InfoCode == 0 ? quint32(*++th) : 0xFFFFFFFF;
@@ -50,40 +124,107 @@ protected:
             qDebug()<<"Empty request"; //not a logicError anymore, just nothing to do
             return true;
         }
-        QMutexLocker ml(&mutex);
-        qint32 n = qint32(qsocket->write((char *)p.request, p.requestSize * wordSize));
-        if (n < 0) {
-            emit error("Socket write error: " + qsocket->errorString(), networkError);
-            return false;
-        } else if (n != p.requestSize * wordSize) {
-            emit error("Sending packet failed", networkError);
-            return false;
-        } else if (!qsocket->waitForReadyRead(timeout_ms) && !qsocket->hasPendingDatagrams()) {
-            isOnline = false;
-            emit noResponse();
-            return false;
-        }
-        n = qsocket->readDatagram((char *)p.response, qsocket->pendingDatagramSize());
-        if (n == 64 && p.response[0] == statusRequest.header) { //late status response received
-            if (!qsocket->hasPendingDatagrams() && !qsocket->waitForReadyRead(timeout_ms) && !qsocket->hasPendingDatagrams()) {
-                isOnline = false;
-                emit noResponse();
+        IPbusControlPacket *packets = &p;
+        return transceive(&packets, 1, shouldResponseBeProcessed);
+    }
+
+    bool transceive(IPbusControlPacket *const *packets, const qint32 N, bool shouldResponseBeProcessed = true) { //several requests are kept in flight, responses are matched by packet ID
+        if (!batch.isEmpty() && !flushBatch()) return false; //pending writes go first to keep the order of transactions
+        if (!isOnline) return false;
+        QVarLengthArray<bool, 32> done(N), resent(N);
+        QVarLengthArray<qint64, 32> sentAt_ns(N);
+        qint32 nSent = 0, nDone = 0, nInFlight = 0;
+        quint8 retries = 0;
+        bool result = true, statusRequested = false;
+        for (qint32 i=0; i<N; ++i) if ((done[i] = packets[i]->requestSize <= 1)) ++nDone;
+        while (nDone < N) {
+            while (nSent < N && nInFlight < maxPacketsInFlight) {
+                IPbusControlPacket *p = packets[nSent++];
+                if (p->requestSize <= 1) continue;
+                p->request[0] = PacketHeader(control, nextPacketID());
+                qint32 n = qint32(qsocket->write((char *)p->request, p->requestSize * wordSize));
+                if (n < 0) {
+                    emit error("Socket write error: " + qsocket->errorString(), networkError);
+                    return false;
+                } else if (n != p->requestSize * wordSize) {
+                    emit error("Sending packet failed", networkError);
+                    return false;
+                }
+                ++nInFlight;
+                sentAt_ns[nSent - 1] = stats.now_ns();
+                resent[nSent - 1] = false;
+                foreach (const Transaction &t, p->transactionsList) {
+                    quint8 type = t.requestHeader->TypeID;
+                    if (type != read && type != nonIncrementingRead && type != configurationRead) registerWritten(*t.address);
+                }
+            }
+            if (!qsocket->hasPendingDatagrams() && !qsocket->waitForReadyRead(retransmissionTimeout_ms()) && !qsocket->hasPendingDatagrams()) {
+                ++stats.timeouts;
+                if (packetID == 0 || retries == maxRetries) { //without packet IDs lost packets can't be identified
+                    isOnline = false;
+                    emit noResponse();
+                    return false;
+                }
+                ++retries;
+                qsocket->write((char *)&statusRequest, sizeof(statusRequest)); //find out which requests the target has got
+                statusRequested = true;
+                continue;
+            }
+            qint32 n = qint32(qsocket->readDatagram((char *)datagram, sizeof(datagram)));
+            if (n < 0) {
+                emit error("Socket read error: " + qsocket->errorString(), networkError);
                 return false;
             }
-            n = qsocket->readDatagram((char *)p.response, qsocket->pendingDatagramSize());
-        }
-        if (n == 0) {
-            emit error("empty response, no IPbus target on " + IPaddress, networkError);
-            return false;
-        } else if (n / wordSize > p.responseSize || p.response[0] != p.request[0] || n % wordSize > 0) {
-            emit error(QString::asprintf("incorrect response (%d bytes)", n), networkError);
-            return false;
-        } else {
-            p.responseSize = quint16(n / wordSize); //response can be shorter then expected if a transaction wasn't successful
-            bool result = shouldResponseBeProcessed ? p.processResponse() : true;
-            p.reset();
-            return result;
+            if (n == 64 && datagram[0] == statusRequest.header) {
+                if (!statusRequested) {
+                    ++stats.lateStatusResponses;
+                    continue;
+                }
+                statusRequested = false;
+                quint16 nextExpectedID = PacketHeader(qFromBigEndian(reinterpret_cast<StatusPacket *>(datagram)->nextPacketID)).PacketID;
+                for (qint32 i=0; i<nSent; ++i) if (!done[i]) { //lost response is requested again, lost request is sent again
+                    IPbusControlPacket *p = packets[i];
+                    quint16 id = PacketHeader(p->request[0]).PacketID;
+                    quint32 resendRequest = PacketHeader(resend, id);
+                    if (isReceivedByTarget(id, nextExpectedID)) qsocket->write((char *)&resendRequest, wordSize);
+                    else qsocket->write((char *)p->request, p->requestSize * wordSize);
+                    resent[i] = true;
+                    ++stats.retries;
+                }
+                continue;
+            }
+            if (n == 0) {
+                emit error("empty response, no IPbus target on " + IPaddress, networkError);
+                return false;
+            }
+            qint32 i = 0;
+            while (i < nSent && (done[i] || packets[i]->request[0] != datagram[0])) ++i;
+            if (i == nSent) { //response to a request that was given up on earlier
+                qDebug("stale response skipped: %08X", datagram[0]);
+                ++stats.staleResponses;
+                continue;
+            }
+            IPbusControlPacket *p = packets[i];
+            done[i] = true;
+            ++nDone;
+            --nInFlight;
+            retries = 0;
+            stats.addPacket(p->requestSize, quint16(n / wordSize), stats.now_ns() - sentAt_ns[i]);
+            if (!resent[i]) updateRTT((stats.now_ns() - sentAt_ns[i]) / 1e6); //Karn's rule: ambiguous samples are not used
+            bool ok;
+            if (n / wordSize > p->responseSize || n % wordSize > 0) {
+                emit error(QString::asprintf("incorrect response (%d bytes)", n), networkError);
+                ok = false;
+            } else {
+                p->responseSize = quint16(n / wordSize); //response can be shorter then expected if a transaction wasn't successful
+                memcpy(p->response, datagram, n);
+                ok = shouldResponseBeProcessed ? p->processResponse() : true;
+            }
+            if (p->onResponse) p->onResponse(ok);
+            p->reset();
+            result = result && ok;
         }
+        return result;
     }
 
 public slots:
@@ -92,6 +233,7 @@ public slots:
             qsocket->disconnectFromHost();
         }
         qsocket->connectToHost(IPaddress, 50001, QIODevice::ReadWrite, QAbstractSocket::IPv4Protocol);
+        SRTT_ms = RTTVAR_ms = 0; //the new target may be farther away
         if (!qsocket->waitForConnected(500) && qsocket->state() != QAbstractSocket::ConnectedState) {
             isOnline = false;
             emit noResponse();
@@ -104,6 +246,7 @@ public slots:
     void checkStatus() {
         qsocket->write((char *)&statusRequest, sizeof(statusRequest));
         if (!qsocket->waitForReadyRead(timeout_ms) && !qsocket->hasPendingDatagrams()) {
+            ++stats.timeouts;
             isOnline = false;
             emit noResponse();
         } else {
@@ -112,6 +255,8 @@ public slots:
                 isOnline = false;
                 emit noResponse(QString::asprintf("incorrect response (%d bytes). No IPbus?", n));
             } else {
+                maxPacketsInFlight = quint8(qBound(1U, qFromBigEndian(statusResponse.nResponseBuffers), 16U));
+                packetID = PacketHeader(qFromBigEndian(statusResponse.nextPacketID)).PacketID;
                 isOnline = true;
                 emit IPbusStatusOK();
             }
@@ -119,27 +264,76 @@ public slots:
     }
 
     virtual void sync() =0;
+    virtual void registerWritten(quint32 /*address*/) {} //called for every write or RMW transaction sent
+
+    void beginBatch() { ++batchDepth; } //writes are collected until the outermost commitBatch()
+
+    bool commitBatch() { //send collected writes in as few packets as possible, then sync once if any write asked for it
+        if (batchDepth == 0 || --batchDepth > 0) return true;
+        bool syncRequested = batchSyncRequested;
+        batchSyncRequested = false;
+        if (batch.isEmpty()) return true;
+        bool result = flushBatch();
+        if (result && syncRequested) sync();
+        return result;
+    }
 
     void writeRegister(quint32 address, quint32 data, bool syncOnSuccess = true) {
-        IPbusControlPacket p; connect(&p, &IPbusControlPacket::error, this, &IPbusTarget::error);
+        if (batchDepth) {
+            batchPacket(3, 1)->addTransaction(write, address, &data, 1);
+            batchSyncRequested |= syncOnSuccess;
+            return;
+        }
+        IPbusControlPacket p(forwardError);
         p.addTransaction(write, address, &data, 1);
         if (transceive(p) && syncOnSuccess) sync();
     }
 
+    void writeBlock(quint32 address, quint32 *data, quint16 nWords, bool syncOnSuccess = true) { //split into transactions and packets as needed
+        beginBatch();
+        while (nWords > 0) {
+            quint16 room = batch.isEmpty() || batch.last()->requestSize + 3 > maxPacket ? maxPacket - 1 : maxPacket - batch.last()->requestSize; //words left in the packet being filled
+            quint16 n = qMin(nWords, qMin(quint16(255), quint16(room - 2))); //transaction length is 8-bit
+            batchPacket(2 + n, 1)->addTransaction(write, address, data, quint8(n));
+            address += n;
+            data += n;
+            nWords -= n;
+        }
+        batchSyncRequested |= syncOnSuccess;
+        commitBatch();
+    }
+
     void setBit(quint8 n, quint32 address, bool syncOnSuccess = true) {
-        IPbusControlPacket p; connect(&p, &IPbusControlPacket::error, this, &IPbusTarget::error);
+        if (batchDepth) {
+            IPbusControlPacket *p = batchPacket(4, 2);
+            p->addTransaction(RMWbits, address, p->masks(0xFFFFFFFF, 1 << n));
+            batchSyncRequested |= syncOnSuccess;
+            return;
+        }
+        IPbusControlPacket p(forwardError);
         p.addTransaction(RMWbits, address, p.masks(0xFFFFFFFF, 1 << n));
         if (transceive(p) && syncOnSuccess) sync();
     }
 
     void clearBit(quint8 n, quint32 address, bool syncOnSuccess = true) {
-        IPbusControlPacket p; connect(&p, &IPbusControlPacket::error, this, &IPbusTarget::error);
+        if (batchDepth) {
+            IPbusControlPacket *p = batchPacket(4, 2);
+            p->addTransaction(RMWbits, address, p->masks(~(1 << n), 0x00000000));
+            batchSyncRequested |= syncOnSuccess;
+            return;
+        }
+        IPbusControlPacket p(forwardError);
         p.addTransaction(RMWbits, address, p.masks(~(1 << n), 0x00000000));
         if (transceive(p) && syncOnSuccess) sync();
     }
 
     void writeNbits(quint32 address, quint32 data, quint8 nbits = 16, quint8 shift = 0, bool syncOnSuccess = true) {
-        IPbusControlPacket p; connect(&p, &IPbusControlPacket::error, this, &IPbusTarget::error);
+        if (batchDepth) {
+            batchPacket(4, 2)->addNBitsToChange(address, data, nbits, shift);
+            batchSyncRequested |= syncOnSuccess;
+            return;
+        }
+        IPbusControlPacket p(forwardError);
         p.addNBitsToChange(address, data, nbits, shift);
         if (transceive(p) && syncOnSuccess) sync();
     }
@@ -0,0 +1,53 @@
+#ifndef IPBUSSTATS_H
+#define IPBUSSTATS_H
+
+#include <QtGlobal>
+#include <QElapsedTimer>
+#include <cmath>
+#include <cstring>
+
+class IPbusStats { //transport statistics of one target, collected on its I/O thread
+    static const quint8 nBins = 80; //round-trip time histogram, 4 bins per octave from 1 µs to 1 s
+    quint32 histogram[nBins] = {};
+    quint32 nRTT = 0;
+    qint64 maxRTT_ns = 0;
+    quint64 packets = 0, words = 0; //since the previous window
+    QElapsedTimer clock, window;
+
+public:
+    quint64 timeouts = 0, retries = 0, staleResponses = 0, lateStatusResponses = 0; //totals since start
+
+    struct Window { double p50_us, p99_us, max_us, packetsPerSecond, wordsPerSecond; };
+
+    IPbusStats() { clock.start(); window.start(); }
+
+    qint64 now_ns() const { return clock.nsecsElapsed(); }
+
+    void addPacket(quint16 requestWords, quint16 responseWords, qint64 RTT_ns) {
+        ++packets;
+        words += requestWords + responseWords;
+        if (RTT_ns > maxRTT_ns) maxRTT_ns = RTT_ns;
+        ++histogram[RTT_ns < 1000 ? 0 : qMin(int(nBins - 1), int(4 * std::log2(RTT_ns / 1e3)))]; //bin i covers [2^(i/4), 2^((i+1)/4)) µs
+        ++nRTT;
+    }
+
+    double percentile_us(double q) const { //upper edge of the bin holding the q-quantile, never above the maximum
+        if (nRTT == 0) return 0;
+        quint32 rank = quint32(std::ceil(q * nRTT)), sum = 0;
+        for (quint8 i=0; i<nBins; ++i) if ((sum += histogram[i]) >= rank) return qMin(std::exp2((i + 1) / 4.), maxRTT_ns / 1e3);
+        return maxRTT_ns / 1e3;
+    }
+
+    Window takeWindow() { //statistics since the previous call, then the histogram starts over
+        double t_s = window.nsecsElapsed() / 1e9;
+        window.restart();
+        Window w {percentile_us(0.5), percentile_us(0.99), maxRTT_ns / 1e3, t_s > 0 ? packets / t_s : 0, t_s > 0 ? words / t_s : 0};
+        memset(histogram, 0, sizeof(histogram));
+        nRTT = 0;
+        maxRTT_ns = 0;
+        packets = words = 0;
+        return w;
+    }
+};
+
+#endif // IPBUSSTATS_H
@@ -0,0 +1,150 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <QFile>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QMutex>
+#include <atomic>
+#include "BoundedQueue.h"
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+class Logger { //messages are queued without locking by any thread and written to file in batches by a background thread
+    struct Entry {
+        qint64 time_ms = 0;
+        QString text;
+    };
+    BoundedQueue<Entry, 4096> queue;
+    std::atomic<quint32> nDropped {0}; //messages lost because the queue was full
+    std::atomic<bool> stopping {false};
+    QFile file;
+    QMutex writing; //the writer thread and a synchronous flush on qFatal() don't mix their batches
+    const bool withTimestamps;
+    const qint64 maxSize; //bytes, then the file is rotated
+    const quint8 nBackups = 3; //name.1 is the newest
+    static const int writePeriod_ms = 100, syncPeriod_ms = 5000, repeatsReportPeriod_ms = 10000;
+    QThread *writer;
+    QString lastText; //writer thread only
+    quint32 nRepeats = 0;
+    qint64 lastRepeatsReport_ms = 0;
+    static inline Logger *messageLog = nullptr;
+
+    QByteArray format(qint64 time_ms, const QString &text) const {
+        return ((withTimestamps ? QDateTime::fromMSecsSinceEpoch(time_ms).toString("yyyy-MM-dd hh:mm:ss.zzz ") : QString()) + text + (text.endsWith('\n') ? "" : "\n")).toUtf8();
+    }
+
+    void reportRepeats(QByteArray &batch, qint64 time_ms) {
+        if (nRepeats == 0) return;
+        batch += format(time_ms, QString::asprintf("last message repeated %u times", nRepeats));
+        nRepeats = 0;
+        lastRepeatsReport_ms = time_ms;
+    }
+
+    void writeQueued() { //with writing locked
+        QByteArray batch;
+        Entry e;
+        while (queue.pop(e)) {
+            if (e.text == lastText) { //identical messages are counted, not written
+                ++nRepeats;
+                if (e.time_ms - lastRepeatsReport_ms > repeatsReportPeriod_ms) reportRepeats(batch, e.time_ms);
+                continue;
+            }
+            reportRepeats(batch, e.time_ms);
+            batch += format(e.time_ms, e.text);
+            lastText = e.text;
+            lastRepeatsReport_ms = e.time_ms;
+        }
+        qint64 now_ms = QDateTime::currentMSecsSinceEpoch();
+        if (nRepeats && now_ms - lastRepeatsReport_ms > repeatsReportPeriod_ms) reportRepeats(batch, now_ms); //the queue may stay idle after the repeats
+        if (quint32 n = nDropped.exchange(0)) batch += format(QDateTime::currentMSecsSinceEpoch(), QString::asprintf("%u messages dropped: log queue full", n));
+        if (batch.isEmpty()) return;
+        file.write(batch);
+        file.flush();
+        if (file.size() > maxSize) rotate();
+    }
+
+    void rotate() {
+        QString name = file.fileName();
+        file.close();
+        QFile::remove(name + QString::asprintf(".%d", nBackups));
+        for (quint8 i=nBackups; i>1; --i) QFile::rename(name + QString::asprintf(".%d", i - 1), name + QString::asprintf(".%d", i));
+        QFile::rename(name, name + ".1");
+        file.open(QFile::WriteOnly | QIODevice::Append | QFile::Text);
+    }
+
+    void syncToDisk() {
+        if (!file.isOpen()) return;
+#ifdef Q_OS_WIN
+        _commit(file.handle());
+#else
+        fsync(file.handle());
+#endif
+    }
+
+    void run() {
+        QElapsedTimer sinceSync;
+        sinceSync.start();
+        while (!stopping) {
+            QThread::msleep(writePeriod_ms);
+            QMutexLocker lock(&writing);
+            writeQueued();
+            if (sinceSync.elapsed() > syncPeriod_ms) {
+                syncToDisk();
+                sinceSync.restart();
+            }
+        }
+        QMutexLocker lock(&writing);
+        writeQueued();
+        QByteArray batch;
+        reportRepeats(batch, QDateTime::currentMSecsSinceEpoch());
+        file.write(batch);
+        file.flush();
+        syncToDisk();
+    }
+
+public:
+    Logger(QString fileName, bool timestamps = true, qint64 maxSize_bytes = 16 << 20): file(fileName), withTimestamps(timestamps), maxSize(maxSize_bytes) {
+        file.open(QFile::WriteOnly | QIODevice::Append | QFile::Text);
+        writer = QThread::create([=]() { run(); });
+        writer->setObjectName("Logger");
+        writer->start(QThread::LowPriority);
+    }
+
+    ~Logger() { //everything queued before is written
+        if (messageLog == this) {
+            qInstallMessageHandler(nullptr);
+            messageLog = nullptr;
+        }
+        stopping = true;
+        writer->wait();
+        delete writer;
+        file.close();
+    }
+
+    void write(QString text) {
+        if (!queue.push(Entry {QDateTime::currentMSecsSinceEpoch(), std::move(text)})) ++nDropped;
+    }
+
+    void flush() { //queued messages are written and synced now, from the calling thread
+        if (!writing.tryLock(1000)) return; //qFatal() from inside the writer thread
+        writeQueued();
+        syncToDisk();
+        writing.unlock();
+    }
+
+    void installAsMessageHandler() { //qDebug() and the like go to this log
+        messageLog = this;
+        qInstallMessageHandler([](QtMsgType type, const QMessageLogContext &, const QString &msg) {
+            if (!messageLog) return;
+            messageLog->write(msg);
+            if (type == QtFatalMsg) messageLog->flush(); //Qt aborts right after the handler returns
+        });
+    }
+};
+
+#endif // LOGGER_H
@@ -2,7 +2,7 @@
 #define PM_H
 
 #include "FITboardsCommon.h"
-const QHash<QString, Parameter> PMparameters = {
+inline constexpr ParameterMap PMparameters({
     //name                  address width shift interval
     {"OR_GATE"              , {0x00,  8,  0}      },
     {"PairedChannelsMode"   , {0x00,  1,  8}      },
@@ -19,7 +19,7 @@ const QHash<QString, Parameter> PMparameters = {
     {"ADC_ZERO"             , {0x82, 32,  0,    4}},
     {"ADC_DELAY"            , {0x83, 32,  0,    4}},
     {"THRESHOLD_CALIBR"     , {0xB0, 32,  0,    1}}
-};
+});
 
 struct TypePM {
     struct ActualValues{
@@ -93,12 +93,20 @@ struct TypePM {
                 voltage1_8;             //]FE
         Timestamp FW_TIME_FPGA;         //]FF
         quint32 *registers = (quint32 *)this;
+        ActualValues() = default;
+        ActualValues(const ActualValues &other) { *this = other; }
+        ActualValues &operator=(const ActualValues &other) { memcpy((void *)this, &other, sizeof(ActualValues)); registers = (quint32 *)this; return *this; } //registers of a copy point to the copy itself
         static const inline QVector<regblock> regblocks {{0x00, 0x7D}, //block0     , 126 registers
                                                          {0x7F, 0xBE}, //block1     ,  64 registers
                                                          {0xD8, 0xE4}, //GBTcontrol ,  13 registers
                                                          {0xE8, 0xF1}, //GBTstatus  ,  10 registers
                                                          {0xF7, 0xF7}, //FW_TIME_MCU
                                                          {0xFC, 0xFF}};//block2     ,   4 registers
+        static const inline QVector<regblock> pollingRegblocks[3] { //volatile registers by polling class, see FITelectronics::PollingClass
+            {{0x7D, 0x7D}, {0x7F, 0x7F}, {0xBE, 0xBE}, {0xE8, 0xF1}}, //link status: CH_BASELINES_NOK, status, restart reason (for BOARDS_OK), GBTstatus; reserved 0x7E is skipped
+            {{0x0D, 0x24}, {0x3E, 0x7B}},                             //values: ADC_BASELINE, TDC, RMS, MEANAMPL
+            {{0xBC, 0xBD}, {0xFC, 0xFE}}                              //temperatures, board type and voltages
+        };
         float //calculable values
             TEMP_BOARD = 20.0F,
             TEMP_FPGA  = 20.0F,
@@ -160,6 +168,9 @@ struct TypePM {
         GBTunit::ControlData GBT;       //]D8-E7
 
         quint32 *registers = (quint32 *)this;
+        Settings() = default;
+        Settings(const Settings &other) { *this = other; }
+        Settings &operator=(const Settings &other) { memcpy((void *)this, &other, sizeof(Settings)); registers = (quint32 *)this; return *this; } //as for ActualValues
         static const inline QVector<regblock> regblocks {{0x00, 0x0C}, //block0     , 13 registers
                                                          {0x25, 0x3D}, //block1     , 25 registers
                                                          {0x7C, 0x7C}, //CH_MASK_DATA
@@ -175,7 +186,7 @@ struct TypePM {
             number = 24,
             addressDirect   =  0xC0;
         quint32 FIFOload;
-        QDateTime newTime, oldTime = QDateTime::currentDateTime();
+        qint64 oldTime_ns = monotonicTime_ns();
         union {
             quint32 New[number] = {0};
             struct {
@@ -194,7 +205,7 @@ struct TypePM {
         GBTcounters GBT;
     } counters;
 
-    QList<DimService *> services;
+    QList<AdvancedDIMservice *> services;
     QList<DimCommand *> commands;
     quint16 FEEid;
     const quint16 baseAddress;
@@ -206,7 +217,7 @@ struct TypePM {
         earlyHeader     : 1 = 0;
     } errorsLogged;
 
-    bool isOK() { return
+    bool isStatusOK() { return //PM's own part of isOK()
          act.mainPLLlocked &&
          act.TDC1PLLlocked &&
          act.TDC2PLLlocked &&
@@ -214,22 +225,26 @@ struct TypePM {
         !act.TDC1syncError &&
         !act.TDC2syncError &&
         !act.TDC3syncError &&
-         TRGsync.linkOK    &&
-        !TRGsync.syncError &&
          act.restartReasonCode != 2 ; //not by PLL relock
     }
 
+    bool isOK() { return isStatusOK() && TRGsync.linkOK && !TRGsync.syncError; }
+
     bool GBTisOK() const { return
         act.GBT.isOK() &&
         act.GBTRxReady;
     }
 
     bool setParameter(QString parameterName, quint32 value, quint8 iCh = 0) {
-        if (!PMparameters.contains(parameterName)) return false;
-        Parameter par = PMparameters[parameterName];
+        const Parameter *found = PMparameters.find(parameterName);
+        if (found == nullptr) return false;
+        setParameter(*found, value, iCh);
+        return true;
+    }
+
+    void setParameter(const Parameter &par, quint32 value, quint8 iCh = 0) { //for parameters known at compile time
         quint32 &reg = set.registers[par.address + iCh * par.interval];
         reg = changeNbits(reg, par.bitwidth, par.bitshift, value);
-        return true;
     }
 
     TypePM(quint16 addr, const char *PMname, TRGsyncStatus &TRGsyncRef) : baseAddress(addr), name(PMname), TRGsync(TRGsyncRef) {}
@@ -143,6 +143,9 @@ struct TypeTCM {
         Timestamp FW_TIME_FPGA;       //]FF
 
         quint32 *registers = (quint32 *)this;
+        ActualValues() = default;
+        ActualValues(const ActualValues &other) { *this = other; }
+        ActualValues &operator=(const ActualValues &other) { memcpy((void *)this, &other, sizeof(ActualValues)); registers = (quint32 *)this; return *this; } //a copy (e.g. for the GUI) points to its own registers
         static const inline QVector<regblock> regblocks {{0x00, 0x20}, //block0     , 33 registers
                                                          {0x30, 0x3A}, //block1     , 11 registers
                                                          {0x50, 0x50}, //COUNTERS_UPD_RATE
@@ -151,6 +154,11 @@ struct TypeTCM {
                                                          {0xE8, 0xF1}, //GBTstatus  , 10 registers
                                                          {0xF7, 0xF7}, //FW_TIME_MCU
                                                          {0xFC, 0xFF}};//block3     ,  4 registers
+        static const inline QVector<regblock> pollingRegblocks[3] { //volatile registers by polling class, see FITelectronics::PollingClass
+            {{0x0F, 0x1A}, {0x30, 0x3A}, {0xE8, 0xF1}}, //link status: status, TRG_SYNC_A/C, sides status, GBTstatus
+            {{0x00, 0x0E}, {0x1B, 0x20}},               //values: delays, levels, laser, average times
+            {{0xFC, 0xFE}}                              //temperature and voltages
+        };
         float //calculable values
             TEMP_BOARD = 20.0F,
             TEMP_FPGA  = 20.0F,
@@ -278,6 +286,9 @@ struct TypeTCM {
         GBTunit::ControlData GBT;     //]D8-E7
 
         quint32 *registers = (quint32 *)this;
+        Settings() = default;
+        Settings(const Settings &other) { *this = other; }
+        Settings &operator=(const Settings &other) { memcpy((void *)this, &other, sizeof(Settings)); registers = (quint32 *)this; return *this; } //as for ActualValues
         static const inline QVector<regblock> regblocksToRead {{0x00, 0x04}, //block0     ,  5 registers
                                                                {0x08, 0x0E}, //block1     ,  7 registers
                                                                {0x1A, 0x1D}, //block2     ,  4 registers
@@ -309,7 +320,7 @@ struct TypeTCM {
             number = 15,
             addressDirect   =  0x70;
         quint32 FIFOload;
-        QDateTime newTime, oldTime = QDateTime::currentDateTime();
+        qint64 oldTime_ns = monotonicTime_ns();
         union {
             quint32 New[number] = {0};
             struct {
@@ -352,15 +363,19 @@ struct TypeTCM {
         act.GBTRxReady;
     }
 
-    QList<DimService *> services, staticServices;
+    QList<AdvancedDIMservice *> services;
+    QList<DimService *> staticServices;
     QList<DimCommand *> commands;
-    quint32 ORBIT_FILL_MASK[223];
+    quint32 ORBIT_FILL_MASK[223],
+            ORBIT_FILL_MASKconfirmed[223], //content of the hardware as read back after the last upload
+            ORBIT_FILL_MASKhash = 0;       //of ORBIT_FILL_MASKconfirmed
+    bool ORBIT_FILL_MASKisKnown = false;   //false until the first verified upload, after reconnection or reset
     struct { quint32
         BCsyncLostInRun : 1 = 0;
     } errorsLogged;
 };
 
-const QHash<QString, Parameter> TCMparameters = {
+inline constexpr ParameterMap TCMparameters({
     //name                  address width shift
     {"DELAY_A"              ,  0x00         },
     {"DELAY_C"              ,  0x01         },
@@ -408,7 +423,7 @@ const QHash<QString, Parameter> TCMparameters = {
     {"T1_ENABLED"           , {0x6A,  1, 11}},
     {"T3_MODE"              , {0x6A,  2, 12}},
     {"T3_ENABLED"           , {0x6A,  1, 14}}
-};
+});
 
 inline quint32 prepareSignature(quint32 sign) { return sign << 7 | (~sign & 0x7F); }
 
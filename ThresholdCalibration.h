@@ -0,0 +1,81 @@
+#ifndef THRESHOLDCALIBRATION_H
+#define THRESHOLDCALIBRATION_H
+
+#include <QtGlobal>
+#include <cmath>
+
+class ThresholdCalibration { //THRESHOLD_CALIBR search for all channels at once: every measured rate narrows the bracket, next value is interpolated in log(rate)
+public:
+    static const quint16 minThreshold = 0, maxThreshold = 4000;
+    static const quint32 minCounts = 25; //a rate is used once it's known to 20%, or the target rate would have given as many counts
+    struct Channel {
+        quint16 lo, hi, threshold;   //rate falls with threshold: rate(lo) > target > rate(hi)
+        float rateLo, rateHi;        //measured at lo and hi, -1 if not yet
+        quint32 counts;              //accumulated at the current threshold
+        double time_s;
+        quint8 nSteps;
+        bool converged;
+    } ch[20][12];
+    quint32 PMmask = 0; //PMs being calibrated, by link №
+    double target_Hz = 15;
+    bool running = false;
+
+    void start(double rate_Hz, quint32 mask, const quint32 (*thresholds)[12]) { //starting from the current thresholds
+        target_Hz = rate_Hz;
+        PMmask = mask;
+        for (quint8 iPM=0; iPM<20; ++iPM) for (quint8 iCh=0; iCh<12; ++iCh) ch[iPM][iCh] = {minThreshold, maxThreshold, quint16(qBound(minThreshold + 1, int(thresholds[iPM][iCh]), maxThreshold - 1)), -1, -1, 0, 0, 0, !(mask & 1 << iPM)};
+        running = PMmask != 0;
+    }
+
+    qint32 update(quint8 iPM, quint8 iCh, quint32 counts, double time_s) { //counts measured at the current threshold during time_s; returns the next threshold to write or -1 if nothing to change
+        Channel &c = ch[iPM][iCh];
+        if (c.converged || time_s <= 0) return -1;
+        c.counts += counts;
+        c.time_s += time_s;
+        if (c.counts < minCounts && c.time_s * target_Hz < minCounts) return -1; //measurement goes on at the same threshold
+        float rate_Hz = c.counts / c.time_s;
+        double tolerance_Hz = std::sqrt(target_Hz / c.time_s); //statistical error of the rate measured at the target
+        c.counts = 0;
+        c.time_s = 0;
+        ++c.nSteps;
+        if (std::abs(rate_Hz - target_Hz) <= tolerance_Hz) {
+            c.converged = true;
+            return -1;
+        }
+        if (rate_Hz > target_Hz) {
+            c.lo = c.threshold;
+            c.rateLo = rate_Hz;
+        } else {
+            c.hi = c.threshold;
+            c.rateHi = rate_Hz;
+        }
+        if (c.hi - c.lo <= 1) { //bracket is closed: the closer end is taken
+            c.converged = true;
+            quint16 best = c.rateHi < 0 || (c.rateLo >= 0 && c.rateLo - target_Hz < target_Hz - c.rateHi) ? c.lo : c.hi;
+            if (best == c.threshold) return -1;
+            return c.threshold = best;
+        }
+        double x = (c.lo + c.hi) / 2.;
+        if (c.rateLo >= 0 && c.rateHi >= 0) { //secant in log(rate), limited to keep the bracket shrinking
+            double l = std::log(c.rateLo + 1), h = std::log(c.rateHi + 1), t = std::log(target_Hz + 1);
+            if (l > h) x = qBound(c.lo + (c.hi - c.lo) / 8., c.lo + (c.hi - c.lo) * (l - t) / (l - h), c.hi - (c.hi - c.lo) / 8.);
+        }
+        return c.threshold = quint16(qBound(c.lo + 1, int(std::lround(x)), c.hi - 1));
+    }
+
+    quint16 nChannels() const { quint16 n = 0; for (quint8 iPM=0; iPM<20; ++iPM) if (PMmask & 1 << iPM) n += 12; return n; }
+
+    quint16 nConverged() const {
+        quint16 n = 0;
+        for (quint8 iPM=0; iPM<20; ++iPM) if (PMmask & 1 << iPM) for (quint8 iCh=0; iCh<12; ++iCh) n += ch[iPM][iCh].converged;
+        return n;
+    }
+
+    quint8 maxSteps() const {
+        quint8 n = 0;
+        for (quint8 iPM=0; iPM<20; ++iPM) if (PMmask & 1 << iPM) for (quint8 iCh=0; iCh<12; ++iCh) n = qMax(n, ch[iPM][iCh].nSteps);
+        return n;
+    }
+};
+
+#endif // THRESHOLDCALIBRATION_H
@@ -0,0 +1,88 @@
+#include "FITelectronics.h"
+#include "IPbusEmulator.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <algorithm>
+#include <limits>
+
+struct Timing { //durations of repeated calls
+    QVector<double> t_us;
+    template <class F> void measure(quint32 n, F f) {
+        QElapsedTimer t;
+        for (quint32 i=0; i<n; ++i) {
+            t.start();
+            f();
+            t_us.append(t.nsecsElapsed() / 1e3);
+        }
+        std::sort(t_us.begin(), t_us.end());
+    }
+    double mean() const { double s = 0; foreach (double t, t_us) s += t; return t_us.isEmpty() ? 0 : s / t_us.size(); }
+    double percentile(double q) const { return t_us.isEmpty() ? 0 : t_us[qMin(t_us.size() - 1, int(q * t_us.size()))]; }
+    void print(const char *name) const { printf("%-24s %6d calls   mean %9.1f   p50 %9.1f   p99 %9.1f   max %9.1f µs\n", name, t_us.size(), mean(), percentile(0.5), percentile(0.99), t_us.isEmpty() ? 0 : t_us.last()); }
+};
+
+int main(int argc, char *argv[]) //end-to-end timing of the engine against an emulated TCM with PMs on the loopback interface
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setOrganizationName("INR");
+    QCoreApplication::setApplicationName("ControlServerBench"); //own settings and log files, the real ones are untouched
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOptions({
+        {"latency", "emulated target latency, µs", "us", "0"},
+        {"loss", "packet loss probability in each direction", "p", "0"},
+        {"PMmask", "present PMs by link №, hex", "mask", "FFFFF"},
+        {"n", "iterations per measurement", "n", "1000"},
+    });
+    parser.process(a);
+    IPbusEmulator::Config c;
+    c.latency_us = parser.value("latency").toUInt();
+    c.loss = parser.value("loss").toDouble();
+    c.PMmask = parser.value("PMmask").toUInt(nullptr, 16);
+    c.countersFIFOfull = true;
+    quint32 n = qMax(1U, parser.value("n").toUInt());
+
+    IPbusEmulator target(c);
+    FITelectronics FEE(FT0, 50006, false); //no I/O thread: calls below are timed directly
+    QObject::connect(&FEE, &IPbusTarget::error, [](QString message, errorType) { fprintf(stderr, "%s\n", qPrintable(message)); });
+    FEE.IPaddress = "127.0.0.1";
+    FEE.reconnect();
+    if (!FEE.isOnline) {
+        fprintf(stderr, "emulated target is not responding\n");
+        return 1;
+    }
+    FEE.updateTimer->stop(); //started by reconnect()
+    printf("%d PMs, latency %u µs, loss %g\n", FEE.PM.size(), c.latency_us, c.loss);
+
+    Timing syncTime, countersTime, applyTime, applyDeltaTime;
+    FEE.stats.takeWindow();
+    syncTime.measure(n, [&]() { FEE.syncAll(); });
+    IPbusStats::Window w = FEE.stats.takeWindow();
+    syncTime.print("syncAll()");
+    printf("%-24s RTT p50 %.1f   p99 %.1f   max %.1f µs, %.0f packets/s\n", "", w.p50_us, w.p99_us, w.max_us, w.packetsPerSecond);
+
+    QElapsedTimer span;
+    FEE.stats.takeWindow();
+    span.start();
+    for (quint32 k=0; k<100; ++k) { //10 s of polling ticks at the configured periods, without waiting for them
+        for (quint8 i=0; i<FITelectronics::nPollingClasses; ++i) FEE.polling[i].due_ms = k % (FEE.polling[i].period_ms / FITelectronics::pollingTick_ms) ? std::numeric_limits<qint64>::max() : 0;
+        FEE.sync();
+    }
+    w = FEE.stats.takeWindow();
+    printf("%-24s %.0f packets/s of polling\n", "sync() ticks", w.packetsPerSecond * span.nsecsElapsed() / 1e9 / 10);
+
+    FEE.apply_COUNTERS_UPD_RATE(1); //the emulated FIFOs stay full
+    FEE.syncAll();
+    countersTime.measure(n, [&]() { FEE.readCountersFIFO(); });
+    w = FEE.stats.takeWindow();
+    countersTime.print("readCountersFIFO()");
+    printf("%-24s %.0f words/s\n", "", w.wordsPerSecond);
+
+    applyTime.measure(qMax(1U, n / 10), [&]() { FEE.applySettingsAll(); });
+    applyTime.print("applySettingsAll()");
+    applyDeltaTime.measure(qMax(1U, n / 10), [&]() { FEE.applySettingsAll(true); });
+    applyDeltaTime.print("applySettingsAll(delta)");
+
+    printf("timeouts %llu, retries %llu, stale responses %llu\n", FEE.stats.timeouts, FEE.stats.retries, FEE.stats.staleResponses);
+    return 0;
+}
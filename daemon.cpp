@@ -0,0 +1,40 @@
+#include "FITserver.h"
+#include <QCoreApplication>
+#include <QTimer>
+#include <csignal>
+
+static volatile std::sig_atomic_t stopRequested = 0; //set by SIGINT or SIGTERM
+
+int main(int argc, char *argv[]) //DIM-only server without GUI; "--all" serves every subdetector from this process
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setOrganizationName("INR");
+    QCoreApplication::setApplicationName("ControlServer"); //same settings and log files as the GUI version
+    QCoreApplication::setApplicationVersion("1.k");
+
+    Logger errorLog(QCoreApplication::applicationName() + ".errorlog", false);
+    errorLog.installAsMessageHandler();
+    std::signal(SIGINT , [](int) { stopRequested = 1; }); //only the flag is set in the handler, the event loop is left by the timer; settings are saved on exit
+    std::signal(SIGTERM, [](int) { stopRequested = 1; });
+    QTimer signalPoll;
+    QObject::connect(&signalPoll, &QTimer::timeout, &a, [&a]() { if (stopRequested) a.quit(); });
+    signalPoll.start(100);
+
+    if (a.arguments().contains("--all")) {
+        FITserver s;
+        return a.exec();
+    }
+    QSettings settings(QCoreApplication::applicationName() + ".ini", QSettings::IniFormat);
+    FITelectronics FEE(getSubdetectorTypeByName(settings.value("subdetector").toString()));
+    FEE.IPaddress = settings.value("IPaddress", FEE.IPaddress).toString();
+    FEE.fileRead(QCoreApplication::applicationName() + ".ini");
+    FEE.moveToIOthread();
+    FEE.post([&]() { FEE.reconnect(); });
+    int result = a.exec();
+    FEE.stopIOthread();
+    settings.setValue("IPaddress", FEE.IPaddress);
+    settings.setValue("subdetector", FIT[FEE.subdetector].name);
+    settings.sync();
+    FEE.fileWrite(QCoreApplication::applicationName() + ".ini");
+    return result;
+}
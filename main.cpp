@@ -1,22 +1,25 @@
 #include "mainwindow.h"
+#include "FITserver.h"
 #include <QApplication>
 
 
 int main(int argc, char *argv[])
 {
-    QApplication a(argc, argv);
+    bool headless = false; //"--headless": serve all subdetectors from one process without GUI
+    for (int i=1; i<argc; ++i) if (qstrcmp(argv[i], "--headless") == 0) headless = true;
+    QScopedPointer<QCoreApplication> a(headless ? new QCoreApplication(argc, argv) : new QApplication(argc, argv));
     QCoreApplication::setOrganizationName("INR");
     QCoreApplication::setApplicationName("ControlServer");
     QCoreApplication::setApplicationVersion("1.k");
 
-    qInstallMessageHandler([](QtMsgType, const QMessageLogContext &, const QString &msg) {
-        QFile el(QCoreApplication::applicationName() + ".errorlog");
-        el.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text);
-        el.write((msg.endsWith("\n") ? msg : msg + "\n").toUtf8());
-        el.close();
-    });
+    Logger errorLog(QCoreApplication::applicationName() + ".errorlog", false);
+    errorLog.installAsMessageHandler();
 
+    if (headless) {
+        FITserver s;
+        return a->exec();
+    }
     MainWindow w;
     w.show();
-    return a.exec();
+    return a->exec();
 }
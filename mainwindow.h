@@ -42,6 +42,7 @@ class MainWindow : public QMainWindow
     Q_OBJECT
     QSettings settings;
     FITelectronics FEE;
+    FITview view; //the GUI reads only this copy, FEE's own values belong to its I/O thread
     QPixmap
         Green0 = QPixmap(":/0G.png"), //OK
         Green1 = QPixmap(":/1G.png"), //OK
@@ -119,14 +120,18 @@ class MainWindow : public QMainWindow
 //    QRegExpValidator *uint8Validator  = new QRegExpValidator(QRegExp("[0-1]?[0-9]{1,2}|2[0-4][0-9]|25[0-5]"), this);
     bool ok, laserFreqIsEditing = false, laserIsShuttling = false;
     QTimer shuttleTimer;
+    QTimer refreshTimer; //GUI is redrawn at most at refreshRate_Hz whatever the hardware update rate
+    bool valuesPending = false, countersPending = false, countersInNextView = false;
+    QVector<quint32> shownRegisters; //register images as of the last redraw, unchanged values are not redrawn
     quint8 mode;
     quint32 value;
     int fontSize_px;
     double prevPhaseStep_ns = 25. / 2048; //value for 40. Mhz clock and production TCM; var is used to detect values change in case of clock source and/or TCM change
-    GBTunit *curGBTact = &FEE.TCM.act.GBT;
-    GBTunit::ControlData *curGBTset = &FEE.TCM.set.GBT;
-    GBTcounters *curGBTcnt = &FEE.TCM.counters.GBT;
+    GBTunit *curGBTact = &view.TCM.act.GBT;
+    GBTunit::ControlData *curGBTset = &FEE.TCM.set.GBT; //is only changed in the I/O thread, the GUI shows view's copy
+    GBTcounters *curGBTcnt = &view.TCM.counters.GBT;
     TypePM *curPM = FEE.allPMs;
+    FITview::PMview *curPMview = view.PM;
     quint16 curFEEid;
     inline bool isTCM() { return curFEEid == FEE.TCMid; } //is TCM selected
 
@@ -141,7 +146,7 @@ public:
         ui->labelTextADC0           ->setStyleSheet(neutralStyle);
         ui->labelTextADC1           ->setStyleSheet(neutralStyle);
     }
-    void highlightIfUnapplied(QLineEdit *edit) { edit->setStyleSheet(labelsBeforeLineEdits[edit]->text().remove("0x") == edit->displayText() ? lineEditStyle : highlightStyle); }
+    void highlightIfUnapplied(QLineEdit *edit) { showStyleSheet(edit, labelsBeforeLineEdits[edit]->text().remove("0x") == edit->displayText() ? lineEditStyle : highlightStyle); }
 
     explicit MainWindow(QWidget *parent = nullptr):
         QMainWindow(parent),
@@ -328,8 +333,8 @@ public:
         controlMenu->addAction(enableControls);
         controlMenu->addAction("Copy ALL actual values to settings", this, [=]() { FEE.copyActualToSettingsAll(); updateEdits(); });
         QAction *applyAll = controlMenu->addAction(QIcon(":/write.png"), "Apply ALL settings to FEE", &FEE, &FITelectronics::applySettingsAll);
-        QAction *resetAllPMsCount = controlMenu->addAction("Reset count in all PMs", this, [=]() { FEE.resetCounts(-2); });
-        QAction *resetAllBoardsCount = controlMenu->addAction("Reset count in all PMs and TCM", this, [=]() { FEE.resetCounts(-1); });
+        QAction *resetAllPMsCount = controlMenu->addAction("Reset count in all PMs", this, [=]() { FEE.post([=]() { FEE.resetCounts(-2); }); });
+        QAction *resetAllBoardsCount = controlMenu->addAction("Reset count in all PMs and TCM", this, [=]() { FEE.post([=]() { FEE.resetCounts(-1); }); });
         connect(enableControls, &QAction::triggered, this, [=](bool checked) {
             enableControls->setText(checked ? "Disable" : "Enable");
             foreach (QLineEdit        *e, allLineEdits   ) e->setEnabled(checked);
@@ -356,10 +361,11 @@ public:
             networkMenu->removeAction(enableDebugActions);
             QMenu *debugMenu = menuBar()->addMenu("&Debug");
             debugMenu->addAction("Adjust &PM treshholds", this, [=]() { //decrease thresholds to noise levels to see counting without signals
-                if (curFEEid == FEE.TCMid) QMessageBox::warning(this, "Warning", "This operation is not applicable for TCM!");
-                else FEE.adjustThresholds(curPM, QInputDialog::getDouble(this, "Adjusting " + ui->groupBoxPM->title() + " thresholds", "Set CFD hits target rate", 20, 1, 1e6, 0)); }
+                bool ok;
+                double rate = QInputDialog::getDouble(this, "Adjusting thresholds of all PMs", "Set CFD hits target rate", 20, 1, 1e6, 0, &ok);
+                if (ok) FEE.post([=]() { FEE.startThresholdCalibration(rate); }); }
             );
-            debugMenu->addAction("Randomize OrbitFillMask", this, [=]() { for (quint8 i=0; i<213; ++i) FEE.TCM.ORBIT_FILL_MASK[i] = QRandomGenerator::global()->generate(); FEE.apply_ORBIT_FILL_MASK(); });
+            debugMenu->addAction("Randomize OrbitFillMask", this, [=]() { FEE.post([=]() { for (quint8 i=0; i<213; ++i) FEE.TCM.ORBIT_FILL_MASK[i] = QRandomGenerator::global()->generate(); FEE.apply_ORBIT_FILL_MASK(); }); });
             QAction *shuttleLaser = new QAction("Start laser phase shuttling");
             connect(&shuttleTimer, &QTimer::timeout, this, [&]() {
                 qint16 start = FEE.shuttleStartPhase, end = -start;
@@ -369,12 +375,10 @@ public:
             connect(shuttleLaser, &QAction::triggered, this, [=]() {
                 if (laserIsShuttling) {
                     this->shuttleTimer.stop();
-                    this->FEE.shuttleTimer->stop();
-                    FEE.TCM.set.LASER_DELAY = this->settings.value("LASER_DELAY", FEE.TCM.set.LASER_DELAY).toInt();
+                    FEE.post([=, delay = this->settings.value("LASER_DELAY").toInt()]() { FEE.shuttleTimer->stop(); FEE.TCM.set.LASER_DELAY = delay; });
                 } else {
-                    this->settings.setValue("LASER_DELAY", FEE.TCM.set.LASER_DELAY);
-                    this->FEE.inverseLaserPhase();
-                    this->FEE.shuttleTimer->start(2100);
+                    this->settings.setValue("LASER_DELAY", view.TCM.set.LASER_DELAY);
+                    FEE.post([=]() { FEE.inverseLaserPhase(); FEE.shuttleTimer->start(2100); });
                     this->shuttleTimer.start(100);
                 }
                 this->laserIsShuttling = !this->laserIsShuttling;
@@ -397,7 +401,7 @@ public:
 //            highlightUnapplied->setIcon();
             if (checked) {
                 foreach (QLineEdit *edit, allLineEdits) connections.append(connect(edit, &QLineEdit::textChanged, [=]() { highlightIfUnapplied(edit); }));
-                connections.append(connect(&FEE, &FITelectronics::valuesReady, [=]() { foreach (QLineEdit *edit, allLineEdits) highlightIfUnapplied(edit); }));
+                foreach (QLineEdit *edit, allLineEdits) highlightIfUnapplied(edit); //further updates come from refresh()
             } else {
                 foreach(QMetaObject::Connection c, connections) disconnect(c);
                 connections.clear();
@@ -415,18 +419,19 @@ public:
             QString msg = FEE.IPaddress + ": " + message;
             if (FEE.updateTimer->isActive()) statusBar()->showMessage(statusBar()->currentMessage() == msg ? "" : msg);
         });
-        connect(&FEE, &FITelectronics::valuesReady, this, [=]() {
-            QString msg = FEE.IPaddress + ": online";
-            if (FEE.updateTimer->isActive()) statusBar()->showMessage(statusBar()->currentMessage() == msg ? "" : msg);
-            updateActualValues();
-            if (!enableControls->isChecked()) updateEdits();
+        connect(&FEE, &FITelectronics::valuesReady, this, [=](const FITview &v) {
+            view = v;
+            valuesPending = true;
+            if (countersInNextView) { countersInNextView = false; countersPending = true; }
         });
         connect(&FEE, &IPbusTarget::error, this, [=](QString message, errorType et) {
 //            QMessageBox::warning(this, errorTypeName[et], message);
             ui->centralWidget->setDisabled(true);
             statusBar()->showMessage(message + " (" + errorTypeName[et] + ")");
         });
-        connect(&FEE, &FITelectronics::countersReady, this, &MainWindow::updateCounters);
+        connect(&FEE, &FITelectronics::countersReady, this, [=](quint16 FEEid) { if (FEEid == curFEEid) countersInNextView = true; }); //they are shown from the view published after them
+        connect(&refreshTimer, &QTimer::timeout, this, &MainWindow::refresh);
+        refreshTimer.start(1000 / qBound(1, settings.value("refreshRate_Hz", 10).toInt(), 50));
         foreach (QLineEdit *edit, ui->centralWidget->findChildren<QLineEdit *>()) {
             ActualLabel *label = ui->centralWidget->findChild<ActualLabel *>(edit->objectName().replace("lineEdit", "labelValue"));
             if (label != nullptr) {
@@ -454,29 +459,22 @@ public:
 //            QLineEdit *e = ui->centralWidget->findChild<QLineEdit *>(label->objectName().replace("labelValue", "lineEdit"));
 //            if (e != nullptr) connect(label, &ActualLabel::doubleclicked, [=](QString text) { e->setText( text.right(e->maxLength()) ); emit e->textEdited(text); });
 //        }
-        connect(&FEE, &FITelectronics::linksStatusReady, this, [=]() { //disable PMs' selectors and link indicators if no physical link present
-            //if (!isTCM() && !FEE.PM.contains(curPM->FEEid)) ui->TCM_selector->toggle();
-            for (quint8 i=0; i<=9; ++i) {
-                selectorsPMA[i]->setEnabled(FEE.PM.contains(FEE.allPMs[i   ].FEEid));
-                selectorsPMC[i]->setEnabled(FEE.PM.contains(FEE.allPMs[i+10].FEEid));
-            }
-        });
         for (quint8 i=0; i<=9; ++i) { //PM switchers and selectors
-            connect(switchesPMA[i], QOverload<bool>::of(&QPushButton::clicked), this, [=](bool checked) { FEE.switchTRGsyncPM(i     , !checked); });
-            connect(switchesPMC[i], QOverload<bool>::of(&QPushButton::clicked), this, [=](bool checked) { FEE.switchTRGsyncPM(i + 10, !checked); });
-            connect(selectorsPMA[i], QOverload<bool>::of(&QPushButton::clicked), this, [=](bool checked) { if (checked) selectPM((FEE.allPMs + i     )->FEEid); });
-            connect(selectorsPMC[i], QOverload<bool>::of(&QPushButton::clicked), this, [=](bool checked) { if (checked) selectPM((FEE.allPMs + i + 10)->FEEid); });
+            connect(switchesPMA[i], QOverload<bool>::of(&QPushButton::clicked), this, [=](bool checked) { FEE.post([=]() { FEE.switchTRGsyncPM(i     , !checked); }); });
+            connect(switchesPMC[i], QOverload<bool>::of(&QPushButton::clicked), this, [=](bool checked) { FEE.post([=]() { FEE.switchTRGsyncPM(i + 10, !checked); }); });
+            connect(selectorsPMA[i], QOverload<bool>::of(&QPushButton::clicked), this, [=](bool checked) { if (checked) selectPM(i     ); });
+            connect(selectorsPMC[i], QOverload<bool>::of(&QPushButton::clicked), this, [=](bool checked) { if (checked) selectPM(i + 10); });
         }
 
         for (quint8 i=0; i<12; ++i) { //channels
-            connect(editsTimeAlignmentCh  [i], &QLineEdit::textEdited, this, [=](QString text) { curPM->set.TIME_ALIGN[i].value = text. toInt(); resetHighlight(); ui->labelTextTimeAlignment  ->setStyleSheet(highlightStyle); });
-            connect(editsThresholdCalibrCh[i], &QLineEdit::textEdited, this, [=](QString text) { curPM->set.THRESHOLD_CALIBR[i] = text.toUInt(); resetHighlight(); ui->labelTextThresholdCalibr->setStyleSheet(highlightStyle); });
-            connect(editsADCdelayCh       [i], &QLineEdit::textEdited, this, [=](QString text) { curPM->set.Ch[i].ADC_DELAY     = text.toUInt(); resetHighlight(); ui->labelTextADCdelay       ->setStyleSheet(highlightStyle); });
-            connect(editsCFDthresholdCh   [i], &QLineEdit::textEdited, this, [=](QString text) { curPM->set.Ch[i].CFD_THRESHOLD = text.toUInt(); resetHighlight(); ui->labelTextCFDthreshold   ->setStyleSheet(highlightStyle); });
-            connect(editsADCzeroCh        [i], &QLineEdit::textEdited, this, [=](QString text) { curPM->set.Ch[i].ADC_ZERO      = text. toInt(); resetHighlight(); ui->labelTextADCzero        ->setStyleSheet(highlightStyle); });
-            connect(editsCFDzeroCh        [i], &QLineEdit::textEdited, this, [=](QString text) { curPM->set.Ch[i].CFD_ZERO      = text. toInt(); resetHighlight(); ui->labelTextCFDzero        ->setStyleSheet(highlightStyle); });
-            connect(editsADC0rangeCh      [i], &QLineEdit::textEdited, this, [=](QString text) { curPM->set.ADC_RANGE    [i][0] = text.toUInt(); resetHighlight(); ui->labelTextADC0           ->setStyleSheet(highlightStyle); });
-            connect(editsADC1rangeCh      [i], &QLineEdit::textEdited, this, [=](QString text) { curPM->set.ADC_RANGE    [i][1] = text.toUInt(); resetHighlight(); ui->labelTextADC1           ->setStyleSheet(highlightStyle); });
+            connect(editsTimeAlignmentCh  [i], &QLineEdit::textEdited, this, [=](QString text) { FEE.post([=, pm = curPM, v = text. toInt()]() { pm->set.TIME_ALIGN[i].value = v; }); resetHighlight(); ui->labelTextTimeAlignment  ->setStyleSheet(highlightStyle); });
+            connect(editsThresholdCalibrCh[i], &QLineEdit::textEdited, this, [=](QString text) { FEE.post([=, pm = curPM, v = text.toUInt()]() { pm->set.THRESHOLD_CALIBR[i] = v; }); resetHighlight(); ui->labelTextThresholdCalibr->setStyleSheet(highlightStyle); });
+            connect(editsADCdelayCh       [i], &QLineEdit::textEdited, this, [=](QString text) { FEE.post([=, pm = curPM, v = text.toUInt()]() { pm->set.Ch[i].ADC_DELAY = v; }); resetHighlight(); ui->labelTextADCdelay       ->setStyleSheet(highlightStyle); });
+            connect(editsCFDthresholdCh   [i], &QLineEdit::textEdited, this, [=](QString text) { FEE.post([=, pm = curPM, v = text.toUInt()]() { pm->set.Ch[i].CFD_THRESHOLD = v; }); resetHighlight(); ui->labelTextCFDthreshold   ->setStyleSheet(highlightStyle); });
+            connect(editsADCzeroCh        [i], &QLineEdit::textEdited, this, [=](QString text) { FEE.post([=, pm = curPM, v = text. toInt()]() { pm->set.Ch[i].ADC_ZERO = v; }); resetHighlight(); ui->labelTextADCzero        ->setStyleSheet(highlightStyle); });
+            connect(editsCFDzeroCh        [i], &QLineEdit::textEdited, this, [=](QString text) { FEE.post([=, pm = curPM, v = text. toInt()]() { pm->set.Ch[i].CFD_ZERO = v; }); resetHighlight(); ui->labelTextCFDzero        ->setStyleSheet(highlightStyle); });
+            connect(editsADC0rangeCh      [i], &QLineEdit::textEdited, this, [=](QString text) { FEE.post([=, pm = curPM, v = text.toUInt()]() { pm->set.ADC_RANGE    [i][0] = v; }); resetHighlight(); ui->labelTextADC0           ->setStyleSheet(highlightStyle); });
+            connect(editsADC1rangeCh      [i], &QLineEdit::textEdited, this, [=](QString text) { FEE.post([=, pm = curPM, v = text.toUInt()]() { pm->set.ADC_RANGE    [i][1] = v; }); resetHighlight(); ui->labelTextADC1           ->setStyleSheet(highlightStyle); });
 
             connect(editsTimeAlignmentCh  [i], &QLineEdit::cursorPositionChanged, this, [=]() { resetHighlight(); ui->labelTextTimeAlignment  ->setStyleSheet(highlightStyle); });
             connect(editsThresholdCalibrCh[i], &QLineEdit::cursorPositionChanged, this, [=]() { resetHighlight(); ui->labelTextThresholdCalibr->setStyleSheet(highlightStyle); });
@@ -495,20 +493,23 @@ public:
             connect(editsADC0rangeCh      [i], &QLineEdit::editingFinished      , this, [=]() { resetHighlight(); });
             connect(editsADC1rangeCh      [i], &QLineEdit::editingFinished      , this, [=]() { resetHighlight(); });
 
-            connect(buttonsTimeAlignmentCh  [i], &QPushButton::clicked, this, [=] { curPM->set.TIME_ALIGN[i].value = editsTimeAlignmentCh  [i]->text(). toInt(); FEE.apply_TIME_ALIGN      (curFEEid, i+1); });
-            connect(buttonsThresholdCalibrCh[i], &QPushButton::clicked, this, [=] { curPM->set.THRESHOLD_CALIBR[i] = editsThresholdCalibrCh[i]->text().toUInt(); FEE.apply_THRESHOLD_CALIBR(curFEEid, i+1); });
-            connect(buttonsADCdelayCh       [i], &QPushButton::clicked, this, [=] { curPM->set.Ch[i].ADC_DELAY     = editsADCdelayCh       [i]->text().toUInt(); FEE.apply_ADC_DELAY       (curFEEid, i+1); });
-            connect(buttonsCFDthresholdCh   [i], &QPushButton::clicked, this, [=] { curPM->set.Ch[i].CFD_THRESHOLD = editsCFDthresholdCh   [i]->text().toUInt(); FEE.apply_CFD_THRESHOLD   (curFEEid, i+1); });
-            connect(buttonsADCzeroCh        [i], &QPushButton::clicked, this, [=] { curPM->set.Ch[i].ADC_ZERO      = editsADCzeroCh        [i]->text(). toInt(); FEE.apply_ADC_ZERO        (curFEEid, i+1); });
-            connect(buttonsCFDzeroCh        [i], &QPushButton::clicked, this, [=] { curPM->set.Ch[i].CFD_ZERO      = editsCFDzeroCh        [i]->text(). toInt(); FEE.apply_CFD_ZERO        (curFEEid, i+1); });
-            connect(buttonsADC0rangeCh      [i], &QPushButton::clicked, this, [=] { curPM->set.ADC_RANGE    [i][0] = editsADC0rangeCh      [i]->text().toUInt(); FEE.apply_ADC0_RANGE      (curFEEid, i+1); });
-            connect(buttonsADC1rangeCh      [i], &QPushButton::clicked, this, [=] { curPM->set.ADC_RANGE    [i][1] = editsADC1rangeCh      [i]->text().toUInt(); FEE.apply_ADC1_RANGE      (curFEEid, i+1); });
+            connect(buttonsTimeAlignmentCh  [i], &QPushButton::clicked, this, [=] { FEE.post([=, pm = curPM, FEEid = curFEEid, v = editsTimeAlignmentCh  [i]->text(). toInt()]() { pm->set.TIME_ALIGN[i].value = v; FEE.apply_TIME_ALIGN      (FEEid, i+1); }); });
+            connect(buttonsThresholdCalibrCh[i], &QPushButton::clicked, this, [=] { FEE.post([=, pm = curPM, FEEid = curFEEid, v = editsThresholdCalibrCh[i]->text().toUInt()]() { pm->set.THRESHOLD_CALIBR[i] = v; FEE.apply_THRESHOLD_CALIBR(FEEid, i+1); }); });
+            connect(buttonsADCdelayCh       [i], &QPushButton::clicked, this, [=] { FEE.post([=, pm = curPM, FEEid = curFEEid, v = editsADCdelayCh       [i]->text().toUInt()]() { pm->set.Ch[i].ADC_DELAY = v; FEE.apply_ADC_DELAY       (FEEid, i+1); }); });
+            connect(buttonsCFDthresholdCh   [i], &QPushButton::clicked, this, [=] { FEE.post([=, pm = curPM, FEEid = curFEEid, v = editsCFDthresholdCh   [i]->text().toUInt()]() { pm->set.Ch[i].CFD_THRESHOLD = v; FEE.apply_CFD_THRESHOLD   (FEEid, i+1); }); });
+            connect(buttonsADCzeroCh        [i], &QPushButton::clicked, this, [=] { FEE.post([=, pm = curPM, FEEid = curFEEid, v = editsADCzeroCh        [i]->text(). toInt()]() { pm->set.Ch[i].ADC_ZERO = v; FEE.apply_ADC_ZERO        (FEEid, i+1); }); });
+            connect(buttonsCFDzeroCh        [i], &QPushButton::clicked, this, [=] { FEE.post([=, pm = curPM, FEEid = curFEEid, v = editsCFDzeroCh        [i]->text(). toInt()]() { pm->set.Ch[i].CFD_ZERO = v; FEE.apply_CFD_ZERO        (FEEid, i+1); }); });
+            connect(buttonsADC0rangeCh      [i], &QPushButton::clicked, this, [=] { FEE.post([=, pm = curPM, FEEid = curFEEid, v = editsADC0rangeCh      [i]->text().toUInt()]() { pm->set.ADC_RANGE    [i][0] = v; FEE.apply_ADC0_RANGE      (FEEid, i+1); }); });
+            connect(buttonsADC1rangeCh      [i], &QPushButton::clicked, this, [=] { FEE.post([=, pm = curPM, FEEid = curFEEid, v = editsADC1rangeCh      [i]->text().toUInt()]() { pm->set.ADC_RANGE    [i][1] = v; FEE.apply_ADC1_RANGE      (FEEid, i+1); }); });
 
-            connect(switchesCh[i], &Switch         ::clicked, this, [=](bool checked) { FEE.switchPMchannel     (curPM - FEE.allPMs, i + 1, !checked); });
-            connect(noTRGCh   [i], &QAbstractButton::clicked, this, [=](bool checked) { FEE.apply_PMchannelNoTRG(curPM - FEE.allPMs, i + 1,  checked); });
+            connect(switchesCh[i], &Switch         ::clicked, this, [=](bool checked) { FEE.post([=, pm = curPM]() { FEE.switchPMchannel     (pm - FEE.allPMs, i + 1, !checked); }); });
+            connect(noTRGCh   [i], &QAbstractButton::clicked, this, [=](bool checked) { FEE.post([=, pm = curPM]() { FEE.apply_PMchannelNoTRG(pm - FEE.allPMs, i + 1,  checked); }); });
         }
         for (quint8 i=0; i<64; ++i) { //laser pattern bits switching
-            connect(switchBitButtons[i], &QPushButton::clicked, this, [=](bool checked) { FEE.apply_SwLaserPatternBit(i, checked); ui->lineEditLaserPattern->setText(QString::asprintf("%016llX", FEE.TCM.set.LASER_PATTERN)); });
+            connect(switchBitButtons[i], &QPushButton::clicked, this, [=](bool checked) { FEE.post([=]() { FEE.apply_SwLaserPatternBit(i, checked); });
+                quint64 pattern = ui->lineEditLaserPattern->text().toULongLong(&ok, 16); //the edit shows the settings, which are changed in the I/O thread
+                ui->lineEditLaserPattern->setText(QString::asprintf("%016llX", checked ? pattern | 1ULL << i : pattern & ~(1ULL << i)));
+            });
         }
 //validators
         ui->lineEditLaserFrequency->setValidator(doubleValidator);
@@ -534,8 +535,10 @@ public:
         QString IPaddress = settings.value("IPaddress", FEE.IPaddress).toString();
         if (validIPaddressRE.exactMatch(IPaddress)) FEE.IPaddress = IPaddress;
         FEE.fileRead(QCoreApplication::applicationName() + ".ini");
+        FEE.publishView(); //still in this thread
         updateEdits();
-        FEE.reconnect();
+        FEE.moveToIOthread();
+        FEE.post([=]() { FEE.reconnect(); });
         resetHighlight();
         enableControls->setChecked(true);
         if (settings.value("highlightUnappliedSettings", 1).toInt()) {
@@ -549,6 +552,9 @@ public:
         settings.setValue("IPaddress", FEE.IPaddress);
         settings.setValue("subdetector", FIT[FEE.subdetector].name);
         settings.setValue("highlightUnappliedSettings", highlightUnapplied->isChecked() ? 1 : 0);
+        settings.setValue("refreshRate_Hz", 1000 / refreshTimer.interval());
+        refreshTimer.stop();
+        FEE.stopIOthread();
         FEE.fileWrite(QCoreApplication::applicationName() + ".ini");
         delete ui;
     }
@@ -561,9 +567,12 @@ public slots:
         if (dialog.exec() != QDialog::Accepted)
             statusBar()->showMessage("File not loaded");
         else {
-            FEE.fileRead(dialog.selectedFiles().constFirst(), doApply);
-            updateEdits();
-            if (!doApply) statusBar()->showMessage("File loaded");
+            QString fileName = dialog.selectedFiles().constFirst();
+            FEE.post([=]() {
+                FEE.fileRead(fileName, doApply);
+                FEE.publishView();
+                QMetaObject::invokeMethod(this, [=]() { updateEdits(); if (!doApply) statusBar()->showMessage("File loaded"); });
+            });
         }
     }
 
@@ -574,67 +583,123 @@ public slots:
         if (dialog.exec() != QDialog::Accepted)
             statusBar()->showMessage("File not saved");
         else {
-            FEE.fileWrite(dialog.selectedFiles().constFirst());
-            statusBar()->showMessage("File saved");
+            QString fileName = dialog.selectedFiles().constFirst();
+            FEE.post([=]() {
+                FEE.fileWrite(fileName);
+                QMetaObject::invokeMethod(this, [=]() { statusBar()->showMessage("File saved"); });
+            });
         }
     }
 
     void recheckTarget() {
         statusBar()->showMessage(FEE.IPaddress + ": status requested...");
-        if (FEE.countersTimer->isActive()) FEE.countersTimer->stop();
-        FEE.reconnect();
+        FEE.post([=]() {
+            if (FEE.countersTimer->isActive()) FEE.countersTimer->stop();
+            FEE.reconnect();
+        });
     }
 
     void changeIP() {
         QString text = QInputDialog::getText(this, "Changing target", "Enter new target's IP address", QLineEdit::Normal, FEE.IPaddress, &ok);
         if (ok && !text.isEmpty()) {
             if (validIPaddressRE.exactMatch(text)) {
-                FEE.IPaddress = text;
-                FEE.reconnect();
+                FEE.post([=]() {
+                    FEE.IPaddress = text;
+                    FEE.reconnect();
+                });
             } else QMessageBox::warning(this, "Warning", text + ": invalid IP address. Continue with previous target");
         }
     }
 
+    void refresh() { //coalesces all hardware updates since the previous frame
+        if (!isVisible() || isMinimized()) return; //pending updates are kept until the window is shown
+        if (valuesPending) {
+            valuesPending = false;
+            QString msg = FEE.IPaddress + ": online";
+            if (FEE.updateTimer->isActive()) statusBar()->showMessage(statusBar()->currentMessage() == msg ? "" : msg);
+            if (registersChanged()) {
+                updateActualValues();
+                if (!enableControls->isChecked()) updateEdits();
+                if (highlightUnapplied->isChecked()) foreach (QLineEdit *edit, allLineEdits) highlightIfUnapplied(edit);
+            }
+        }
+        if (countersPending) {
+            countersPending = false;
+            updateCounters(curFEEid);
+        }
+    }
+
+    bool registersChanged() { //values shown in the actual column: TCM, the selected PM and all PMs' link status and TCM-view parameters; widgets are then updated one by one only if their value differs
+        const quint16 nAct = 0x100, nSet = 0xE8; //settings end with GBT control block
+        QVector<quint32> image(3 + 20 * 4 + (isTCM() ? 1 : 2) * (nAct + nSet));
+        quint32 *p = image.data();
+        *p++ = view.BOARDS_OK;
+        *p++ = view.PMpresent;
+        *p++ = curFEEid;
+        for (quint8 i=0; i<20; ++i) {
+            FITview::PMview &pm = view.PM[i];
+            *p++ = pm.isOK | pm.GBTisOK << 1;
+            *p++ = pm.act.OR_GATE;
+            *p++ = pm.act.TRGchargeLevelHi;
+            *p++ = pm.act.TRGchargeLevelLo;
+        }
+        memcpy(p, view.TCM.act.registers, nAct * sizeof(quint32)); p += nAct;
+        memcpy(p, view.TCM.set.registers, nSet * sizeof(quint32)); p += nSet;
+        if (!isTCM()) {
+            memcpy(p, curPMview->act.registers, nAct * sizeof(quint32)); p += nAct;
+            memcpy(p, curPMview->set.registers, nSet * sizeof(quint32));
+        }
+        if (image == shownRegisters) return false;
+        shownRegisters = image;
+        return true;
+    }
+
+    template <class W> static void showText(W *w, const QString &text) { if (w->text() != text) w->setText(text); } //unchanged widgets are not relaid out nor repainted
+    static void showPixmap(QLabel *l, const QPixmap &pixmap) { if (l->pixmap() == nullptr || l->pixmap()->cacheKey() != pixmap.cacheKey()) l->setPixmap(pixmap); }
+    static void showStyleSheet(QWidget *w, const QString &style) { if (w->styleSheet() != style) w->setStyleSheet(style); } //each setStyleSheet() repolishes the widget
+
     void updateActualValues() {
         for (quint8 i=0; i<=9; ++i) {
-            linksPMA[i]->setPixmap(FEE.allPMs[i   ].isOK() ? (FEE.allPMs[i   ].GBTisOK() ? Green1 : Red0) : RedDash); switchesPMA[i]->setChecked(FEE.TCM.act.CH_MASK_A & (1 << i));
-            linksPMC[i]->setPixmap(FEE.allPMs[i+10].isOK() ? (FEE.allPMs[i+10].GBTisOK() ? Green1 : Red0) : RedDash); switchesPMC[i]->setChecked(FEE.TCM.act.CH_MASK_C & (1 << i));
+            showPixmap(linksPMA[i], view.PM[i   ].isOK ? (view.PM[i   ].GBTisOK ? Green1 : Red0) : RedDash); switchesPMA[i]->setChecked(view.TCM.act.CH_MASK_A & (1 << i));
+            showPixmap(linksPMC[i], view.PM[i+10].isOK ? (view.PM[i+10].GBTisOK ? Green1 : Red0) : RedDash); switchesPMC[i]->setChecked(view.TCM.act.CH_MASK_C & (1 << i));
+            selectorsPMA[i]->setEnabled(view.PMpresent & 1 << i       ); //no physical link
+            selectorsPMC[i]->setEnabled(view.PMpresent & 1 << (i + 10));
         }
-        ui->labelIconSystemRestarted->setPixmap(FEE.TCM.act.systemRestarted ? Red1 : Green0);
-        ui->labelIconSystemRestarting->setPixmap(FEE.TCM.act.resetSystem ? Red1 : Green0);
-        ui->TCM_selector->setStyleSheet(FEE.TCM.isOK() && FEE.TCM.GBTisOK() ? "" : notOKstyle);
-        ui->labelIconSystemErrors->setPixmap(~FEE.BOARDS_OK & (1<<20 | FEE.TCM.act.PM_MASK_TRG()) ? Red1 : Green0);
-        ui->labelValueClockSource->setText(FEE.TCM.act.externalClock ? "external" : (FEE.TCM.act.forceLocalClock ? "force local" : "local"));
-        ui->labelValueClockSource->setStyleSheet(FEE.TCM.act.externalClock ? OKstyle : (FEE.TCM.act.forceLocalClock ? neutralStyle : notOKstyle));
+        showPixmap(ui->labelIconSystemRestarted, view.TCM.act.systemRestarted ? Red1 : Green0);
+        showPixmap(ui->labelIconSystemRestarting, view.TCM.act.resetSystem ? Red1 : Green0);
+        showStyleSheet(ui->TCM_selector, view.TCM.isOK && view.TCM.GBTisOK ? "" : notOKstyle);
+        showPixmap(ui->labelIconSystemErrors, ~view.BOARDS_OK & (1<<20 | view.TCM.act.PM_MASK_TRG()) ? Red1 : Green0);
+        showText(ui->labelValueClockSource, view.TCM.act.externalClock ? "external" : (view.TCM.act.forceLocalClock ? "force local" : "local"));
+        showStyleSheet(ui->labelValueClockSource, view.TCM.act.externalClock ? OKstyle : (view.TCM.act.forceLocalClock ? neutralStyle : notOKstyle));
         double
-            curTemp_board   = isTCM() ? FEE.TCM.act.TEMP_BOARD    : curPM->act.TEMP_BOARD,
-            curTemp_FPGA    = isTCM() ? FEE.TCM.act.TEMP_FPGA     : curPM->act.TEMP_FPGA ,
-            curVoltage_1V   = isTCM() ? FEE.TCM.act.VOLTAGE_1V    : curPM->act.VOLTAGE_1V,
-            curVoltage_1_8V = isTCM() ? FEE.TCM.act.VOLTAGE_1_8V  : curPM->act.VOLTAGE_1_8V;
-        ui->labelValueBoardTemperature->setText(QString::asprintf("%4.1f°C", curTemp_board   ));
-        ui->labelValueFPGAtemperature ->setText(QString::asprintf("%5.1f°C", curTemp_FPGA    ));
-        ui->labelValueVoltage1V       ->setText(QString::asprintf("%5.3f V", curVoltage_1V   ));
-        ui->labelValueVoltage1_8V     ->setText(QString::asprintf("%5.3f V", curVoltage_1_8V ));
-        ui->labelValueBoardTemperature->setStyleSheet(fabs(curTemp_board      - 35) > 25  ? notOKstyle : neutralStyle);
-        ui->labelValueFPGAtemperature ->setStyleSheet(fabs(curTemp_FPGA       - 35) > 25  ? notOKstyle : neutralStyle);
-        ui->labelValueVoltage1V       ->setStyleSheet(fabs(curVoltage_1V  /1.0 - 1) > 0.2 ? notOKstyle : neutralStyle);
-        ui->labelValueVoltage1_8V     ->setStyleSheet(fabs(curVoltage_1_8V/1.8 - 1) > 0.2 ? notOKstyle : neutralStyle);
+            curTemp_board   = isTCM() ? view.TCM.act.TEMP_BOARD    : curPMview->act.TEMP_BOARD,
+            curTemp_FPGA    = isTCM() ? view.TCM.act.TEMP_FPGA     : curPMview->act.TEMP_FPGA ,
+            curVoltage_1V   = isTCM() ? view.TCM.act.VOLTAGE_1V    : curPMview->act.VOLTAGE_1V,
+            curVoltage_1_8V = isTCM() ? view.TCM.act.VOLTAGE_1_8V  : curPMview->act.VOLTAGE_1_8V;
+        showText(ui->labelValueBoardTemperature, QString::asprintf("%4.1f°C", curTemp_board   ));
+        showText(ui->labelValueFPGAtemperature , QString::asprintf("%5.1f°C", curTemp_FPGA    ));
+        showText(ui->labelValueVoltage1V       , QString::asprintf("%5.3f V", curVoltage_1V   ));
+        showText(ui->labelValueVoltage1_8V     , QString::asprintf("%5.3f V", curVoltage_1_8V ));
+        showStyleSheet(ui->labelValueBoardTemperature, fabs(curTemp_board      - 35) > 25  ? notOKstyle : neutralStyle);
+        showStyleSheet(ui->labelValueFPGAtemperature , fabs(curTemp_FPGA       - 35) > 25  ? notOKstyle : neutralStyle);
+        showStyleSheet(ui->labelValueVoltage1V       , fabs(curVoltage_1V  /1.0 - 1) > 0.2 ? notOKstyle : neutralStyle);
+        showStyleSheet(ui->labelValueVoltage1_8V     , fabs(curVoltage_1_8V/1.8 - 1) > 0.2 ? notOKstyle : neutralStyle);
 
-        ui->labelValueSerial          ->setText(QString::asprintf("%d"     , isTCM() ? FEE.TCM.act.SERIAL_NUM : curPM->act.SERIAL_NUM));
-        TypeFITsubdetector bt = TypeFITsubdetector(isTCM() ? FEE.TCM.act.boardType : curPM->act.boardType);
-        ui->labelValueBoardType->setText(QString::asprintf("%d: %s", bt, FIT[bt].name));
-        ui->labelValueBoardType->setStyleSheet(bt != FEE.subdetector ? notOKstyle : neutralStyle);
-        Timestamp tMCU  = isTCM() ? FEE.TCM.act.FW_TIME_MCU  : curPM->act.FW_TIME_MCU;
-        Timestamp tFPGA = isTCM() ? FEE.TCM.act.FW_TIME_FPGA : curPM->act.FW_TIME_FPGA;
-        ui->labelValueMCUFWversion ->setText(tMCU .printCode1());
-        ui->labelValueFPGAFWversion->setText(tFPGA.printCode1());
+        showText(ui->labelValueSerial          , QString::asprintf("%d"     , isTCM() ? view.TCM.act.SERIAL_NUM : curPMview->act.SERIAL_NUM));
+        TypeFITsubdetector bt = TypeFITsubdetector(isTCM() ? view.TCM.act.boardType : curPMview->act.boardType);
+        showText(ui->labelValueBoardType, QString::asprintf("%d: %s", bt, FIT[bt].name));
+        showStyleSheet(ui->labelValueBoardType, bt != FEE.subdetector ? notOKstyle : neutralStyle);
+        Timestamp tMCU  = isTCM() ? view.TCM.act.FW_TIME_MCU  : curPMview->act.FW_TIME_MCU;
+        Timestamp tFPGA = isTCM() ? view.TCM.act.FW_TIME_FPGA : curPMview->act.FW_TIME_FPGA;
+        showText(ui->labelValueMCUFWversion , tMCU .printCode1());
+        showText(ui->labelValueFPGAFWversion, tFPGA.printCode1());
         QString tMCUfull  = tMCU .printFull();
         QString tFPGAfull = tFPGA.printFull();
         ui->labelTextMCUFWversion ->setToolTip(tMCUfull);
         ui->labelValueMCUFWversion->setToolTip(tMCUfull);
         ui->labelTextFPGAFWversion ->setToolTip(tFPGAfull);
         ui->labelValueFPGAFWversion->setToolTip(tFPGAfull);
-        ui->comboBoxUpdatePeriod->setCurrentIndex(FEE.TCM.act.COUNTERS_UPD_RATE);
+        ui->comboBoxUpdatePeriod->setCurrentIndex(view.TCM.act.COUNTERS_UPD_RATE);
         switch (curGBTact->Control.DG_MODE) {
             case GBTunit::DG_noData: ui->buttonDataGeneratorOff ->setChecked(true); break;
             case GBTunit::DG_main  : ui->buttonDataGeneratorMain->setChecked(true); break;
@@ -645,118 +710,118 @@ public slots:
             case GBTunit::TG_continuous: ui->buttonTriggerGeneratorContinuous->setChecked(true); break;
             case GBTunit::TG_Tx        : ui->buttonTriggerGeneratorTx        ->setChecked(true);
         }
-        ui->labelValueDGtriggerRespondMask  ->setText(QString::asprintf("0x%08X" , curGBTact->Control.DG_TRG_RESPOND_MASK));
-        ui->labelValueDGbunchPattern        ->setText(QString::asprintf("0x%08X" , curGBTact->Control.DG_BUNCH_PATTERN   ));
-        ui->labelValueDGbunchFrequency      ->setText(QString::asprintf("0x%04X" , curGBTact->Control.DG_BUNCH_FREQ      ));
-        ui->labelValueDGfrequencyOffset     ->setText(QString::asprintf("0x%03X" , curGBTact->Control.DG_FREQ_OFFSET     ));
-        ui->labelValueTGcontinuousValue     ->setText(QString::asprintf("0x%08X" , curGBTact->Control.TG_CONT_VALUE      ));
-        ui->labelValueTGbunchFrequency      ->setText(QString::asprintf("0x%04X" , curGBTact->Control.TG_BUNCH_FREQ      ));
-        ui->labelValueTGfrequencyOffset     ->setText(QString::asprintf("0x%03X" , curGBTact->Control.TG_FREQ_OFFSET     ));
-        ui->labelValueTGHBrRate             ->setText(QString::asprintf("%d"     , curGBTact->Control.TG_HBr_RATE        ));
-        ui->labelValueTGcontinuousPattern   ->setText(QString::asprintf("0x%08X%08X", curGBTact->Control.TG_PATTERN_MSB, curGBTact->Control.TG_PATTERN_LSB));
+        showText(ui->labelValueDGtriggerRespondMask  , QString::asprintf("0x%08X" , curGBTact->Control.DG_TRG_RESPOND_MASK));
+        showText(ui->labelValueDGbunchPattern        , QString::asprintf("0x%08X" , curGBTact->Control.DG_BUNCH_PATTERN   ));
+        showText(ui->labelValueDGbunchFrequency      , QString::asprintf("0x%04X" , curGBTact->Control.DG_BUNCH_FREQ      ));
+        showText(ui->labelValueDGfrequencyOffset     , QString::asprintf("0x%03X" , curGBTact->Control.DG_FREQ_OFFSET     ));
+        showText(ui->labelValueTGcontinuousValue     , QString::asprintf("0x%08X" , curGBTact->Control.TG_CONT_VALUE      ));
+        showText(ui->labelValueTGbunchFrequency      , QString::asprintf("0x%04X" , curGBTact->Control.TG_BUNCH_FREQ      ));
+        showText(ui->labelValueTGfrequencyOffset     , QString::asprintf("0x%03X" , curGBTact->Control.TG_FREQ_OFFSET     ));
+        showText(ui->labelValueTGHBrRate             , QString::asprintf("%d"     , curGBTact->Control.TG_HBr_RATE        ));
+        showText(ui->labelValueTGcontinuousPattern   , QString::asprintf("0x%08X%08X", curGBTact->Control.TG_PATTERN_MSB, curGBTact->Control.TG_PATTERN_LSB));
         ui->comboBoxLTUemuReadoutMode->setCurrentIndex(curGBTact->Control.TG_CTP_EMUL_MODE);
-        ui->labelValueFEEID                 ->setText(QString::asprintf("0x%04X = %5d", curGBTact->Control.RDH_FEE_ID, curGBTact->Control.RDH_FEE_ID));
-        ui->labelValueSystemID              ->setText(QString::asprintf("0x%02X = %d" , curGBTact->Control.RDH_SYS_ID, curGBTact->Control.RDH_SYS_ID));
-        ui->labelValueBCIDdelayHex          ->setText(QString::asprintf("0x%03X",      curGBTact->Control.BCID_DELAY           ));
-        ui->labelValueBCIDdelayDec          ->setText(QString::asprintf("%d"  ,        curGBTact->Control.BCID_DELAY           ));
-        ui->labelValueDataSelectTriggerMask ->setText(QString::asprintf("0x%08X",      curGBTact->Control.DATA_SEL_TRG_MASK    ));
+        showText(ui->labelValueFEEID                 , QString::asprintf("0x%04X = %5d", curGBTact->Control.RDH_FEE_ID, curGBTact->Control.RDH_FEE_ID));
+        showText(ui->labelValueSystemID              , QString::asprintf("0x%02X = %d" , curGBTact->Control.RDH_SYS_ID, curGBTact->Control.RDH_SYS_ID));
+        showText(ui->labelValueBCIDdelayHex          , QString::asprintf("0x%03X",      curGBTact->Control.BCID_DELAY           ));
+        showText(ui->labelValueBCIDdelayDec          , QString::asprintf("%d"  ,        curGBTact->Control.BCID_DELAY           ));
+        showText(ui->labelValueDataSelectTriggerMask , QString::asprintf("0x%08X",      curGBTact->Control.DATA_SEL_TRG_MASK    ));
         ui->SwitcherLockReadout->setChecked( (curGBTact->Control.registers[0] & 1 << 14) == 0);
         ui->SwitcherBypassMode ->setChecked(  curGBTact->Control.BYPASS_MODE == 0);
         ui->SwitcherHBresponse ->setChecked(  curGBTact->Control.HB_RESPONSE);
         ui->SwitcherHBreject   ->setChecked(  curGBTact->Control.HB_REJECT);
         switch (curGBTact->Status.READOUT_MODE) {
-            case GBTunit::RO_idle      : ui->labelValueReadoutModeBoard->setText("Idle"      ); break;
-            case GBTunit::RO_continuous: ui->labelValueReadoutModeBoard->setText("Continuous"); break;
-            case GBTunit::RO_triggered : ui->labelValueReadoutModeBoard->setText("Triggered" );
+            case GBTunit::RO_idle      : showText(ui->labelValueReadoutModeBoard, "Idle"      ); break;
+            case GBTunit::RO_continuous: showText(ui->labelValueReadoutModeBoard, "Continuous"); break;
+            case GBTunit::RO_triggered : showText(ui->labelValueReadoutModeBoard, "Triggered" );
         }
         switch (curGBTact->Status.CRU_READOUT_MODE) {
-            case GBTunit::RO_idle      : ui->labelValueReadoutModeCRU  ->setText("Idle"      ); break;
-            case GBTunit::RO_continuous: ui->labelValueReadoutModeCRU  ->setText("Continuous"); break;
-            case GBTunit::RO_triggered : ui->labelValueReadoutModeCRU  ->setText("Triggered" );
+            case GBTunit::RO_idle      : showText(ui->labelValueReadoutModeCRU  , "Idle"      ); break;
+            case GBTunit::RO_continuous: showText(ui->labelValueReadoutModeCRU  , "Continuous"); break;
+            case GBTunit::RO_triggered : showText(ui->labelValueReadoutModeCRU  , "Triggered" );
         }
         switch (curGBTact->Status.BCID_SYNC_MODE) {
-            case GBTunit::BS_start: ui->labelValueBCIDsync->setText("Start"); ui->labelValueBCIDsync->setStyleSheet(neutralStyle); break;
-            case GBTunit::BS_sync : ui->labelValueBCIDsync->setText("Sync" ); ui->labelValueBCIDsync->setStyleSheet(     OKstyle); break;
-            case GBTunit::BS_lost : ui->labelValueBCIDsync->setText("Lost" ); ui->labelValueBCIDsync->setStyleSheet(  notOKstyle);
+            case GBTunit::BS_start: showText(ui->labelValueBCIDsync, "Start"); showStyleSheet(ui->labelValueBCIDsync, neutralStyle); break;
+            case GBTunit::BS_sync : showText(ui->labelValueBCIDsync, "Sync" ); showStyleSheet(ui->labelValueBCIDsync,      OKstyle); break;
+            case GBTunit::BS_lost : showText(ui->labelValueBCIDsync, "Lost" ); showStyleSheet(ui->labelValueBCIDsync,   notOKstyle);
         }
-        ui->labelValueCRUorbit->setText(QString::asprintf("%08X", curGBTact->Status.CRU_ORBIT));
-        ui->labelValueRxPhase ->setText(QString::asprintf("%d"  , curGBTact->Status.RX_PHASE ));
+        showText(ui->labelValueCRUorbit, QString::asprintf("%08X", curGBTact->Status.CRU_ORBIT));
+        showText(ui->labelValueRxPhase , QString::asprintf("%d"  , curGBTact->Status.RX_PHASE ));
         ui->SwitcherShiftRxPhase->setChecked(curGBTact->Control.shiftRxPhase);
-        ui->labelValueRxPhase ->setStyleSheet(curGBTact->Status.RX_PHASE/2 == (curGBTact->Control.shiftRxPhase ? 0 : 2) ? notOKstyle : neutralStyle);
+        showStyleSheet(ui->labelValueRxPhase , curGBTact->Status.RX_PHASE/2 == (curGBTact->Control.shiftRxPhase ? 0 : 2) ? notOKstyle : neutralStyle);
 
-        ui->labelIconEmptyFIFOheader->setPixmap(curGBTact->Status.FIFOempty_header ? Green1 : Red0);
-        ui->labelIconEmptyFIFOdata  ->setPixmap(curGBTact->Status.FIFOempty_data   ? Green1 : Red0);
-        ui->labelIconEmptyFIFOtrg   ->setPixmap(curGBTact->Status.FIFOempty_trg    ? Green1 : Red0);
-        ui->labelIconEmptyFIFOslct  ->setPixmap(curGBTact->Status.FIFOempty_slct   ? Green1 : Red0);
-        ui->labelIconEmptyFIFOcntpck->setPixmap(curGBTact->Status.FIFOempty_cntpck ? Green1 : Red0);
+        showPixmap(ui->labelIconEmptyFIFOheader, curGBTact->Status.FIFOempty_header ? Green1 : Red0);
+        showPixmap(ui->labelIconEmptyFIFOdata  , curGBTact->Status.FIFOempty_data   ? Green1 : Red0);
+        showPixmap(ui->labelIconEmptyFIFOtrg   , curGBTact->Status.FIFOempty_trg    ? Green1 : Red0);
+        showPixmap(ui->labelIconEmptyFIFOslct  , curGBTact->Status.FIFOempty_slct   ? Green1 : Red0);
+        showPixmap(ui->labelIconEmptyFIFOcntpck, curGBTact->Status.FIFOempty_cntpck ? Green1 : Red0);
         ui->labelIconEmptyFIFOheader->setEnabled(curGBTact->Status.READOUT_MODE == GBTunit::RO_idle);
         ui->labelIconEmptyFIFOdata  ->setEnabled(curGBTact->Status.READOUT_MODE == GBTunit::RO_idle);
         ui->labelIconEmptyFIFOtrg   ->setEnabled(curGBTact->Status.READOUT_MODE == GBTunit::RO_idle);
         ui->labelIconEmptyFIFOslct  ->setEnabled(curGBTact->Status.READOUT_MODE == GBTunit::RO_idle);
         ui->labelIconEmptyFIFOcntpck->setEnabled(curGBTact->Status.READOUT_MODE == GBTunit::RO_idle);
         ui->labelIconFIFOsNotReady  ->setEnabled(curGBTact->Status.READOUT_MODE == GBTunit::RO_idle);
-        ui->labelIconNotEmptyFIFOheader->setPixmap(curGBTact->Status.FIFOnotEmptyOnRunStart_header ? Red1 : Green0);
-        ui->labelIconNotEmptyFIFOdata  ->setPixmap(curGBTact->Status.FIFOnotEmptyOnRunStart_data   ? Red1 : Green0);
-        ui->labelIconNotEmptyFIFOtrg   ->setPixmap(curGBTact->Status.FIFOnotEmptyOnRunStart_trg    ? Red1 : Green0);
-        ui->labelIconNotEmptyFIFOslct  ->setPixmap(curGBTact->Status.FIFOnotEmptyOnRunStart_slct   ? Red1 : Green0);
-        ui->labelIconNotEmptyFIFOcntpck->setPixmap(curGBTact->Status.FIFOnotEmptyOnRunStart_cntpck ? Red1 : Green0);
-        ui->labelIconFIFOtrgWasFull     ->setPixmap(curGBTact->Status.trgFIFOwasFull         ? Red1 : Green0);
-        ui->labelIconFIFOslctEmptyOnRead->setPixmap(curGBTact->Status.slctFIFOemptyWhileRead ? Red1 : Green0);
-        ui->labelIconFIFOsNotReady      ->setPixmap(curGBTact->Status.dataFIFOnotReady       ? Red1 : Green0);
-        ui->labelIconBCIDsyncLostInRun  ->setPixmap(curGBTact->Status.BCsyncLostInRun        ? Red1 : Green0);
+        showPixmap(ui->labelIconNotEmptyFIFOheader, curGBTact->Status.FIFOnotEmptyOnRunStart_header ? Red1 : Green0);
+        showPixmap(ui->labelIconNotEmptyFIFOdata  , curGBTact->Status.FIFOnotEmptyOnRunStart_data   ? Red1 : Green0);
+        showPixmap(ui->labelIconNotEmptyFIFOtrg   , curGBTact->Status.FIFOnotEmptyOnRunStart_trg    ? Red1 : Green0);
+        showPixmap(ui->labelIconNotEmptyFIFOslct  , curGBTact->Status.FIFOnotEmptyOnRunStart_slct   ? Red1 : Green0);
+        showPixmap(ui->labelIconNotEmptyFIFOcntpck, curGBTact->Status.FIFOnotEmptyOnRunStart_cntpck ? Red1 : Green0);
+        showPixmap(ui->labelIconFIFOtrgWasFull     , curGBTact->Status.trgFIFOwasFull         ? Red1 : Green0);
+        showPixmap(ui->labelIconFIFOslctEmptyOnRead, curGBTact->Status.slctFIFOemptyWhileRead ? Red1 : Green0);
+        showPixmap(ui->labelIconFIFOsNotReady      , curGBTact->Status.dataFIFOnotReady       ? Red1 : Green0);
+        showPixmap(ui->labelIconBCIDsyncLostInRun  , curGBTact->Status.BCsyncLostInRun        ? Red1 : Green0);
         if (isTCM())
-            ui->labelIconExtraWord->setPixmap(curGBTact->Status.TCMdataFIFOfull ? Red1 : Green0);
+            showPixmap(ui->labelIconExtraWord, curGBTact->Status.TCMdataFIFOfull ? Red1 : Green0);
         else {
-            ui->labelIconExtraWord->setPixmap(curGBTact->Status.PMpacketCorruptedExtraWord ? Red1 : Green0);
-            ui->labelIconEarlyHeader->setPixmap(curGBTact->Status.PMpacketCorruptedEarlyHeader ? Red1 : Green0);
+            showPixmap(ui->labelIconExtraWord, curGBTact->Status.PMpacketCorruptedExtraWord ? Red1 : Green0);
+            showPixmap(ui->labelIconEarlyHeader, curGBTact->Status.PMpacketCorruptedEarlyHeader ? Red1 : Green0);
         }
 
-        ui->labelValueFIFOmaxConverter->setText(QString::asprintf("%u", curGBTact->Status.CNVFIFOmax));
-        ui->labelValueFIFOmaxSelector ->setText(QString::asprintf("%u", curGBTact->Status.SELFIFOmax));
-        ui->labelValueDropCountConverter->setText(QString::asprintf("%u", curGBTact->Status.CNVdropCount));
-        ui->labelValueDropCountSelector ->setText(QString::asprintf("%u", curGBTact->Status.SELdropCount));
-        ui->labelValueGBTwords->setText(QString::asprintf("%u", curGBTact->Status.wordsCount ));
-        ui->labelValueEvents  ->setText(QString::asprintf("%u", curGBTact->Status.eventsCount));
-        ui->labelValueGBTwordsRate->setText(rateFormat(isTCM() ? FEE.TCM.counters.GBT. wordsRate : curPM->counters.GBT. wordsRate));
-        ui->labelValueEventsRate  ->setText(rateFormat(isTCM() ? FEE.TCM.counters.GBT.eventsRate : curPM->counters.GBT.eventsRate));
-        ui->labelValueBCdata->setText(QString::asprintf("%4d", curGBTact->Status.BCindicatorData));
-        ui->labelValueBCtrg ->setText(QString::asprintf("%4d", curGBTact->Status.BCindicatorTrg ));
-        ui->labelValueBCdataModality->setText(QString::asprintf("%d/15", curGBTact->Status.BCmodalityData));
-        ui->labelValueBCtrgModality ->setText(QString::asprintf("%d/15", curGBTact->Status.BCmodalityTrg ));
-        bool isDataBCindicatorActual = (isTCM() ? FEE.TCM.counters.GBT.eventsRate : curPM->counters.GBT.eventsRate) >= 2.;
+        showText(ui->labelValueFIFOmaxConverter, QString::asprintf("%u", curGBTact->Status.CNVFIFOmax));
+        showText(ui->labelValueFIFOmaxSelector , QString::asprintf("%u", curGBTact->Status.SELFIFOmax));
+        showText(ui->labelValueDropCountConverter, QString::asprintf("%u", curGBTact->Status.CNVdropCount));
+        showText(ui->labelValueDropCountSelector , QString::asprintf("%u", curGBTact->Status.SELdropCount));
+        showText(ui->labelValueGBTwords, QString::asprintf("%u", curGBTact->Status.wordsCount ));
+        showText(ui->labelValueEvents  , QString::asprintf("%u", curGBTact->Status.eventsCount));
+        showText(ui->labelValueGBTwordsRate, rateFormat(isTCM() ? view.TCM.counters.GBT. wordsRate : curPMview->counters.GBT. wordsRate));
+        showText(ui->labelValueEventsRate  , rateFormat(isTCM() ? view.TCM.counters.GBT.eventsRate : curPMview->counters.GBT.eventsRate));
+        showText(ui->labelValueBCdata, QString::asprintf("%4d", curGBTact->Status.BCindicatorData));
+        showText(ui->labelValueBCtrg , QString::asprintf("%4d", curGBTact->Status.BCindicatorTrg ));
+        showText(ui->labelValueBCdataModality, QString::asprintf("%d/15", curGBTact->Status.BCmodalityData));
+        showText(ui->labelValueBCtrgModality , QString::asprintf("%d/15", curGBTact->Status.BCmodalityTrg ));
+        bool isDataBCindicatorActual = (isTCM() ? view.TCM.counters.GBT.eventsRate : curPMview->counters.GBT.eventsRate) >= 2.;
         ui->labelValueBCdata        ->setEnabled(isDataBCindicatorActual);
         ui->labelValueBCdataModality->setEnabled(isDataBCindicatorActual);
 
-        ui->labelIconPhaseAlignerCPLLlock->setPixmap(curGBTact->Status.phaseAlignerCPLLlock ? Green1 : Red0);
-        ui->labelIconRxWorldclkReady     ->setPixmap(curGBTact->Status.RxWordClockReady ? Green1 : Red0);
-        ui->labelIconRxFrameclkReady     ->setPixmap(curGBTact->Status.RxFrameClockReady ? Green1 : Red0);
-        ui->labelIconMGTlinkReady        ->setPixmap(curGBTact->Status.MGTlinkReady ? Green1 : Red0);
-        ui->labelIconTxResetDone         ->setPixmap(curGBTact->Status.TxResetDone ? Green1 : Red0);
-        ui->labelIconTxFSMresetDone      ->setPixmap(curGBTact->Status.TxFSMresetDone ? Green1 : Red0);
-        ui->labelIconGBTRxReady          ->setPixmap((isTCM() ? FEE.TCM.act.GBTRxReady : curPM->act.GBTRxReady) ? Green1 : Red0);
-        ui->labelTextGBTRxReady          ->setStyleSheet(curGBTact->Status.GBTRxReady ? "" : "color: red");
-        ui->labelTextGBTRxError          ->setStyleSheet(curGBTact->Status.GBTRxError ? "color: red" : "");
-        ui->labelIconRxPhaseError        ->setPixmap(curGBTact->Status.RxPhaseError ? Red1 : Green0);
+        showPixmap(ui->labelIconPhaseAlignerCPLLlock, curGBTact->Status.phaseAlignerCPLLlock ? Green1 : Red0);
+        showPixmap(ui->labelIconRxWorldclkReady     , curGBTact->Status.RxWordClockReady ? Green1 : Red0);
+        showPixmap(ui->labelIconRxFrameclkReady     , curGBTact->Status.RxFrameClockReady ? Green1 : Red0);
+        showPixmap(ui->labelIconMGTlinkReady        , curGBTact->Status.MGTlinkReady ? Green1 : Red0);
+        showPixmap(ui->labelIconTxResetDone         , curGBTact->Status.TxResetDone ? Green1 : Red0);
+        showPixmap(ui->labelIconTxFSMresetDone      , curGBTact->Status.TxFSMresetDone ? Green1 : Red0);
+        showPixmap(ui->labelIconGBTRxReady          , (isTCM() ? view.TCM.act.GBTRxReady : curPMview->act.GBTRxReady) ? Green1 : Red0);
+        showStyleSheet(ui->labelTextGBTRxReady          , curGBTact->Status.GBTRxReady ? "" : "color: red");
+        showStyleSheet(ui->labelTextGBTRxError          , curGBTact->Status.GBTRxError ? "color: red" : "");
+        showPixmap(ui->labelIconRxPhaseError        , curGBTact->Status.RxPhaseError ? Red1 : Green0);
 
-        ui->labelValueFSMerror->setText(QString::asprintf("0x%03X", curGBTact->Status.registers[2] >> 16 & 0xFFF));
+        showText(ui->labelValueFSMerror, QString::asprintf("0x%03X", curGBTact->Status.registers[2] >> 16 & 0xFFF));
 
         if (isTCM()) {
             if (FEE.subdetector != FV0) {
-                ui->buttonSCcharge->setChecked(FEE.TCM.act.SC_EVAL_MODE == 0);
-                ui->buttonSCNchan ->setChecked(FEE.TCM.act.SC_EVAL_MODE == 1);
+                ui->buttonSCcharge->setChecked(view.TCM.act.SC_EVAL_MODE == 0);
+                ui->buttonSCNchan ->setChecked(view.TCM.act.SC_EVAL_MODE == 1);
             }
-            ui->labelIconEnabled_A             ->setPixmap(FEE.TCM.act.sideAenabled     ? Green1 : Red0);
-            ui->labelIconEnabled_C             ->setPixmap(FEE.TCM.act.sideCenabled     ? Green1 : Red0);
-            ui->labelIconLinksOKready_A        ->setPixmap(FEE.TCM.act.sideAready       ? Green1 : Red0);
-            ui->labelIconLinksOKready_C        ->setPixmap(FEE.TCM.act.sideCready       ? Green1 : Red0);
-            ui->labelIconMasterLinkDelayError_A->setPixmap(FEE.TCM.act.masterLinkErrorA ? Red1 : Green0);
-            ui->labelIconMasterLinkDelayError_C->setPixmap(FEE.TCM.act.masterLinkErrorC ? Red1 : Green0);
-            ui->labelIconPLLlock_A             ->setPixmap(FEE.TCM.act.PLLlockA         ? Green1 : Red0);
-            ui->labelIconPLLlock_C             ->setPixmap(FEE.TCM.act.PLLlockC         ? Green1 : Red0);
-            ui->labelIconReadinessChanged_A    ->setPixmap(FEE.TCM.act.readinessChangeA ? Red1 : Green0);
-            ui->labelIconReadinessChanged_C    ->setPixmap(FEE.TCM.act.readinessChangeC ? Red1 : Green0);
-            ui->labelIconDelayRangeError_A     ->setPixmap(FEE.TCM.act.delayRangeErrorA ? Red1 : Green0);
-            ui->labelIconDelayRangeError_C     ->setPixmap(FEE.TCM.act.delayRangeErrorC ? Red1 : Green0);
+            showPixmap(ui->labelIconEnabled_A             , view.TCM.act.sideAenabled     ? Green1 : Red0);
+            showPixmap(ui->labelIconEnabled_C             , view.TCM.act.sideCenabled     ? Green1 : Red0);
+            showPixmap(ui->labelIconLinksOKready_A        , view.TCM.act.sideAready       ? Green1 : Red0);
+            showPixmap(ui->labelIconLinksOKready_C        , view.TCM.act.sideCready       ? Green1 : Red0);
+            showPixmap(ui->labelIconMasterLinkDelayError_A, view.TCM.act.masterLinkErrorA ? Red1 : Green0);
+            showPixmap(ui->labelIconMasterLinkDelayError_C, view.TCM.act.masterLinkErrorC ? Red1 : Green0);
+            showPixmap(ui->labelIconPLLlock_A             , view.TCM.act.PLLlockA         ? Green1 : Red0);
+            showPixmap(ui->labelIconPLLlock_C             , view.TCM.act.PLLlockC         ? Green1 : Red0);
+            showPixmap(ui->labelIconReadinessChanged_A    , view.TCM.act.readinessChangeA ? Red1 : Green0);
+            showPixmap(ui->labelIconReadinessChanged_C    , view.TCM.act.readinessChangeC ? Red1 : Green0);
+            showPixmap(ui->labelIconDelayRangeError_A     , view.TCM.act.delayRangeErrorA ? Red1 : Green0);
+            showPixmap(ui->labelIconDelayRangeError_C     , view.TCM.act.delayRangeErrorC ? Red1 : Green0);
             if (prevPhaseStep_ns != phaseStep_ns) {
                 ui->spinBoxORgateTCM->setMaximum(TDCunit_ps * 255 / 1000);
                 ui->spinBoxORgateTCM->setSingleStep(TDCunit_ps / 1000);
@@ -771,71 +836,73 @@ public slots:
                 ui->spinBoxLaserPhase->setSingleStep(phaseStepLaser_ns);
                 prevPhaseStep_ns = phaseStep_ns;
             }
-            ui->labelValueAverageTime_A->setText(QString::asprintf("%7.3f", FEE.TCM.act.averageTimeA_ns));
-            ui->labelValueAverageTime_C->setText(QString::asprintf("%7.3f", FEE.TCM.act.averageTimeC_ns));
-            ui->labelValueAverageTime_A->setEnabled(FEE.TCM.counters.rate[0xA] >= 100.); //average time is calculated for last 1000 interactions (OrA AND OrC)
-            ui->labelValueAverageTime_C->setEnabled(FEE.TCM.counters.rate[0xA] >= 100.); //so the value is not useful at low rates
-            ui->labelValuePhase_A->setText(QString::asprintf("%7.3f", FEE.TCM.act.delayAside_ns));
-            ui->labelValuePhase_C->setText(QString::asprintf("%7.3f", FEE.TCM.act.delayCside_ns));
-            ui->groupBoxOrGate      ->setDisabled(FEE.PM.isEmpty());
-            ui->groupBoxChargeLimits->setDisabled(FEE.PM.isEmpty());
-            if (FEE.PM.isEmpty())
+            showText(ui->labelValueAverageTime_A, QString::asprintf("%7.3f", view.TCM.act.averageTimeA_ns));
+            showText(ui->labelValueAverageTime_C, QString::asprintf("%7.3f", view.TCM.act.averageTimeC_ns));
+            ui->labelValueAverageTime_A->setEnabled(view.TCM.counters.rate[0xA] >= 100.); //average time is calculated for last 1000 interactions (OrA AND OrC)
+            ui->labelValueAverageTime_C->setEnabled(view.TCM.counters.rate[0xA] >= 100.); //so the value is not useful at low rates
+            showText(ui->labelValuePhase_A, QString::asprintf("%7.3f", view.TCM.act.delayAside_ns));
+            showText(ui->labelValuePhase_C, QString::asprintf("%7.3f", view.TCM.act.delayCside_ns));
+            ui->groupBoxOrGate      ->setDisabled(view.PMpresent == 0);
+            ui->groupBoxChargeLimits->setDisabled(view.PMpresent == 0);
+            if (view.PMpresent == 0)
                 foreach(ActualLabel *l, QList<ActualLabel *>({
                     ui->labelValueORgateTCM    ,
                     ui->labelValueChargeHighTCM,
                     ui->labelValueChargeLowTCM
                 })) {
-                    l->setText("noPM");
+                    showText(l, "noPM");
                     l->setToolTip("no PM available");
                 }
             else {
+                QList<FITview::PMview *> present;
+                for (quint8 i=0; i<20; ++i) if (view.PMpresent & 1 << i) present.append(view.PM + i);
                 bool equalValues = true;
-                quint8 orGate = FEE.PM.first()->act.OR_GATE;
-                foreach (TypePM *pm, FEE.PM) { if (orGate != pm->act.OR_GATE) { equalValues = false; break; } }
-                ui->labelValueORgateTCM->setText(equalValues ? QString::asprintf("%5.3f", orGate * TDCunit_ps / 1000) : "diff");
+                quint8 orGate = present.first()->act.OR_GATE;
+                foreach (FITview::PMview *pm, present) { if (orGate != pm->act.OR_GATE) { equalValues = false; break; } }
+                showText(ui->labelValueORgateTCM, equalValues ? QString::asprintf("%5.3f", orGate * TDCunit_ps / 1000) : "diff");
                 ui->labelValueORgateTCM->setToolTip(equalValues ? QString::asprintf("%d TDC units", orGate) : "differs between PMs");
                 equalValues = true;
-                quint16 chargeHi = FEE.PM.first()->act.TRGchargeLevelHi;
-                foreach (TypePM *pm, FEE.PM) { if (chargeHi != pm->act.TRGchargeLevelHi) { equalValues = false; break; } }
-                ui->labelValueChargeHighTCM->setText(equalValues ? QString::asprintf("%d", chargeHi) : "diff");
+                quint16 chargeHi = present.first()->act.TRGchargeLevelHi;
+                foreach (FITview::PMview *pm, present) { if (chargeHi != pm->act.TRGchargeLevelHi) { equalValues = false; break; } }
+                showText(ui->labelValueChargeHighTCM, equalValues ? QString::asprintf("%d", chargeHi) : "diff");
                 ui->labelValueChargeHighTCM->setToolTip(equalValues ? "" : "differs between PMs");
                 equalValues = true;
-                quint16 chargeLo = FEE.PM.first()->act.TRGchargeLevelLo;
-                foreach (TypePM *pm, FEE.PM) { if (chargeLo != pm->act.TRGchargeLevelLo) { equalValues = false; break; } }
-                ui->labelValueChargeLowTCM->setText(equalValues ? QString::asprintf("%d", chargeLo) : "diff");
+                quint16 chargeLo = present.first()->act.TRGchargeLevelLo;
+                foreach (FITview::PMview *pm, present) { if (chargeLo != pm->act.TRGchargeLevelLo) { equalValues = false; break; } }
+                showText(ui->labelValueChargeLowTCM, equalValues ? QString::asprintf("%d", chargeLo) : "diff");
                 ui->labelValueChargeLowTCM->setToolTip(equalValues ? "" : "differs between PMs");
             }
-            ui->SwitcherExt1->setChecked(FEE.TCM.act.EXT_SW & 1);
-            ui->SwitcherExt2->setChecked(FEE.TCM.act.EXT_SW & 2);
-            ui->SwitcherExt3->setChecked(FEE.TCM.act.EXT_SW & 4);
-            ui->SwitcherExt4->setChecked(FEE.TCM.act.EXT_SW & 8);
-            ui->SwitcherExtendedReadout->setChecked(FEE.TCM.act.EXTENDED_READOUT);
-            ui->SwitcherAddCdelay->setChecked(FEE.TCM.act.ADD_C_DELAY);
-            ui->SwitcherTriggers_1->setChecked(FEE.TCM.act.T1_ENABLED);
-            ui->SwitcherTriggers_2->setChecked(FEE.TCM.act.T2_ENABLED);
-            ui->SwitcherTriggers_3->setChecked(FEE.TCM.act.T3_ENABLED);
-            ui->SwitcherTriggers_4->setChecked(FEE.TCM.act.T4_ENABLED);
-            ui->SwitcherTriggers_5->setChecked(FEE.TCM.act.T5_ENABLED);
-            ui->comboBoxTriggersMode_1->setCurrentIndex(FEE.TCM.act.T1_MODE);
-            ui->comboBoxTriggersMode_2->setCurrentIndex(FEE.TCM.act.T2_MODE);
-            ui->comboBoxTriggersMode_3->setCurrentIndex(FEE.TCM.act.T3_MODE);
-            ui->comboBoxTriggersMode_4->setCurrentIndex(FEE.TCM.act.T4_MODE);
-            ui->comboBoxTriggersMode_5->setCurrentIndex(FEE.TCM.act.T5_MODE);
-            ui->labelValueTriggersRandomRate_1->setText(QString::asprintf("%08X", FEE.TCM.act.T1_RATE));
-            ui->labelValueTriggersRandomRate_2->setText(QString::asprintf("%08X", FEE.TCM.act.T2_RATE));
-            ui->labelValueTriggersRandomRate_3->setText(QString::asprintf("%08X", FEE.TCM.act.T3_RATE));
-            ui->labelValueTriggersRandomRate_4->setText(QString::asprintf("%08X", FEE.TCM.act.T4_RATE));
-            ui->labelValueTriggersRandomRate_5->setText(QString::asprintf("%08X", FEE.TCM.act.T5_RATE));
-            ui->labelValueTriggersSignature_1->setText(QString::asprintf("%d", FEE.TCM.act.T1_SIGN));
-            ui->labelValueTriggersSignature_2->setText(QString::asprintf("%d", FEE.TCM.act.T2_SIGN));
-            ui->labelValueTriggersSignature_3->setText(QString::asprintf("%d", FEE.TCM.act.T3_SIGN));
-            ui->labelValueTriggersSignature_4->setText(QString::asprintf("%d", FEE.TCM.act.T4_SIGN));
-            ui->labelValueTriggersSignature_5->setText(QString::asprintf("%d", FEE.TCM.act.T5_SIGN));
-            ui->labelValueTriggersLevelA_1->setText(QString::asprintf("%d", FEE.TCM.act.T1_LEVEL_A));
-            ui->labelValueTriggersLevelC_1->setText(QString::asprintf("%d", FEE.TCM.act.T1_LEVEL_C));
-            ui->labelValueTriggersLevelA_2->setText(QString::asprintf("%d", FEE.TCM.act.T2_LEVEL_A));
-            ui->labelValueTriggersLevelC_2->setText(QString::asprintf("%d", FEE.TCM.act.T2_LEVEL_C));
-            if (FEE.subdetector != FV0) switch (FEE.TCM.act.sidesCombMode) {
+            ui->SwitcherExt1->setChecked(view.TCM.act.EXT_SW & 1);
+            ui->SwitcherExt2->setChecked(view.TCM.act.EXT_SW & 2);
+            ui->SwitcherExt3->setChecked(view.TCM.act.EXT_SW & 4);
+            ui->SwitcherExt4->setChecked(view.TCM.act.EXT_SW & 8);
+            ui->SwitcherExtendedReadout->setChecked(view.TCM.act.EXTENDED_READOUT);
+            ui->SwitcherAddCdelay->setChecked(view.TCM.act.ADD_C_DELAY);
+            ui->SwitcherTriggers_1->setChecked(view.TCM.act.T1_ENABLED);
+            ui->SwitcherTriggers_2->setChecked(view.TCM.act.T2_ENABLED);
+            ui->SwitcherTriggers_3->setChecked(view.TCM.act.T3_ENABLED);
+            ui->SwitcherTriggers_4->setChecked(view.TCM.act.T4_ENABLED);
+            ui->SwitcherTriggers_5->setChecked(view.TCM.act.T5_ENABLED);
+            ui->comboBoxTriggersMode_1->setCurrentIndex(view.TCM.act.T1_MODE);
+            ui->comboBoxTriggersMode_2->setCurrentIndex(view.TCM.act.T2_MODE);
+            ui->comboBoxTriggersMode_3->setCurrentIndex(view.TCM.act.T3_MODE);
+            ui->comboBoxTriggersMode_4->setCurrentIndex(view.TCM.act.T4_MODE);
+            ui->comboBoxTriggersMode_5->setCurrentIndex(view.TCM.act.T5_MODE);
+            showText(ui->labelValueTriggersRandomRate_1, QString::asprintf("%08X", view.TCM.act.T1_RATE));
+            showText(ui->labelValueTriggersRandomRate_2, QString::asprintf("%08X", view.TCM.act.T2_RATE));
+            showText(ui->labelValueTriggersRandomRate_3, QString::asprintf("%08X", view.TCM.act.T3_RATE));
+            showText(ui->labelValueTriggersRandomRate_4, QString::asprintf("%08X", view.TCM.act.T4_RATE));
+            showText(ui->labelValueTriggersRandomRate_5, QString::asprintf("%08X", view.TCM.act.T5_RATE));
+            showText(ui->labelValueTriggersSignature_1, QString::asprintf("%d", view.TCM.act.T1_SIGN));
+            showText(ui->labelValueTriggersSignature_2, QString::asprintf("%d", view.TCM.act.T2_SIGN));
+            showText(ui->labelValueTriggersSignature_3, QString::asprintf("%d", view.TCM.act.T3_SIGN));
+            showText(ui->labelValueTriggersSignature_4, QString::asprintf("%d", view.TCM.act.T4_SIGN));
+            showText(ui->labelValueTriggersSignature_5, QString::asprintf("%d", view.TCM.act.T5_SIGN));
+            showText(ui->labelValueTriggersLevelA_1, QString::asprintf("%d", view.TCM.act.T1_LEVEL_A));
+            showText(ui->labelValueTriggersLevelC_1, QString::asprintf("%d", view.TCM.act.T1_LEVEL_C));
+            showText(ui->labelValueTriggersLevelA_2, QString::asprintf("%d", view.TCM.act.T2_LEVEL_A));
+            showText(ui->labelValueTriggersLevelC_2, QString::asprintf("%d", view.TCM.act.T2_LEVEL_C));
+            if (FEE.subdetector != FV0) switch (view.TCM.act.sidesCombMode) {
                 case 0: ui->radioButtonAandC->setChecked(true); break;
                 case 1: ui->radioButtonC    ->setChecked(true); break;
                 case 2: ui->radioButtonA    ->setChecked(true); break;
@@ -845,140 +912,141 @@ public slots:
             ui->labelValueTriggersLevelA_2->setEnabled(mode != 1);
             ui->labelValueTriggersLevelC_1->setEnabled(mode < 2); //enabled for modes A&C, C
             ui->labelValueTriggersLevelC_2->setEnabled(mode < 2);
-            ui->labelValueVertexTimeLow ->setText(QString::asprintf("%d", FEE.TCM.act.VTIME_LOW ));
-            ui->labelValueVertexTimeHigh->setText(QString::asprintf("%d", FEE.TCM.act.VTIME_HIGH));
-            ui->labelValueAttenuation->setText(QString::asprintf("%d", FEE.TCM.act.attenSteps));
-            ui->labelIconAttenBusy ->setPixmap(FEE.TCM.act.attenBusy     ? Red1 : Green0);
-            ui->labelIconAttenError->setPixmap(FEE.TCM.act.attenNotFound ? Red1 : Green0);
-            if (enableControls->isChecked()) ui->sliderAttenuation->setDisabled(FEE.TCM.act.attenBusy || FEE.TCM.act.attenNotFound);
-            ui->SwitcherLaser->setChecked(FEE.TCM.act.LASER_ENABLED);
-            FEE.TCM.act.LASER_SOURCE ? ui->radioButtonGenerator->setChecked(true) : ui->radioButtonExternalTrigger->setChecked(true);
-            ui->labelValueLaserFreqDivider->setText(QString::asprintf("0x%06x", FEE.TCM.act.LASER_DIVIDER));
-            ui->labelValueLaserFrequency->setText(frequencyFormat(FEE.TCM.act.laserFrequency_Hz));
-            ui->labelValueLaserPattern->setText(QString::asprintf("0x%016llX", FEE.TCM.act.LASER_PATTERN));
-            ui->labelValueLaserPhase->setText(QString::asprintf("%7.3f", FEE.TCM.act.delayLaser_ns));
-            for (quint8 i=0; i<64; ++i) { switchBitButtons.at(i)->setChecked(FEE.TCM.act.LASER_PATTERN & (1ULL << i)); }
-            ui->labelValueSuppressDuration->setText(QString::asprintf("%d", FEE.TCM.act.lsrTrgSupprDur));
-            ui->labelValueSuppressDelayBC ->setText(QString::asprintf("%d", FEE.TCM.act.lsrTrgSupprDelay));
-            ui->labelValueSuppressDelay_ns->setText(QString::asprintf("%.1f", FEE.TCM.act.lsrTrgSupprDelay * 2 * halfBC_ns));
+            showText(ui->labelValueVertexTimeLow , QString::asprintf("%d", view.TCM.act.VTIME_LOW ));
+            showText(ui->labelValueVertexTimeHigh, QString::asprintf("%d", view.TCM.act.VTIME_HIGH));
+            showText(ui->labelValueAttenuation, QString::asprintf("%d", view.TCM.act.attenSteps));
+            showPixmap(ui->labelIconAttenBusy , view.TCM.act.attenBusy     ? Red1 : Green0);
+            showPixmap(ui->labelIconAttenError, view.TCM.act.attenNotFound ? Red1 : Green0);
+            if (enableControls->isChecked()) ui->sliderAttenuation->setDisabled(view.TCM.act.attenBusy || view.TCM.act.attenNotFound);
+            ui->SwitcherLaser->setChecked(view.TCM.act.LASER_ENABLED);
+            view.TCM.act.LASER_SOURCE ? ui->radioButtonGenerator->setChecked(true) : ui->radioButtonExternalTrigger->setChecked(true);
+            showText(ui->labelValueLaserFreqDivider, QString::asprintf("0x%06x", view.TCM.act.LASER_DIVIDER));
+            showText(ui->labelValueLaserFrequency, frequencyFormat(view.TCM.act.laserFrequency_Hz));
+            showText(ui->labelValueLaserPattern, QString::asprintf("0x%016llX", view.TCM.act.LASER_PATTERN));
+            showText(ui->labelValueLaserPhase, QString::asprintf("%7.3f", view.TCM.act.delayLaser_ns));
+            for (quint8 i=0; i<64; ++i) { switchBitButtons.at(i)->setChecked(view.TCM.act.LASER_PATTERN & (1ULL << i)); }
+            showText(ui->labelValueSuppressDuration, QString::asprintf("%d", view.TCM.act.lsrTrgSupprDur));
+            showText(ui->labelValueSuppressDelayBC , QString::asprintf("%d", view.TCM.act.lsrTrgSupprDelay));
+            showText(ui->labelValueSuppressDelay_ns, QString::asprintf("%.1f", view.TCM.act.lsrTrgSupprDelay * 2 * halfBC_ns));
         } else { //PM
-            ui->labelIconHDMIsyncError->setPixmap(curPM->TRGsync.syncError ?  Red1 : Green0);
-            ui->labelIconHDMIlinkOK->setPixmap(curPM->TRGsync.linkOK ? Green1 : Red0);
-            ui->labelIconHDMIbitsOK->setPixmap(curPM->TRGsync.bitPositionsOK ? Green1 : Red0);
-            ui->labelIconHDMIsignalLost0->setPixmap(curPM->TRGsync.line0signalLost ? Red1 : Green0);
-            ui->labelIconHDMIsignalLost1->setPixmap(curPM->TRGsync.line1signalLost ? Red1 : Green0);
-            ui->labelIconHDMIsignalLost2->setPixmap(curPM->TRGsync.line2signalLost ? Red1 : Green0);
-            ui->labelIconHDMIsignalLost3->setPixmap(curPM->TRGsync.line3signalLost ? Red1 : Green0);
-            ui->labelIconHDMIsignalStable0->setPixmap(curPM->TRGsync.line0signalStable ? Green1 : Red0);
-            ui->labelIconHDMIsignalStable1->setPixmap(curPM->TRGsync.line1signalStable ? Green1 : Red0);
-            ui->labelIconHDMIsignalStable2->setPixmap(curPM->TRGsync.line2signalStable ? Green1 : Red0);
-            ui->labelIconHDMIsignalStable3->setPixmap(curPM->TRGsync.line3signalStable ? Green1 : Red0);
-            ui->labelValueHDMIdelay0->setText(QString::asprintf("%4.2f", curPM->TRGsync.line0delay * TDCunit_ps * 0.006));
-            ui->labelValueHDMIdelay1->setText(QString::asprintf("%4.2f", curPM->TRGsync.line1delay * TDCunit_ps * 0.006));
-            ui->labelValueHDMIdelay2->setText(QString::asprintf("%4.2f", curPM->TRGsync.line2delay * TDCunit_ps * 0.006));
-            ui->labelValueHDMIdelay3->setText(QString::asprintf("%4.2f", curPM->TRGsync.line3delay * TDCunit_ps * 0.006));
-            bool pmUpdated = FEE.PM.contains(curPM->FEEid);
+            showPixmap(ui->labelIconHDMIsyncError, curPMview->TRGsync.syncError ?  Red1 : Green0);
+            showPixmap(ui->labelIconHDMIlinkOK, curPMview->TRGsync.linkOK ? Green1 : Red0);
+            showPixmap(ui->labelIconHDMIbitsOK, curPMview->TRGsync.bitPositionsOK ? Green1 : Red0);
+            showPixmap(ui->labelIconHDMIsignalLost0, curPMview->TRGsync.line0signalLost ? Red1 : Green0);
+            showPixmap(ui->labelIconHDMIsignalLost1, curPMview->TRGsync.line1signalLost ? Red1 : Green0);
+            showPixmap(ui->labelIconHDMIsignalLost2, curPMview->TRGsync.line2signalLost ? Red1 : Green0);
+            showPixmap(ui->labelIconHDMIsignalLost3, curPMview->TRGsync.line3signalLost ? Red1 : Green0);
+            showPixmap(ui->labelIconHDMIsignalStable0, curPMview->TRGsync.line0signalStable ? Green1 : Red0);
+            showPixmap(ui->labelIconHDMIsignalStable1, curPMview->TRGsync.line1signalStable ? Green1 : Red0);
+            showPixmap(ui->labelIconHDMIsignalStable2, curPMview->TRGsync.line2signalStable ? Green1 : Red0);
+            showPixmap(ui->labelIconHDMIsignalStable3, curPMview->TRGsync.line3signalStable ? Green1 : Red0);
+            showText(ui->labelValueHDMIdelay0, QString::asprintf("%4.2f", curPMview->TRGsync.line0delay * TDCunit_ps * 0.006));
+            showText(ui->labelValueHDMIdelay1, QString::asprintf("%4.2f", curPMview->TRGsync.line1delay * TDCunit_ps * 0.006));
+            showText(ui->labelValueHDMIdelay2, QString::asprintf("%4.2f", curPMview->TRGsync.line2delay * TDCunit_ps * 0.006));
+            showText(ui->labelValueHDMIdelay3, QString::asprintf("%4.2f", curPMview->TRGsync.line3delay * TDCunit_ps * 0.006));
+            bool pmUpdated = view.PMpresent & 1 << (curPM - FEE.allPMs);
             foreach (QGroupBox *g, QList<QGroupBox *>({ui->groupBoxChannels, ui->groupBoxPMControl, ui->groupBoxTDCStatus, ui->groupBoxReadoutControl})) g->setEnabled(pmUpdated);
             if (!pmUpdated) return;
-            ui->labelValueORgate->setText   (QString::asprintf("±%3d"    , curPM->act.OR_GATE));
-            ui->labelValueORgate->setToolTip(QString::asprintf("±%.3f ns", curPM->act.OR_GATE * TDCunit_ps / 1000.));
-            ui->labelValueChargeHi->setText(QString::asprintf("%d", curPM->act.TRGchargeLevelHi));
-            ui->labelValueChargeLo->setText(QString::asprintf("%d", curPM->act.TRGchargeLevelLo));
-            switch (curPM->act.restartReasonCode) {
-                case 0 : ui->labelValueRestartCode->setText("power reset"); ui->labelValueRestartCode->setStyleSheet(notOKstyle); break;
-                case 1 : ui->labelValueRestartCode->setText("FPGA reset" ); ui->labelValueRestartCode->setStyleSheet(notOKstyle); break;
-                case 2 : ui->labelValueRestartCode->setText("PLL relock" ); ui->labelValueRestartCode->setStyleSheet(notOKstyle); break;
-                case 3 : ui->labelValueRestartCode->setText("SPI command"); ui->labelValueRestartCode->setStyleSheet(   OKstyle); break;
+            ui->labelValueORgate->setText   (QString::asprintf("±%3d"    , curPMview->act.OR_GATE));
+            ui->labelValueORgate->setToolTip(QString::asprintf("±%.3f ns", curPMview->act.OR_GATE * TDCunit_ps / 1000.));
+            showText(ui->labelValueChargeHi, QString::asprintf("%d", curPMview->act.TRGchargeLevelHi));
+            showText(ui->labelValueChargeLo, QString::asprintf("%d", curPMview->act.TRGchargeLevelLo));
+            switch (curPMview->act.restartReasonCode) {
+                case 0 : showText(ui->labelValueRestartCode, "power reset"); showStyleSheet(ui->labelValueRestartCode, notOKstyle); break;
+                case 1 : showText(ui->labelValueRestartCode, "FPGA reset" ); showStyleSheet(ui->labelValueRestartCode, notOKstyle); break;
+                case 2 : showText(ui->labelValueRestartCode, "PLL relock" ); showStyleSheet(ui->labelValueRestartCode, notOKstyle); break;
+                case 3 : showText(ui->labelValueRestartCode, "SPI command"); showStyleSheet(ui->labelValueRestartCode,    OKstyle); break;
             }
-//            curPM->act.TRG_CNT_MODE ? ui->radioButtonCFDinGate->setChecked(true) : ui->radioButtonStrict->setChecked(true);
-            ui->buttonCFDinGate->setChecked( curPM->act.TRG_CNT_MODE);
-            ui->buttonStrict   ->setChecked(!curPM->act.TRG_CNT_MODE);
-            ui->labelIconSyncErrorTDC1->setPixmap(curPM->act.TDC1syncError ? Red1 : Green0);
-            ui->labelIconSyncErrorTDC2->setPixmap(curPM->act.TDC2syncError ? Red1 : Green0);
-            ui->labelIconSyncErrorTDC3->setPixmap(curPM->act.TDC3syncError ? Red1 : Green0);
-            ui->labelIconPLLlockedTDC1->setPixmap(curPM->act.TDC1PLLlocked ? Green1 : Red0);
-            ui->labelIconPLLlockedTDC2->setPixmap(curPM->act.TDC2PLLlocked ? Green1 : Red0);
-            ui->labelIconPLLlockedTDC3->setPixmap(curPM->act.TDC3PLLlocked ? Green1 : Red0);
-            ui->labelIconPLLlockedMain->setPixmap(curPM->act.mainPLLlocked ? Green1 : Red0);
-            ui->labelValuePhaseTuningTDC1->setText(QString::asprintf("%.0f", curPM->act.TDC1tuning * TDCunit_ps * 8/7));
-            ui->labelValuePhaseTuningTDC2->setText(QString::asprintf("%.0f", curPM->act.TDC2tuning * TDCunit_ps * 8/7));
-            ui->labelValuePhaseTuningTDC3->setText(QString::asprintf("%.0f", curPM->act.TDC3tuning * TDCunit_ps * 8/7));
-            ui->checkBoxPairChannels->setChecked(curPM->act.PairedChannelsMode);
+//            curPMview->act.TRG_CNT_MODE ? ui->radioButtonCFDinGate->setChecked(true) : ui->radioButtonStrict->setChecked(true);
+            ui->buttonCFDinGate->setChecked( curPMview->act.TRG_CNT_MODE);
+            ui->buttonStrict   ->setChecked(!curPMview->act.TRG_CNT_MODE);
+            showPixmap(ui->labelIconSyncErrorTDC1, curPMview->act.TDC1syncError ? Red1 : Green0);
+            showPixmap(ui->labelIconSyncErrorTDC2, curPMview->act.TDC2syncError ? Red1 : Green0);
+            showPixmap(ui->labelIconSyncErrorTDC3, curPMview->act.TDC3syncError ? Red1 : Green0);
+            showPixmap(ui->labelIconPLLlockedTDC1, curPMview->act.TDC1PLLlocked ? Green1 : Red0);
+            showPixmap(ui->labelIconPLLlockedTDC2, curPMview->act.TDC2PLLlocked ? Green1 : Red0);
+            showPixmap(ui->labelIconPLLlockedTDC3, curPMview->act.TDC3PLLlocked ? Green1 : Red0);
+            showPixmap(ui->labelIconPLLlockedMain, curPMview->act.mainPLLlocked ? Green1 : Red0);
+            showText(ui->labelValuePhaseTuningTDC1, QString::asprintf("%.0f", curPMview->act.TDC1tuning * TDCunit_ps * 8/7));
+            showText(ui->labelValuePhaseTuningTDC2, QString::asprintf("%.0f", curPMview->act.TDC2tuning * TDCunit_ps * 8/7));
+            showText(ui->labelValuePhaseTuningTDC3, QString::asprintf("%.0f", curPMview->act.TDC3tuning * TDCunit_ps * 8/7));
+            ui->checkBoxPairChannels->setChecked(curPMview->act.PairedChannelsMode);
             for (quint8 iCh=0; iCh<12; ++iCh) {
-                switchesCh[iCh]->setChecked(curPM->act.CH_MASK_DATA & (1 << iCh));
-                noTRGCh[iCh]->setChecked(curPM->act.timeAlignment[iCh].blockTriggers);
-                labelsTimeAlignmentCh    [iCh]->setText(QString::asprintf("%d", curPM->act.TIME_ALIGN[iCh]));
-                labelsThresholdCalibrCh  [iCh]->setText(QString::asprintf("%d", curPM->act.THRESHOLD_CALIBR[iCh]));
-                labelsADCdelayCh         [iCh]->setText(QString::asprintf("%d", curPM->act.Ch[iCh].ADC_DELAY));
-                labelsCFDthresholdCh     [iCh]->setText(QString::asprintf("%d", curPM->act.Ch[iCh].CFD_THRESHOLD));
-                labelsADCzeroCh          [iCh]->setText(QString::asprintf("%d", curPM->act.Ch[iCh].ADC_ZERO));
-                labelsCFDzeroCh          [iCh]->setText(QString::asprintf("%d", curPM->act.Ch[iCh].CFD_ZERO));
-                labelsADC0rangeCh        [iCh]->setText(QString::asprintf("%d", curPM->act.ADC_RANGE[iCh][0]));
-                labelsADC1rangeCh        [iCh]->setText(QString::asprintf("%d", curPM->act.ADC_RANGE[iCh][1]));
-                labelsADC0baseLineCh     [iCh]->setText(QString::asprintf("%d", curPM->act.ADC_BASELINE[iCh][0]));
-                labelsADC1baseLineCh     [iCh]->setText(QString::asprintf("%d", curPM->act.ADC_BASELINE[iCh][1]));
-                labelsADC0baseLineCh     [iCh]->setStyleSheet(curPM->act.CH_BASELINES_NOK & (1 << iCh) ? notOKstyle : neutralStyle);
-                labelsADC1baseLineCh     [iCh]->setStyleSheet(curPM->act.CH_BASELINES_NOK & (1 << iCh) ? notOKstyle : neutralStyle);
-                labelsADC0RMSCh          [iCh]->setText(QString::asprintf( "%5.1f", curPM->act.RMS_Ch[iCh][0]));
-                labelsADC1RMSCh          [iCh]->setText(QString::asprintf( "%5.1f", curPM->act.RMS_Ch[iCh][1]));
-                labelsADC0meanAmplitudeCh[iCh]->setText(QString::asprintf("%d", curPM->act.MEANAMPL[iCh][0][0]));
-                labelsADC1meanAmplitudeCh[iCh]->setText(QString::asprintf("%d", curPM->act.MEANAMPL[iCh][1][0]));
-                labelsRawTDCdata1Ch      [iCh]->setText(QString::asprintf("%02X", curPM->act.RAW_TDC_DATA[iCh][0]));
-                labelsRawTDCdata2Ch      [iCh]->setText(QString::asprintf("%02X", curPM->act.RAW_TDC_DATA[iCh][1]));
+                switchesCh[iCh]->setChecked(curPMview->act.CH_MASK_DATA & (1 << iCh));
+                noTRGCh[iCh]->setChecked(curPMview->act.timeAlignment[iCh].blockTriggers);
+                showText(labelsTimeAlignmentCh    [iCh], QString::asprintf("%d", curPMview->act.TIME_ALIGN[iCh]));
+                showText(labelsThresholdCalibrCh  [iCh], QString::asprintf("%d", curPMview->act.THRESHOLD_CALIBR[iCh]));
+                showText(labelsADCdelayCh         [iCh], QString::asprintf("%d", curPMview->act.Ch[iCh].ADC_DELAY));
+                showText(labelsCFDthresholdCh     [iCh], QString::asprintf("%d", curPMview->act.Ch[iCh].CFD_THRESHOLD));
+                showText(labelsADCzeroCh          [iCh], QString::asprintf("%d", curPMview->act.Ch[iCh].ADC_ZERO));
+                showText(labelsCFDzeroCh          [iCh], QString::asprintf("%d", curPMview->act.Ch[iCh].CFD_ZERO));
+                showText(labelsADC0rangeCh        [iCh], QString::asprintf("%d", curPMview->act.ADC_RANGE[iCh][0]));
+                showText(labelsADC1rangeCh        [iCh], QString::asprintf("%d", curPMview->act.ADC_RANGE[iCh][1]));
+                showText(labelsADC0baseLineCh     [iCh], QString::asprintf("%d", curPMview->act.ADC_BASELINE[iCh][0]));
+                showText(labelsADC1baseLineCh     [iCh], QString::asprintf("%d", curPMview->act.ADC_BASELINE[iCh][1]));
+                showStyleSheet(labelsADC0baseLineCh     [iCh], curPMview->act.CH_BASELINES_NOK & (1 << iCh) ? notOKstyle : neutralStyle);
+                showStyleSheet(labelsADC1baseLineCh     [iCh], curPMview->act.CH_BASELINES_NOK & (1 << iCh) ? notOKstyle : neutralStyle);
+                showText(labelsADC0RMSCh          [iCh], QString::asprintf( "%5.1f", curPMview->act.RMS_Ch[iCh][0]));
+                showText(labelsADC1RMSCh          [iCh], QString::asprintf( "%5.1f", curPMview->act.RMS_Ch[iCh][1]));
+                showText(labelsADC0meanAmplitudeCh[iCh], QString::asprintf("%d", curPMview->act.MEANAMPL[iCh][0][0]));
+                showText(labelsADC1meanAmplitudeCh[iCh], QString::asprintf("%d", curPMview->act.MEANAMPL[iCh][1][0]));
+                showText(labelsRawTDCdata1Ch      [iCh], QString::asprintf("%02X", curPMview->act.RAW_TDC_DATA[iCh][0]));
+                showText(labelsRawTDCdata2Ch      [iCh], QString::asprintf("%02X", curPMview->act.RAW_TDC_DATA[iCh][1]));
             }
         }
     }
 
     void updateEdits() {
         if (isTCM()) {
-            ui->spinBoxPhase_A->setValue(FEE.TCM.set.DELAY_A * phaseStep_ns);
-            ui->spinBoxPhase_C->setValue(FEE.TCM.set.DELAY_C * phaseStep_ns);
-            ui->lineEditTriggersRandomRate_1->setText(QString::asprintf("%08X", FEE.TCM.set.T1_RATE));
-            ui->lineEditTriggersRandomRate_2->setText(QString::asprintf("%08X", FEE.TCM.set.T2_RATE));
-            ui->lineEditTriggersRandomRate_3->setText(QString::asprintf("%08X", FEE.TCM.set.T3_RATE));
-            ui->lineEditTriggersRandomRate_4->setText(QString::asprintf("%08X", FEE.TCM.set.T4_RATE));
-            ui->lineEditTriggersRandomRate_5->setText(QString::asprintf("%08X", FEE.TCM.set.T5_RATE));
-            ui->lineEditTriggersLevelA_1->setText(QString::asprintf("%d", FEE.TCM.set.T1_LEVEL_A));
-            ui->lineEditTriggersLevelC_1->setText(QString::asprintf("%d", FEE.TCM.set.T1_LEVEL_C));
-            ui->lineEditTriggersLevelA_2->setText(QString::asprintf("%d", FEE.TCM.set.T2_LEVEL_A));
-            ui->lineEditTriggersLevelC_2->setText(QString::asprintf("%d", FEE.TCM.set.T2_LEVEL_C));
-            ui->lineEditVertexTimeLow ->setText(QString::asprintf("%d", FEE.TCM.set.VTIME_LOW ));
-            ui->lineEditVertexTimeHigh->setText(QString::asprintf("%d", FEE.TCM.set.VTIME_HIGH));
-            ui->sliderAttenuation->setValue(FEE.TCM.set.attenSteps);
-            if (ui->spinBoxAttenuation->value() != FEE.TCM.set.attenSteps) ui->spinBoxAttenuation->setValue(FEE.TCM.set.attenSteps);
-            ui->spinBoxLaserFreqDivider->setValue(FEE.TCM.set.LASER_DIVIDER);
-            ui->lineEditLaserPattern->setText(QString::asprintf("%016llX", FEE.TCM.set.LASER_PATTERN));
-            ui->sliderLaser->setValue(FEE.TCM.set.LASER_DELAY);
-            if (ui->spinBoxLaserPhase->value() != FEE.TCM.set.delayLaser_ns) ui->spinBoxLaserPhase->setValue(FEE.TCM.set.delayLaser_ns);
-            ui->spinBoxSuppressDuration->setValue(FEE.TCM.set.lsrTrgSupprDur);
-            ui->spinBoxSuppressDelayBC->setValue(FEE.TCM.set.lsrTrgSupprDelay);
+            ui->spinBoxPhase_A->setValue(view.TCM.set.DELAY_A * phaseStep_ns);
+            ui->spinBoxPhase_C->setValue(view.TCM.set.DELAY_C * phaseStep_ns);
+            ui->lineEditTriggersRandomRate_1->setText(QString::asprintf("%08X", view.TCM.set.T1_RATE));
+            ui->lineEditTriggersRandomRate_2->setText(QString::asprintf("%08X", view.TCM.set.T2_RATE));
+            ui->lineEditTriggersRandomRate_3->setText(QString::asprintf("%08X", view.TCM.set.T3_RATE));
+            ui->lineEditTriggersRandomRate_4->setText(QString::asprintf("%08X", view.TCM.set.T4_RATE));
+            ui->lineEditTriggersRandomRate_5->setText(QString::asprintf("%08X", view.TCM.set.T5_RATE));
+            ui->lineEditTriggersLevelA_1->setText(QString::asprintf("%d", view.TCM.set.T1_LEVEL_A));
+            ui->lineEditTriggersLevelC_1->setText(QString::asprintf("%d", view.TCM.set.T1_LEVEL_C));
+            ui->lineEditTriggersLevelA_2->setText(QString::asprintf("%d", view.TCM.set.T2_LEVEL_A));
+            ui->lineEditTriggersLevelC_2->setText(QString::asprintf("%d", view.TCM.set.T2_LEVEL_C));
+            ui->lineEditVertexTimeLow ->setText(QString::asprintf("%d", view.TCM.set.VTIME_LOW ));
+            ui->lineEditVertexTimeHigh->setText(QString::asprintf("%d", view.TCM.set.VTIME_HIGH));
+            ui->sliderAttenuation->setValue(view.TCM.set.attenSteps);
+            if (ui->spinBoxAttenuation->value() != view.TCM.set.attenSteps) ui->spinBoxAttenuation->setValue(view.TCM.set.attenSteps);
+            ui->spinBoxLaserFreqDivider->setValue(view.TCM.set.LASER_DIVIDER);
+            ui->lineEditLaserPattern->setText(QString::asprintf("%016llX", view.TCM.set.LASER_PATTERN));
+            ui->sliderLaser->setValue(view.TCM.set.LASER_DELAY);
+            if (ui->spinBoxLaserPhase->value() != view.TCM.set.delayLaser_ns) ui->spinBoxLaserPhase->setValue(view.TCM.set.delayLaser_ns);
+            ui->spinBoxSuppressDuration->setValue(view.TCM.set.lsrTrgSupprDur);
+            ui->spinBoxSuppressDelayBC->setValue(view.TCM.set.lsrTrgSupprDelay);
         } else { //PM
-            ui->lineEditORgate->setText(QString::asprintf("%d", curPM->set.OR_GATE));
-            ui->lineEditChargeHi->setText(QString::asprintf("%d", curPM->set.TRGchargeLevelHi));
-            ui->lineEditChargeLo->setText(QString::asprintf("%d", curPM->set.TRGchargeLevelLo));
+            ui->lineEditORgate->setText(QString::asprintf("%d", curPMview->set.OR_GATE));
+            ui->lineEditChargeHi->setText(QString::asprintf("%d", curPMview->set.TRGchargeLevelHi));
+            ui->lineEditChargeLo->setText(QString::asprintf("%d", curPMview->set.TRGchargeLevelLo));
             for (quint8 i=0; i<12; ++i) {
-                editsTimeAlignmentCh  [i]->setText(QString::asprintf("%d", curPM->set.TIME_ALIGN[i].value));
-                editsThresholdCalibrCh[i]->setText(QString::asprintf("%d", curPM->set.THRESHOLD_CALIBR[i]));
-                editsADCdelayCh       [i]->setText(QString::asprintf("%d", curPM->set.Ch[i].ADC_DELAY));
-                editsCFDthresholdCh   [i]->setText(QString::asprintf("%d", curPM->set.Ch[i].CFD_THRESHOLD));
-                editsADCzeroCh        [i]->setText(QString::asprintf("%d", curPM->set.Ch[i].ADC_ZERO));
-                editsCFDzeroCh        [i]->setText(QString::asprintf("%d", curPM->set.Ch[i].CFD_ZERO));
-                editsADC0rangeCh      [i]->setText(QString::asprintf("%d", curPM->set.ADC_RANGE[i][0]));
-                editsADC1rangeCh      [i]->setText(QString::asprintf("%d", curPM->set.ADC_RANGE[i][1]));
+                editsTimeAlignmentCh  [i]->setText(QString::asprintf("%d", curPMview->set.TIME_ALIGN[i].value));
+                editsThresholdCalibrCh[i]->setText(QString::asprintf("%d", curPMview->set.THRESHOLD_CALIBR[i]));
+                editsADCdelayCh       [i]->setText(QString::asprintf("%d", curPMview->set.Ch[i].ADC_DELAY));
+                editsCFDthresholdCh   [i]->setText(QString::asprintf("%d", curPMview->set.Ch[i].CFD_THRESHOLD));
+                editsADCzeroCh        [i]->setText(QString::asprintf("%d", curPMview->set.Ch[i].ADC_ZERO));
+                editsCFDzeroCh        [i]->setText(QString::asprintf("%d", curPMview->set.Ch[i].CFD_ZERO));
+                editsADC0rangeCh      [i]->setText(QString::asprintf("%d", curPMview->set.ADC_RANGE[i][0]));
+                editsADC1rangeCh      [i]->setText(QString::asprintf("%d", curPMview->set.ADC_RANGE[i][1]));
             }
         }
-        ui->lineEditDGtriggerRespondMask  ->setText(QString::asprintf("%08X", curGBTset->DG_TRG_RESPOND_MASK  ));
-        ui->lineEditDGbunchPattern        ->setText(QString::asprintf("%08X", curGBTset->DG_BUNCH_PATTERN    ));
-        ui->lineEditDGbunchFrequency      ->setText(QString::asprintf("%04X", curGBTset->DG_BUNCH_FREQ      ));
-        ui->lineEditDGfrequencyOffset     ->setText(QString::asprintf("%03X", curGBTset->DG_FREQ_OFFSET      ));
-        ui->lineEditTGcontinuousValue     ->setText(QString::asprintf("%08X", curGBTset->TG_CONT_VALUE      ));
-        ui->lineEditTGbunchFrequency      ->setText(QString::asprintf("%04X", curGBTset->TG_BUNCH_FREQ      ));
-        ui->lineEditTGfrequencyOffset     ->setText(QString::asprintf("%03X", curGBTset->TG_FREQ_OFFSET      ));
-        ui->lineEditBCIDdelayHex          ->setText(QString::asprintf("%03X", curGBTset->BCID_DELAY        ));
-        ui->lineEditBCIDdelayDec          ->setText(QString::asprintf("%d"  , curGBTset->BCID_DELAY        ));
-        ui->lineEditDataSelectTriggerMask ->setText(QString::asprintf("%08X", curGBTset->DATA_SEL_TRG_MASK    ));
-        ui->lineEditTGHBrRate             ->setText(QString::asprintf("%d"  , curGBTset->TG_HBr_RATE        ));
-        ui->lineEditTGcontinuousPattern   ->setText(QString::asprintf("%08X%08X", curGBTset->TG_PATTERN_MSB, curGBTset->TG_PATTERN_LSB));
+        const GBTunit::ControlData &gbt = isTCM() ? view.TCM.set.GBT : curPMview->set.GBT;
+        ui->lineEditDGtriggerRespondMask  ->setText(QString::asprintf("%08X", gbt.DG_TRG_RESPOND_MASK  ));
+        ui->lineEditDGbunchPattern        ->setText(QString::asprintf("%08X", gbt.DG_BUNCH_PATTERN    ));
+        ui->lineEditDGbunchFrequency      ->setText(QString::asprintf("%04X", gbt.DG_BUNCH_FREQ      ));
+        ui->lineEditDGfrequencyOffset     ->setText(QString::asprintf("%03X", gbt.DG_FREQ_OFFSET      ));
+        ui->lineEditTGcontinuousValue     ->setText(QString::asprintf("%08X", gbt.TG_CONT_VALUE      ));
+        ui->lineEditTGbunchFrequency      ->setText(QString::asprintf("%04X", gbt.TG_BUNCH_FREQ      ));
+        ui->lineEditTGfrequencyOffset     ->setText(QString::asprintf("%03X", gbt.TG_FREQ_OFFSET      ));
+        ui->lineEditBCIDdelayHex          ->setText(QString::asprintf("%03X", gbt.BCID_DELAY        ));
+        ui->lineEditBCIDdelayDec          ->setText(QString::asprintf("%d"  , gbt.BCID_DELAY        ));
+        ui->lineEditDataSelectTriggerMask ->setText(QString::asprintf("%08X", gbt.DATA_SEL_TRG_MASK    ));
+        ui->lineEditTGHBrRate             ->setText(QString::asprintf("%d"  , gbt.TG_HBr_RATE        ));
+        ui->lineEditTGcontinuousPattern   ->setText(QString::asprintf("%08X%08X", gbt.TG_PATTERN_MSB, gbt.TG_PATTERN_LSB));
         resetHighlight();
     }
 
@@ -986,77 +1054,85 @@ public slots:
         if (FEEid != curFEEid) return;
         if (isTCM()) {
             for (quint8 i=0; i<TypeTCM::Counters::number; ++i) {
-                labelsTCMcounters[i].count->setText(QString::number(FEE.TCM.counters.New[i]));
-                labelsTCMcounters[i].rate ->setText(rateFormat(FEE.TCM.counters.rate[i]));
+                labelsTCMcounters[i].count->setText(QString::number(view.TCM.counters.New[i]));
+                labelsTCMcounters[i].rate ->setText(rateFormat(view.TCM.counters.rate[i]));
             }
         } else { //PM
             for (quint8 i=0; i<12; ++i) {
-                labelsTRGcounterCh[i]->setText(QString::number(curPM->counters.Ch[i].TRG));
-                labelsCFDcounterCh[i]->setText(QString::number(curPM->counters.Ch[i].CFD));
-                labelsTRGcounterRateCh[i]->setText(rateFormat(curPM->counters.rateCh[i].TRG));
-                labelsCFDcounterRateCh[i]->setText(rateFormat(curPM->counters.rateCh[i].CFD));
+                labelsTRGcounterCh[i]->setText(QString::number(curPMview->counters.Ch[i].TRG));
+                labelsCFDcounterCh[i]->setText(QString::number(curPMview->counters.Ch[i].CFD));
+                labelsTRGcounterRateCh[i]->setText(rateFormat(curPMview->counters.rateCh[i].TRG));
+                labelsCFDcounterRateCh[i]->setText(rateFormat(curPMview->counters.rateCh[i].CFD));
             }
         }
     }
 
     void on_buttonResetCounters_clicked() {
-        curGBTact->Status. wordsCount = FEE.readRegister((isTCM() ? 0 : curPM->baseAddress) + 0xED);
-        curGBTact->Status.eventsCount = FEE.readRegister((isTCM() ? 0 : curPM->baseAddress) + 0xF1);
-        curGBTcnt->calculateRate(curGBTact->Status.wordsCount, curGBTact->Status.eventsCount);
-        curGBTcnt-> wordsOld = 0;
-        curGBTcnt->eventsOld = 0;
-        FEE.reset(curFEEid, GBTunit::RB_dataCounter);
+        quint16 FEEid = curFEEid;
+        FEE.post([=, pm = isTCM() ? nullptr : curPM]() {
+            GBTunit     *act = pm ? &pm->act.GBT      : &FEE.TCM.act.GBT;
+            GBTcounters *cnt = pm ? &pm->counters.GBT : &FEE.TCM.counters.GBT;
+            quint32 baseAddress = pm ? pm->baseAddress : 0;
+            act->Status. wordsCount = FEE.readRegister(baseAddress + 0xED);
+            act->Status.eventsCount = FEE.readRegister(baseAddress + 0xF1);
+            cnt->calculateRate(act->Status.wordsCount, act->Status.eventsCount);
+            cnt-> wordsOld = 0;
+            cnt->eventsOld = 0;
+            FEE.reset(FEEid, GBTunit::RB_dataCounter);
+        });
     }
-    void on_buttonResetOffset_clicked                () { FEE.reset(curFEEid, GBTunit::RB_generatorsBunchOffset); }
-    void on_buttonResetOrbitSync_clicked             () { FEE.reset(curFEEid, GBTunit::RB_orbitSync            ); }
-    void on_buttonResetGBTRxErrors_clicked           () { FEE.reset(curFEEid, GBTunit::RB_GBTRxError           ); }
-    void on_buttonResetGBT_clicked                   () { FEE.reset(curFEEid, GBTunit::RB_GBT                  ); }
-    void on_buttonResetRxPhaseError_clicked          () { FEE.reset(curFEEid, GBTunit::RB_RXphaseError         ); }
-    void on_buttonDataGeneratorOff_clicked           () { FEE.apply_DG_MODE(curFEEid, GBTunit::DG_noData); }
-    void on_buttonDataGeneratorMain_clicked          () { FEE.apply_DG_MODE(curFEEid, GBTunit::DG_main  ); }
-    void on_buttonDataGeneratorTx_clicked            () { FEE.apply_DG_MODE(curFEEid, GBTunit::DG_Tx    ); }
-    void on_buttonApplyDGtriggerRespondMask_clicked  () { FEE.apply_DG_TRG_RESPOND_MASK(curFEEid); }
-    void on_buttonApplyDGbunchPattern_clicked        () { on_lineEditDGbunchPattern_textEdited   (); FEE.apply_DG_BUNCH_PATTERN   (curFEEid); }
-    void on_buttonApplyDGbunchFrequency_clicked      () { on_lineEditDGbunchFrequency_textEdited (); FEE.apply_DG_BUNCH_FREQ      (curFEEid); }
-    void on_buttonApplyDGfrequencyOffset_clicked     () { on_lineEditDGfrequencyOffset_textEdited(); FEE.apply_DG_FREQ_OFFSET     (curFEEid); }
-    void on_buttonTriggerGeneratorOff_clicked        () { FEE.apply_TG_MODE(curFEEid, GBTunit::TG_noTrigger ); }
-    void on_buttonTriggerGeneratorContinuous_clicked () { FEE.apply_TG_MODE(curFEEid, GBTunit::TG_continuous); }
-    void on_buttonTriggerGeneratorTx_clicked         () { FEE.apply_TG_MODE(curFEEid, GBTunit::TG_Tx        ); }
-    void on_buttonApplyTGcontinuousPattern_clicked   () { on_lineEditTGcontinuousPattern_textEdited  (); FEE.apply_TG_PATTERN       (curFEEid); }
-    void on_buttonApplyTGcontinuousValue_clicked     () { on_lineEditTGcontinuousValue_textEdited    (); FEE.apply_TG_CONT_VALUE    (curFEEid); }
-    void on_buttonApplyTGbunchFrequency_clicked      () { on_lineEditTGbunchFrequency_textEdited     (); FEE.apply_TG_BUNCH_FREQ    (curFEEid); }
-    void on_buttonApplyTGfrequencyOffset_clicked     () { on_lineEditTGfrequencyOffset_textEdited    (); FEE.apply_TG_FREQ_OFFSET   (curFEEid); }
-    void on_buttonApplyBCIDdelay_clicked             () { on_lineEditBCIDdelayHex_textEdited         (); FEE.apply_BCID_DELAY       (curFEEid); }
-    void on_buttonApplyDataSelectTriggerMask_clicked () { on_lineEditDataSelectTriggerMask_textEdited(); FEE.apply_DATA_SEL_TRG_MASK(curFEEid); }
-    void on_buttonApplyTGHBrRate_clicked             () { on_lineEditTGHBrRate_textEdited            (); FEE.apply_TG_HBr_RATE      (curFEEid); }
+    void on_buttonResetOffset_clicked                () { FEE.post([=, FEEid = curFEEid]() { FEE.reset(FEEid, GBTunit::RB_generatorsBunchOffset); }); }
+    void on_buttonResetOrbitSync_clicked             () { FEE.post([=, FEEid = curFEEid]() { FEE.reset(FEEid, GBTunit::RB_orbitSync            ); }); }
+    void on_buttonResetGBTRxErrors_clicked           () { FEE.post([=, FEEid = curFEEid]() { FEE.reset(FEEid, GBTunit::RB_GBTRxError           ); }); }
+    void on_buttonResetGBT_clicked                   () { FEE.post([=, FEEid = curFEEid]() { FEE.reset(FEEid, GBTunit::RB_GBT                  ); }); }
+    void on_buttonResetRxPhaseError_clicked          () { FEE.post([=, FEEid = curFEEid]() { FEE.reset(FEEid, GBTunit::RB_RXphaseError         ); }); }
+    void on_buttonDataGeneratorOff_clicked           () { FEE.post([=, FEEid = curFEEid]() { FEE.apply_DG_MODE(FEEid, GBTunit::DG_noData); }); }
+    void on_buttonDataGeneratorMain_clicked          () { FEE.post([=, FEEid = curFEEid]() { FEE.apply_DG_MODE(FEEid, GBTunit::DG_main  ); }); }
+    void on_buttonDataGeneratorTx_clicked            () { FEE.post([=, FEEid = curFEEid]() { FEE.apply_DG_MODE(FEEid, GBTunit::DG_Tx    ); }); }
+    void on_buttonApplyDGtriggerRespondMask_clicked  () { FEE.post([=, FEEid = curFEEid]() { FEE.apply_DG_TRG_RESPOND_MASK(FEEid); }); }
+    void on_buttonApplyDGbunchPattern_clicked        () { on_lineEditDGbunchPattern_textEdited   (); FEE.post([=, FEEid = curFEEid]() { FEE.apply_DG_BUNCH_PATTERN   (FEEid); }); }
+    void on_buttonApplyDGbunchFrequency_clicked      () { on_lineEditDGbunchFrequency_textEdited (); FEE.post([=, FEEid = curFEEid]() { FEE.apply_DG_BUNCH_FREQ      (FEEid); }); }
+    void on_buttonApplyDGfrequencyOffset_clicked     () { on_lineEditDGfrequencyOffset_textEdited(); FEE.post([=, FEEid = curFEEid]() { FEE.apply_DG_FREQ_OFFSET     (FEEid); }); }
+    void on_buttonTriggerGeneratorOff_clicked        () { FEE.post([=, FEEid = curFEEid]() { FEE.apply_TG_MODE(FEEid, GBTunit::TG_noTrigger ); }); }
+    void on_buttonTriggerGeneratorContinuous_clicked () { FEE.post([=, FEEid = curFEEid]() { FEE.apply_TG_MODE(FEEid, GBTunit::TG_continuous); }); }
+    void on_buttonTriggerGeneratorTx_clicked         () { FEE.post([=, FEEid = curFEEid]() { FEE.apply_TG_MODE(FEEid, GBTunit::TG_Tx        ); }); }
+    void on_buttonApplyTGcontinuousPattern_clicked   () { on_lineEditTGcontinuousPattern_textEdited  (); FEE.post([=, FEEid = curFEEid]() { FEE.apply_TG_PATTERN       (FEEid); }); }
+    void on_buttonApplyTGcontinuousValue_clicked     () { on_lineEditTGcontinuousValue_textEdited    (); FEE.post([=, FEEid = curFEEid]() { FEE.apply_TG_CONT_VALUE    (FEEid); }); }
+    void on_buttonApplyTGbunchFrequency_clicked      () { on_lineEditTGbunchFrequency_textEdited     (); FEE.post([=, FEEid = curFEEid]() { FEE.apply_TG_BUNCH_FREQ    (FEEid); }); }
+    void on_buttonApplyTGfrequencyOffset_clicked     () { on_lineEditTGfrequencyOffset_textEdited    (); FEE.post([=, FEEid = curFEEid]() { FEE.apply_TG_FREQ_OFFSET   (FEEid); }); }
+    void on_buttonApplyBCIDdelay_clicked             () { on_lineEditBCIDdelayHex_textEdited         (); FEE.post([=, FEEid = curFEEid]() { FEE.apply_BCID_DELAY       (FEEid); }); }
+    void on_buttonApplyDataSelectTriggerMask_clicked () { on_lineEditDataSelectTriggerMask_textEdited(); FEE.post([=, FEEid = curFEEid]() { FEE.apply_DATA_SEL_TRG_MASK(FEEid); }); }
+    void on_buttonApplyTGHBrRate_clicked             () { on_lineEditTGHBrRate_textEdited            (); FEE.post([=, FEEid = curFEEid]() { FEE.apply_TG_HBr_RATE      (FEEid); }); }
     void on_SwitcherLockReadout_clicked() {
         ui->SwitcherLockReadout->setChecked(false);
-        FEE.apply_RESET_FSM(curFEEid,  false);
+        FEE.post([=, FEEid = curFEEid]() { FEE.apply_RESET_FSM(FEEid,  false); });
     }
 
-    void on_SwitcherBypassMode_clicked (bool checked) { FEE.apply_BYPASS_MODE (curFEEid,  checked); }
-    void on_SwitcherHBresponse_clicked (bool checked) { FEE.apply_HB_RESPONSE (curFEEid, !checked); }
-    void on_SwitcherHBreject_clicked   (bool checked) { FEE.apply_HB_REJECT   (curFEEid, !checked); }
-    void on_SwitcherShiftRxPhase_clicked (bool checked) { FEE.apply_shiftRxPhase(curFEEid, !checked); }
-    void on_lineEditDGtriggerRespondMask_textEdited  () { curGBTset->DG_TRG_RESPOND_MASK = ui->lineEditDGtriggerRespondMask->displayText().toUInt(&ok, 16); }
-    void on_lineEditDGbunchPattern_textEdited        () { curGBTset->DG_BUNCH_PATTERN  = ui->lineEditDGbunchPattern        ->displayText().toUInt(&ok, 16); }
-    void on_lineEditDGbunchFrequency_textEdited      () { curGBTset->DG_BUNCH_FREQ     = ui->lineEditDGbunchFrequency      ->displayText().toUInt(&ok, 16); }
-    void on_lineEditDGfrequencyOffset_textEdited     () { curGBTset->DG_FREQ_OFFSET    = ui->lineEditDGfrequencyOffset     ->displayText().toUInt(&ok, 16); }
-    void on_lineEditTGcontinuousValue_textEdited     () { curGBTset->TG_CONT_VALUE     = ui->lineEditTGcontinuousValue     ->displayText().toUInt(&ok, 16); }
-    void on_lineEditTGbunchFrequency_textEdited      () { curGBTset->TG_BUNCH_FREQ     = ui->lineEditTGbunchFrequency      ->displayText().toUInt(&ok, 16); }
-    void on_lineEditTGfrequencyOffset_textEdited     () { curGBTset->TG_FREQ_OFFSET    = ui->lineEditTGfrequencyOffset     ->displayText().toUInt(&ok, 16); }
-    void on_lineEditDataSelectTriggerMask_textEdited () { curGBTset->DATA_SEL_TRG_MASK = ui->lineEditDataSelectTriggerMask ->displayText().toUInt(&ok, 16); }
-    void on_lineEditTGHBrRate_textEdited             () { curGBTset->TG_HBr_RATE       = ui->lineEditTGHBrRate             ->displayText().toUInt()       ; }
-    void on_lineEditTGcontinuousPattern_textEdited   () { curGBTset->TG_PATTERN_LSB = ui->lineEditTGcontinuousPattern->displayText().right(8).toUInt(&ok, 16);
-                                                          curGBTset->TG_PATTERN_MSB = ui->lineEditTGcontinuousPattern->displayText().left (8).toUInt(&ok, 16); }
-    void on_comboBoxLTUemuReadoutMode_activated(int index) { curGBTset->TG_CTP_EMUL_MODE = index; FEE.apply_TG_CTP_EMUL_MODE(curFEEid, index); }
+    void on_SwitcherBypassMode_clicked (bool checked) { FEE.post([=, FEEid = curFEEid]() { FEE.apply_BYPASS_MODE (FEEid,  checked); }); }
+    void on_SwitcherHBresponse_clicked (bool checked) { FEE.post([=, FEEid = curFEEid]() { FEE.apply_HB_RESPONSE (FEEid, !checked); }); }
+    void on_SwitcherHBreject_clicked   (bool checked) { FEE.post([=, FEEid = curFEEid]() { FEE.apply_HB_REJECT   (FEEid, !checked); }); }
+    void on_SwitcherShiftRxPhase_clicked (bool checked) { FEE.post([=, FEEid = curFEEid]() { FEE.apply_shiftRxPhase(FEEid, !checked); }); }
+    void on_lineEditDGtriggerRespondMask_textEdited  () { FEE.post([=, gbt = curGBTset, v = ui->lineEditDGtriggerRespondMask->displayText().toUInt(&ok, 16)]() { gbt->DG_TRG_RESPOND_MASK = v; }); }
+    void on_lineEditDGbunchPattern_textEdited        () { FEE.post([=, gbt = curGBTset, v = ui->lineEditDGbunchPattern        ->displayText().toUInt(&ok, 16)]() { gbt->DG_BUNCH_PATTERN  = v; }); }
+    void on_lineEditDGbunchFrequency_textEdited      () { FEE.post([=, gbt = curGBTset, v = ui->lineEditDGbunchFrequency      ->displayText().toUInt(&ok, 16)]() { gbt->DG_BUNCH_FREQ     = v; }); }
+    void on_lineEditDGfrequencyOffset_textEdited     () { FEE.post([=, gbt = curGBTset, v = ui->lineEditDGfrequencyOffset     ->displayText().toUInt(&ok, 16)]() { gbt->DG_FREQ_OFFSET    = v; }); }
+    void on_lineEditTGcontinuousValue_textEdited     () { FEE.post([=, gbt = curGBTset, v = ui->lineEditTGcontinuousValue     ->displayText().toUInt(&ok, 16)]() { gbt->TG_CONT_VALUE     = v; }); }
+    void on_lineEditTGbunchFrequency_textEdited      () { FEE.post([=, gbt = curGBTset, v = ui->lineEditTGbunchFrequency      ->displayText().toUInt(&ok, 16)]() { gbt->TG_BUNCH_FREQ     = v; }); }
+    void on_lineEditTGfrequencyOffset_textEdited     () { FEE.post([=, gbt = curGBTset, v = ui->lineEditTGfrequencyOffset     ->displayText().toUInt(&ok, 16)]() { gbt->TG_FREQ_OFFSET    = v; }); }
+    void on_lineEditDataSelectTriggerMask_textEdited () { FEE.post([=, gbt = curGBTset, v = ui->lineEditDataSelectTriggerMask ->displayText().toUInt(&ok, 16)]() { gbt->DATA_SEL_TRG_MASK = v; }); }
+    void on_lineEditTGHBrRate_textEdited             () { FEE.post([=, gbt = curGBTset, v = ui->lineEditTGHBrRate             ->displayText().toUInt()       ]() { gbt->TG_HBr_RATE       = v; }); }
+    void on_lineEditTGcontinuousPattern_textEdited   () { FEE.post([=, gbt = curGBTset, LSB = ui->lineEditTGcontinuousPattern->displayText().right(8).toUInt(&ok, 16),
+                                                                                  MSB = ui->lineEditTGcontinuousPattern->displayText().left (8).toUInt(&ok, 16)]() { gbt->TG_PATTERN_LSB = LSB; gbt->TG_PATTERN_MSB = MSB; }); }
+    void on_comboBoxLTUemuReadoutMode_activated(int index) { FEE.post([=, gbt = curGBTset, FEEid = curFEEid]() { gbt->TG_CTP_EMUL_MODE = index; FEE.apply_TG_CTP_EMUL_MODE(FEEid, index); }); }
     void on_lineEditBCIDdelayHex_textEdited() {
-        curGBTset->BCID_DELAY = ui->lineEditBCIDdelayHex->displayText().toUInt(&ok, 16);
-        ui->lineEditBCIDdelayDec->setText(QString::asprintf("%d"  , curGBTset->BCID_DELAY));
+        quint16 delay = ui->lineEditBCIDdelayHex->displayText().toUInt(&ok, 16);
+        FEE.post([=, gbt = curGBTset]() { gbt->BCID_DELAY = delay; });
+        ui->lineEditBCIDdelayDec->setText(QString::asprintf("%d"  , delay));
     }
     void on_lineEditBCIDdelayDec_textEdited() {
-        curGBTset->BCID_DELAY = ui->lineEditBCIDdelayDec->displayText().toUInt(&ok);
-        ui->lineEditBCIDdelayHex->setText(QString::asprintf("%03X"  , curGBTset->BCID_DELAY));
+        quint16 delay = ui->lineEditBCIDdelayDec->displayText().toUInt(&ok);
+        FEE.post([=, gbt = curGBTset]() { gbt->BCID_DELAY = delay; });
+        ui->lineEditBCIDdelayHex->setText(QString::asprintf("%03X"  , delay));
     }
 
     void on_TCM_selector_toggled(bool TCMselected) {
@@ -1073,50 +1149,51 @@ public slots:
         if (TCMselected) {
             curFEEid = FEE.TCMid;
             ui->groupBoxBoardStatus->setTitle("Board status (TCM)");
-            curGBTact = &FEE.TCM.act.GBT;
+            curGBTact = &view.TCM.act.GBT;
             curGBTset = &FEE.TCM.set.GBT;
-            curGBTcnt = &FEE.TCM.counters.GBT;
+            curGBTcnt = &view.TCM.counters.GBT;
             ui->groupBoxReadoutControl->setEnabled(true);
             updateEdits();
             updateCounters(FEE.TCMid);
-            if (FEE.isOnline) FEE.sync();
+            if (FEE.isOnline) FEE.post([=]() { FEE.syncAll(); });
         }
     }
 
-    void selectPM(quint16 FEEid) {
-        ui->groupBoxPM->setTitle(QString("PM") + FEE.PM[FEEid]->name);
-        ui->groupBoxBoardStatus->setTitle(QString::asprintf("Board status (PM%s)", FEE.PM[FEEid]->name));
-        curFEEid = FEEid;
-        curPM = FEE.PM[FEEid];
-        curGBTact = &curPM->act.GBT;
+    void selectPM(quint8 iPM) { //by link №: FEE.PM belongs to the I/O thread
+        curPM = FEE.allPMs + iPM;
+        ui->groupBoxPM->setTitle(QString("PM") + curPM->name);
+        ui->groupBoxBoardStatus->setTitle(QString::asprintf("Board status (PM%s)", curPM->name));
+        curPMview = view.PM + iPM;
+        curFEEid = curPM->FEEid;
+        curGBTact = &curPMview->act.GBT;
         curGBTset = &curPM->set.GBT;
-        curGBTcnt = &curPM->counters.GBT;
+        curGBTcnt = &curPMview->counters.GBT;
         updateEdits();
         updateCounters(curFEEid);
-        if (FEE.isOnline) FEE.sync();
+        if (FEE.isOnline) FEE.post([=]() { FEE.syncAll(); });
     }
 
-    void on_comboBoxUpdatePeriod_activated(int index) { /*if (FEE.TCM.act.COUNTERS_UPD_RATE != quint32(index))*/ FEE.apply_COUNTERS_UPD_RATE(index); }
-    void on_buttonRestart_clicked() { FEE.apply_RESET_SYSTEM(ui->radioButtonForceLocal->isChecked()); }
-    void on_buttonDismissErrors_clicked() { FEE.apply_RESET_ERRORS(); }
+    void on_comboBoxUpdatePeriod_activated(int index) { /*if (FEE.TCM.act.COUNTERS_UPD_RATE != quint32(index))*/ FEE.post([=]() { FEE.apply_COUNTERS_UPD_RATE(index); }); }
+    void on_buttonRestart_clicked() { bool forceLocal = ui->radioButtonForceLocal->isChecked(); FEE.post([=]() { FEE.apply_RESET_SYSTEM(forceLocal); }); }
+    void on_buttonDismissErrors_clicked() { FEE.post([=]() { FEE.apply_RESET_ERRORS(); }); }
 
-    void on_spinBoxAttenuation_valueChanged(double val) { FEE.TCM.set.attenSteps = val; }
+    void on_spinBoxAttenuation_valueChanged(double val) { FEE.post([=]() { FEE.TCM.set.attenSteps = val; }); }
     void on_sliderAttenuation_valueChanged(int value) { ui->spinBoxAttenuation->setValue(value); }
     void on_buttonApplyAttenuation_clicked() {
-        FEE.apply_attenSteps();
-        ui->sliderAttenuation->setValue(FEE.TCM.set.attenSteps);
+        FEE.post([=]() { FEE.apply_attenSteps(); });
+        ui->sliderAttenuation->setValue(ui->spinBoxAttenuation->value());
     }
-    void on_sliderAttenuation_sliderReleased() { FEE.apply_attenSteps(); }
-    void on_SwitcherLaser_clicked (bool checked) { FEE.apply_LASER_ENABLED(!checked); }
-    void on_radioButtonGenerator_clicked    () { FEE.apply_LASER_SOURCE(true ); }
-    void on_radioButtonExternalTrigger_clicked() { FEE.apply_LASER_SOURCE(false); }
-    void on_buttonApplyLaserFrequency_clicked() { FEE.TCM.set.LASER_DIVIDER = ui->spinBoxLaserFreqDivider->value(); FEE.apply_LASER_DIVIDER(); }
-    void on_buttonApplyLaserPattern_clicked() { on_lineEditLaserPattern_textEdited(); FEE.apply_LASER_PATTERN(); }
+    void on_sliderAttenuation_sliderReleased() { FEE.post([=]() { FEE.apply_attenSteps(); }); }
+    void on_SwitcherLaser_clicked (bool checked) { FEE.post([=]() { FEE.apply_LASER_ENABLED(!checked); }); }
+    void on_radioButtonGenerator_clicked    () { FEE.post([=]() { FEE.apply_LASER_SOURCE(true ); }); }
+    void on_radioButtonExternalTrigger_clicked() { FEE.post([=]() { FEE.apply_LASER_SOURCE(false); }); }
+    void on_buttonApplyLaserFrequency_clicked() { FEE.post([=, div = ui->spinBoxLaserFreqDivider->value()]() { FEE.TCM.set.LASER_DIVIDER = div; FEE.apply_LASER_DIVIDER(); }); }
+    void on_buttonApplyLaserPattern_clicked() { on_lineEditLaserPattern_textEdited(); FEE.post([=]() { FEE.apply_LASER_PATTERN(); }); }
 
     void on_spinBoxLaserFreqDivider_valueChanged(int div) {
-        FEE.TCM.set.LASER_DIVIDER = div;
-        FEE.TCM.set.laserFrequency_Hz = systemClock_MHz * 1e6 / (div == 0 ? 1 << 24 : div);
-        if (!laserFreqIsEditing) ui->lineEditLaserFrequency->setText(frequencyFormat(FEE.TCM.set.laserFrequency_Hz));
+        float frequency_Hz = systemClock_MHz * 1e6 / (div == 0 ? 1 << 24 : div);
+        FEE.post([=]() { FEE.TCM.set.LASER_DIVIDER = div; FEE.TCM.set.laserFrequency_Hz = frequency_Hz; });
+        if (!laserFreqIsEditing) ui->lineEditLaserFrequency->setText(frequencyFormat(frequency_Hz));
     }
     void on_lineEditLaserFrequency_textEdited() {
         laserFreqIsEditing = true;
@@ -1133,104 +1210,104 @@ public slots:
         }
     }
     void on_lineEditLaserFrequency_editingFinished() { laserFreqIsEditing = false; };
-    void on_lineEditLaserPattern_textEdited() { FEE.TCM.set.LASER_PATTERN = ui->lineEditLaserPattern->displayText().toULongLong(&ok, 16); }
-    void on_spinBoxSuppressDuration_valueChanged(int div) { FEE.TCM.set.lsrTrgSupprDur   = div; }
-    void on_spinBoxSuppressDelayBC_valueChanged (int div) { FEE.TCM.set.lsrTrgSupprDelay = div; }
-    void on_buttonApplySuppressDuration_clicked() { FEE.TCM.set.lsrTrgSupprDur   = ui->spinBoxSuppressDuration->value(); FEE.apply_LSR_TRG_SUPPR_DUR  (); }
-    void on_buttonApplySuppressDelayBC_clicked () { FEE.TCM.set.lsrTrgSupprDelay = ui->spinBoxSuppressDelayBC ->value(); FEE.apply_LSR_TRG_SUPPR_DELAY(); }
+    void on_lineEditLaserPattern_textEdited() { FEE.post([=, v = ui->lineEditLaserPattern->displayText().toULongLong(&ok, 16)]() { FEE.TCM.set.LASER_PATTERN = v; }); }
+    void on_spinBoxSuppressDuration_valueChanged(int div) { FEE.post([=]() { FEE.TCM.set.lsrTrgSupprDur   = div; }); }
+    void on_spinBoxSuppressDelayBC_valueChanged (int div) { FEE.post([=]() { FEE.TCM.set.lsrTrgSupprDelay = div; }); }
+    void on_buttonApplySuppressDuration_clicked() { FEE.post([=, v = ui->spinBoxSuppressDuration->value()]() { FEE.TCM.set.lsrTrgSupprDur   = v; FEE.apply_LSR_TRG_SUPPR_DUR  (); }); }
+    void on_buttonApplySuppressDelayBC_clicked () { FEE.post([=, v = ui->spinBoxSuppressDelayBC ->value()]() { FEE.TCM.set.lsrTrgSupprDelay = v; FEE.apply_LSR_TRG_SUPPR_DELAY(); }); }
 
-    void on_spinBoxORgateTCM_valueChanged(const double val) { foreach(TypePM *pm, FEE.PM) pm->set.OR_GATE = lround(val * 1000 / TDCunit_ps); }
-    void on_buttonApplyORgateTCM_clicked() { FEE.apply_OR_GATE(-1, lround(ui->spinBoxORgateTCM->value() * 1000 / TDCunit_ps)); }
-    void on_lineEditChargeHighTCM_textEdited(const QString text) { foreach(TypePM *pm, FEE.PM) pm->set.TRGchargeLevelHi = text.toUInt(); }
-    void on_buttonApplyChargeHighTCM_clicked() { FEE.apply_TRGchargeLevelHi(-1, ui->lineEditChargeHighTCM->text().toUInt()); }
-    void on_lineEditChargeLowTCM_textEdited(const QString text) { foreach(TypePM *pm, FEE.PM) pm->set.TRGchargeLevelLo = text.toUInt(); }
-    void on_buttonApplyChargeLowTCM_clicked() { FEE.apply_TRGchargeLevelLo(-1, ui->lineEditChargeLowTCM->text().toUInt()); }
+    void on_spinBoxORgateTCM_valueChanged(const double val) { FEE.post([=, v = quint8(lround(val * 1000 / TDCunit_ps))]() { foreach(TypePM *pm, FEE.PM) pm->set.OR_GATE = v; }); } //FEE.PM and the settings belong to the I/O thread
+    void on_buttonApplyORgateTCM_clicked() { quint8 v = lround(ui->spinBoxORgateTCM->value() * 1000 / TDCunit_ps); FEE.post([=]() { FEE.apply_OR_GATE(-1, v); }); }
+    void on_lineEditChargeHighTCM_textEdited(const QString text) { FEE.post([=, v = text.toUInt()]() { foreach(TypePM *pm, FEE.PM) pm->set.TRGchargeLevelHi = v; }); }
+    void on_buttonApplyChargeHighTCM_clicked() { quint16 v = ui->lineEditChargeHighTCM->text().toUInt(); FEE.post([=]() { FEE.apply_TRGchargeLevelHi(-1, v); }); }
+    void on_lineEditChargeLowTCM_textEdited(const QString text) { FEE.post([=, v = text.toUInt()]() { foreach(TypePM *pm, FEE.PM) pm->set.TRGchargeLevelLo = v; }); }
+    void on_buttonApplyChargeLowTCM_clicked() { quint16 v = ui->lineEditChargeLowTCM->text().toUInt(); FEE.post([=]() { FEE.apply_TRGchargeLevelLo(-1, v); }); }
 
-    void on_spinBoxPhase_A_valueChanged(double val) { FEE.TCM.set.DELAY_A = lround(val / phaseStep_ns); }
-    void on_spinBoxPhase_C_valueChanged(double val) { FEE.TCM.set.DELAY_C = lround(val / phaseStep_ns); }
+    void on_spinBoxPhase_A_valueChanged(double val) { FEE.post([=, v = lround(val / phaseStep_ns)]() { FEE.TCM.set.DELAY_A = v; }); }
+    void on_spinBoxPhase_C_valueChanged(double val) { FEE.post([=, v = lround(val / phaseStep_ns)]() { FEE.TCM.set.DELAY_C = v; }); }
     void on_spinBoxLaserPhase_valueChanged(double val) {
-        FEE.TCM.set.LASER_DELAY = lround(val / phaseStepLaser_ns);
-        FEE.TCM.set.delayLaser_ns = FEE.TCM.set.LASER_DELAY * phaseStepLaser_ns;
+        qint32 delay = lround(val / phaseStepLaser_ns);
+        FEE.post([=]() { FEE.TCM.set.LASER_DELAY = delay; FEE.TCM.set.delayLaser_ns = FEE.TCM.set.LASER_DELAY * phaseStepLaser_ns; });
     }
-    void on_buttonApplyPhase_A_clicked() { on_spinBoxPhase_A_valueChanged(ui->spinBoxPhase_A->value()); FEE.apply_DELAY_A(); }
-    void on_buttonApplyPhase_C_clicked() { on_spinBoxPhase_C_valueChanged(ui->spinBoxPhase_C->value()); FEE.apply_DELAY_C(); }
+    void on_buttonApplyPhase_A_clicked() { on_spinBoxPhase_A_valueChanged(ui->spinBoxPhase_A->value()); FEE.post([=]() { FEE.apply_DELAY_A(); }); }
+    void on_buttonApplyPhase_C_clicked() { on_spinBoxPhase_C_valueChanged(ui->spinBoxPhase_C->value()); FEE.post([=]() { FEE.apply_DELAY_C(); }); }
     void on_buttonApplyLaserPhase_clicked() {
-        FEE.apply_LASER_DELAY();
-        ui->sliderLaser->setValue(FEE.TCM.set.LASER_DELAY);
+        FEE.post([=]() { FEE.apply_LASER_DELAY(); });
+        ui->sliderLaser->setValue(lround(ui->spinBoxLaserPhase->value() / phaseStepLaser_ns));
     }
-    void on_sliderLaser_sliderReleased() { FEE.apply_LASER_DELAY(); }
+    void on_sliderLaser_sliderReleased() { FEE.post([=]() { FEE.apply_LASER_DELAY(); }); }
     void on_sliderLaser_valueChanged(int value) { ui->spinBoxLaserPhase->setValue(value * phaseStepLaser_ns); }
 
-    void on_SwitcherExt1_clicked(bool checked) { FEE.apply_SW_EXT(1, !checked); }
-    void on_SwitcherExt2_clicked(bool checked) { FEE.apply_SW_EXT(2, !checked); }
-    void on_SwitcherExt3_clicked(bool checked) { FEE.apply_SW_EXT(3, !checked); }
-    void on_SwitcherExt4_clicked(bool checked) { FEE.apply_SW_EXT(4, !checked); }
+    void on_SwitcherExt1_clicked(bool checked) { FEE.post([=]() { FEE.apply_SW_EXT(1, !checked); }); }
+    void on_SwitcherExt2_clicked(bool checked) { FEE.post([=]() { FEE.apply_SW_EXT(2, !checked); }); }
+    void on_SwitcherExt3_clicked(bool checked) { FEE.post([=]() { FEE.apply_SW_EXT(3, !checked); }); }
+    void on_SwitcherExt4_clicked(bool checked) { FEE.post([=]() { FEE.apply_SW_EXT(4, !checked); }); }
 
-    void on_SwitcherExtendedReadout_clicked(bool checked) { FEE.apply_EXTENDED_READOUT(!checked); }
-    void on_SwitcherAddCdelay_clicked      (bool checked) { FEE.apply_ADD_C_DELAY     (!checked); }
-    void on_SwitcherTriggers_1_clicked (bool checked) { FEE.apply_T1_ENABLED(!checked); }
-    void on_SwitcherTriggers_2_clicked (bool checked) { FEE.apply_T2_ENABLED(!checked); }
-    void on_SwitcherTriggers_3_clicked (bool checked) { FEE.apply_T3_ENABLED(!checked); }
-    void on_SwitcherTriggers_4_clicked (bool checked) { FEE.apply_T4_ENABLED(!checked); }
-    void on_SwitcherTriggers_5_clicked (bool checked) { FEE.apply_T5_ENABLED(!checked); }
+    void on_SwitcherExtendedReadout_clicked(bool checked) { FEE.post([=]() { FEE.apply_EXTENDED_READOUT(!checked); }); }
+    void on_SwitcherAddCdelay_clicked      (bool checked) { FEE.post([=]() { FEE.apply_ADD_C_DELAY     (!checked); }); }
+    void on_SwitcherTriggers_1_clicked (bool checked) { FEE.post([=]() { FEE.apply_T1_ENABLED(!checked); }); }
+    void on_SwitcherTriggers_2_clicked (bool checked) { FEE.post([=]() { FEE.apply_T2_ENABLED(!checked); }); }
+    void on_SwitcherTriggers_3_clicked (bool checked) { FEE.post([=]() { FEE.apply_T3_ENABLED(!checked); }); }
+    void on_SwitcherTriggers_4_clicked (bool checked) { FEE.post([=]() { FEE.apply_T4_ENABLED(!checked); }); }
+    void on_SwitcherTriggers_5_clicked (bool checked) { FEE.post([=]() { FEE.apply_T5_ENABLED(!checked); }); }
 
-    void on_radioButtonAandC_clicked(bool checked) { if (checked) FEE.apply_sidesCombMode(0); }
-    void on_radioButtonC_clicked    (bool checked) { if (checked) FEE.apply_sidesCombMode(1); }
-    void on_radioButtonA_clicked    (bool checked) { if (checked) FEE.apply_sidesCombMode(2); }
-    void on_radioButtonSum_clicked  (bool checked) { if (checked) FEE.apply_sidesCombMode(3); }
+    void on_radioButtonAandC_clicked(bool checked) { if (checked) FEE.post([=]() { FEE.apply_sidesCombMode(0); }); }
+    void on_radioButtonC_clicked    (bool checked) { if (checked) FEE.post([=]() { FEE.apply_sidesCombMode(1); }); }
+    void on_radioButtonA_clicked    (bool checked) { if (checked) FEE.post([=]() { FEE.apply_sidesCombMode(2); }); }
+    void on_radioButtonSum_clicked  (bool checked) { if (checked) FEE.post([=]() { FEE.apply_sidesCombMode(3); }); }
 
-    void on_buttonResetCountersTCM_clicked() { FEE.resetCounts(FEE.TCMid); }
-    void on_buttonResetChCounters_clicked() { FEE.resetCounts(curFEEid); }
+    void on_buttonResetCountersTCM_clicked() { FEE.post([=]() { FEE.resetCounts(FEE.TCMid); }); }
+    void on_buttonResetChCounters_clicked() { FEE.post([=, FEEid = curFEEid]() { FEE.resetCounts(FEEid); }); }
 
-    void on_comboBoxTriggersMode_1_activated(int index) { FEE.apply_T1_MODE(index); }
-    void on_comboBoxTriggersMode_2_activated(int index) { FEE.apply_T2_MODE(index); }
-    void on_comboBoxTriggersMode_3_activated(int index) { FEE.apply_T3_MODE(index); }
-    void on_comboBoxTriggersMode_4_activated(int index) { FEE.apply_T4_MODE(index); }
-    void on_comboBoxTriggersMode_5_activated(int index) { FEE.apply_T5_MODE(index); }
+    void on_comboBoxTriggersMode_1_activated(int index) { FEE.post([=]() { FEE.apply_T1_MODE(index); }); }
+    void on_comboBoxTriggersMode_2_activated(int index) { FEE.post([=]() { FEE.apply_T2_MODE(index); }); }
+    void on_comboBoxTriggersMode_3_activated(int index) { FEE.post([=]() { FEE.apply_T3_MODE(index); }); }
+    void on_comboBoxTriggersMode_4_activated(int index) { FEE.post([=]() { FEE.apply_T4_MODE(index); }); }
+    void on_comboBoxTriggersMode_5_activated(int index) { FEE.post([=]() { FEE.apply_T5_MODE(index); }); }
 
-    void on_lineEditTriggersRandomRate_1_textEdited() { FEE.TCM.set.T1_RATE = ui->lineEditTriggersRandomRate_1->displayText().toUInt(&ok, 16); }
-    void on_lineEditTriggersRandomRate_2_textEdited() { FEE.TCM.set.T2_RATE = ui->lineEditTriggersRandomRate_2->displayText().toUInt(&ok, 16); }
-    void on_lineEditTriggersRandomRate_3_textEdited() { FEE.TCM.set.T3_RATE = ui->lineEditTriggersRandomRate_3->displayText().toUInt(&ok, 16); }
-    void on_lineEditTriggersRandomRate_4_textEdited() { FEE.TCM.set.T4_RATE = ui->lineEditTriggersRandomRate_4->displayText().toUInt(&ok, 16); }
-    void on_lineEditTriggersRandomRate_5_textEdited() { FEE.TCM.set.T5_RATE = ui->lineEditTriggersRandomRate_5->displayText().toUInt(&ok, 16); }
-    void on_buttonApplyTriggersRandomRate_1_clicked() { FEE.apply_T1_RATE(); }
-    void on_buttonApplyTriggersRandomRate_2_clicked() { FEE.apply_T2_RATE(); }
-    void on_buttonApplyTriggersRandomRate_3_clicked() { FEE.apply_T3_RATE(); }
-    void on_buttonApplyTriggersRandomRate_4_clicked() { FEE.apply_T4_RATE(); }
-    void on_buttonApplyTriggersRandomRate_5_clicked() { FEE.apply_T5_RATE(); }
+    void on_lineEditTriggersRandomRate_1_textEdited() { FEE.post([=, v = ui->lineEditTriggersRandomRate_1->displayText().toUInt(&ok, 16)]() { FEE.TCM.set.T1_RATE = v; }); }
+    void on_lineEditTriggersRandomRate_2_textEdited() { FEE.post([=, v = ui->lineEditTriggersRandomRate_2->displayText().toUInt(&ok, 16)]() { FEE.TCM.set.T2_RATE = v; }); }
+    void on_lineEditTriggersRandomRate_3_textEdited() { FEE.post([=, v = ui->lineEditTriggersRandomRate_3->displayText().toUInt(&ok, 16)]() { FEE.TCM.set.T3_RATE = v; }); }
+    void on_lineEditTriggersRandomRate_4_textEdited() { FEE.post([=, v = ui->lineEditTriggersRandomRate_4->displayText().toUInt(&ok, 16)]() { FEE.TCM.set.T4_RATE = v; }); }
+    void on_lineEditTriggersRandomRate_5_textEdited() { FEE.post([=, v = ui->lineEditTriggersRandomRate_5->displayText().toUInt(&ok, 16)]() { FEE.TCM.set.T5_RATE = v; }); }
+    void on_buttonApplyTriggersRandomRate_1_clicked() { FEE.post([=]() { FEE.apply_T1_RATE(); }); }
+    void on_buttonApplyTriggersRandomRate_2_clicked() { FEE.post([=]() { FEE.apply_T2_RATE(); }); }
+    void on_buttonApplyTriggersRandomRate_3_clicked() { FEE.post([=]() { FEE.apply_T3_RATE(); }); }
+    void on_buttonApplyTriggersRandomRate_4_clicked() { FEE.post([=]() { FEE.apply_T4_RATE(); }); }
+    void on_buttonApplyTriggersRandomRate_5_clicked() { FEE.post([=]() { FEE.apply_T5_RATE(); }); }
 
-    void on_lineEditTriggersLevelA_1_textEdited(const QString &text) { FEE.TCM.set.T1_LEVEL_A = text.toUInt(); }
-    void on_lineEditTriggersLevelC_1_textEdited(const QString &text) { FEE.TCM.set.T1_LEVEL_C = text.toUInt(); }
-    void on_lineEditTriggersLevelA_2_textEdited(const QString &text) { FEE.TCM.set.T2_LEVEL_A = text.toUInt(); }
-    void on_lineEditTriggersLevelC_2_textEdited(const QString &text) { FEE.TCM.set.T2_LEVEL_C = text.toUInt(); }
-    void on_buttonApplyTriggersLevelA_1_clicked() { FEE.apply_T1_LEVEL_A(); }
-    void on_buttonApplyTriggersLevelC_1_clicked() { FEE.apply_T1_LEVEL_C(); }
-    void on_buttonApplyTriggersLevelA_2_clicked() { FEE.apply_T2_LEVEL_A(); }
-    void on_buttonApplyTriggersLevelC_2_clicked() { FEE.apply_T2_LEVEL_C(); }
+    void on_lineEditTriggersLevelA_1_textEdited(const QString &text) { FEE.post([=, v = text.toUInt()]() { FEE.TCM.set.T1_LEVEL_A = v; }); }
+    void on_lineEditTriggersLevelC_1_textEdited(const QString &text) { FEE.post([=, v = text.toUInt()]() { FEE.TCM.set.T1_LEVEL_C = v; }); }
+    void on_lineEditTriggersLevelA_2_textEdited(const QString &text) { FEE.post([=, v = text.toUInt()]() { FEE.TCM.set.T2_LEVEL_A = v; }); }
+    void on_lineEditTriggersLevelC_2_textEdited(const QString &text) { FEE.post([=, v = text.toUInt()]() { FEE.TCM.set.T2_LEVEL_C = v; }); }
+    void on_buttonApplyTriggersLevelA_1_clicked() { FEE.post([=]() { FEE.apply_T1_LEVEL_A(); }); }
+    void on_buttonApplyTriggersLevelC_1_clicked() { FEE.post([=]() { FEE.apply_T1_LEVEL_C(); }); }
+    void on_buttonApplyTriggersLevelA_2_clicked() { FEE.post([=]() { FEE.apply_T2_LEVEL_A(); }); }
+    void on_buttonApplyTriggersLevelC_2_clicked() { FEE.post([=]() { FEE.apply_T2_LEVEL_C(); }); }
 
-    void on_lineEditVertexTimeLow_textEdited (const QString text) { FEE.TCM.set.VTIME_LOW  = text.toInt(); }
-    void on_lineEditVertexTimeHigh_textEdited(const QString text) { FEE.TCM.set.VTIME_HIGH = text.toInt(); }
-    void on_buttonApplyVertexTimeLow_clicked () { FEE.apply_VTIME_LOW (); }
-    void on_buttonApplyVertexTimeHigh_clicked() { FEE.apply_VTIME_HIGH(); }
+    void on_lineEditVertexTimeLow_textEdited (const QString text) { FEE.post([=, v = text.toInt()]() { FEE.TCM.set.VTIME_LOW  = v; }); }
+    void on_lineEditVertexTimeHigh_textEdited(const QString text) { FEE.post([=, v = text.toInt()]() { FEE.TCM.set.VTIME_HIGH = v; }); }
+    void on_buttonApplyVertexTimeLow_clicked () { FEE.post([=]() { FEE.apply_VTIME_LOW (); }); }
+    void on_buttonApplyVertexTimeHigh_clicked() { FEE.post([=]() { FEE.apply_VTIME_HIGH(); }); }
 
-    void on_lineEditORgate_textEdited  (const QString text) { curPM->set.OR_GATE          = text.toUInt(); }
-    void on_lineEditChargeHi_textEdited(const QString text) { curPM->set.TRGchargeLevelHi = text.toUInt(); }
-    void on_lineEditChargeLo_textEdited(const QString text) { curPM->set.TRGchargeLevelLo = text.toUInt(); }
-    void on_buttonApplyORgate_clicked  () { FEE.apply_OR_GATE         (curPM - FEE.allPMs, ui->lineEditORgate  ->text().toUInt()); }
-    void on_buttonApplyChargeHi_clicked() { FEE.apply_TRGchargeLevelHi(curPM - FEE.allPMs, ui->lineEditChargeHi->text().toUInt()); }
-    void on_buttonApplyChargeLo_clicked() { FEE.apply_TRGchargeLevelLo(curPM - FEE.allPMs, ui->lineEditChargeLo->text().toUInt()); }
+    void on_lineEditORgate_textEdited  (const QString text) { FEE.post([=, pm = curPM, v = text.toUInt()]() { pm->set.OR_GATE          = v; }); }
+    void on_lineEditChargeHi_textEdited(const QString text) { FEE.post([=, pm = curPM, v = text.toUInt()]() { pm->set.TRGchargeLevelHi = v; }); }
+    void on_lineEditChargeLo_textEdited(const QString text) { FEE.post([=, pm = curPM, v = text.toUInt()]() { pm->set.TRGchargeLevelLo = v; }); }
+    void on_buttonApplyORgate_clicked  () { quint8  v = ui->lineEditORgate  ->text().toUInt(); FEE.post([=, pm = curPM]() { FEE.apply_OR_GATE         (pm - FEE.allPMs, v); }); }
+    void on_buttonApplyChargeHi_clicked() { quint16 v = ui->lineEditChargeHi->text().toUInt(); FEE.post([=, pm = curPM]() { FEE.apply_TRGchargeLevelHi(pm - FEE.allPMs, v); }); }
+    void on_buttonApplyChargeLo_clicked() { quint16 v = ui->lineEditChargeLo->text().toUInt(); FEE.post([=, pm = curPM]() { FEE.apply_TRGchargeLevelLo(pm - FEE.allPMs, v); }); }
 
-    void on_buttonStrict_clicked   () { FEE.apply_TRG_CNT_MODE(curFEEid, false); }
-    void on_buttonCFDinGate_clicked() { FEE.apply_TRG_CNT_MODE(curFEEid, true ); }
+    void on_buttonStrict_clicked   () { FEE.post([=, FEEid = curFEEid]() { FEE.apply_TRG_CNT_MODE(FEEid, false); }); }
+    void on_buttonCFDinGate_clicked() { FEE.post([=, FEEid = curFEEid]() { FEE.apply_TRG_CNT_MODE(FEEid, true ); }); }
 
-    void on_buttonSCNchan_clicked () { FEE.apply_SC_EVAL_MODE(true ); }
-    void on_buttonSCcharge_clicked() { FEE.apply_SC_EVAL_MODE(false); }
+    void on_buttonSCNchan_clicked () { FEE.post([=]() { FEE.apply_SC_EVAL_MODE(true ); }); }
+    void on_buttonSCcharge_clicked() { FEE.post([=]() { FEE.apply_SC_EVAL_MODE(false); }); }
 
-    void on_buttonCopyActual_clicked() { FEE.copyActualToSettingsPM(curPM); updateEdits(); }
-    void on_buttonApplyAll_clicked() { FEE.applySettingsPM(curPM); }
+    void on_buttonCopyActual_clicked() { FEE.post([=, pm = curPM]() { FEE.copyActualToSettingsPM(pm); FEE.publishView(); QMetaObject::invokeMethod(this, [=]() { updateEdits(); }); }); }
+    void on_buttonApplyAll_clicked() { FEE.post([=, pm = curPM]() { FEE.applySettingsPM(pm); }); }
 
     void on_checkBoxPairChannels_toggled(bool checked) { foreach(QFrame *l, channelPairsLines) l->setVisible(checked); }
-    void on_checkBoxPairChannels_clicked(bool checked) { FEE.apply_PMparameter("PairedChannelsMode", curPM - FEE.allPMs, checked); }
+    void on_checkBoxPairChannels_clicked(bool checked) { FEE.post([=, pm = curPM]() { FEE.apply_PMparameter("PairedChannelsMode", pm - FEE.allPMs, checked); }); }
 
 private:
     Ui::MainWindow *ui;